@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# @author Max Markeloff (https://github.com/mmarkeloff)
+# 
+# MIT License
+#
+# Copyright (c) 2021 Max
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+set -e
+
+BUILD_PATH="test/soak/build"
+SECONDS_PER_RUN="${SOAK_SECONDS:-120}"
+PRODUCERS="${SOAK_THREADS:-16}"
+
+mkdir -p "${BUILD_PATH}"
+cd "${BUILD_PATH}"
+
+cmake .. 
+make
+./cpp-syslog-client-soak "${SECONDS_PER_RUN}" "${PRODUCERS}"
+
+exit 0
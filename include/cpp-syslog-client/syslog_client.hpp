@@ -44,14 +44,24 @@ namespace syslog {
      * 
      * @return syslog::ostream
      */
-    auto makeUDPClient_st() noexcept { return ostream{std::make_unique<UDPClient>(), std::make_unique<details::st>()}; }
+    inline auto makeUDPClient_st() noexcept { return ostream{std::make_unique<UDPClient>(), std::make_unique<details::st>()}; }
 
     /**
      * Multi threads implementation sending messages by UDP
      * 
      * @return syslog::ostream
      */
-    auto makeUDPClient_mt() noexcept { return ostream{std::make_unique<UDPClient>(), std::make_unique<details::mt>()}; }
+    inline auto makeUDPClient_mt() noexcept { return ostream{std::make_unique<UDPClient>(), std::make_unique<details::mt>()}; }
+
+    /**
+     * Implementation sending messages by UDP with thread policy chosen at compile time
+     * 
+     * @tparam Mode thread policy, syslog::details::<st|mt|mt_prof|spin|lf>
+     * 
+     * @return syslog::basic_ostream<Mode>
+     */
+    template<class Mode>
+    auto makeUDPClient() noexcept { return basic_ostream<Mode>{std::make_unique<UDPClient>(), std::make_unique<Mode>()}; }
 };
 
 #endif // __CPP_SYSLOG_CLIENT_SYSLOG_CLIENT_HPP
\ No newline at end of file
@@ -0,0 +1,374 @@
+/**
+ * @file loadgen.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Load generator: replays a log file, or synthetic messages of a given size range, through syslog::basic_ostream 
+// at a target rate or as fast as possible, from N threads, and reports achieved rate, CPU time per message and 
+// send errors, as the library's own counters see them.
+//
+// loadgen [--addr=ADDR] [--port=PORT] [--transport=udp|null] [--mode=st|mt|spin|lf] [--api=stream|log|defer]
+//         [--threads=N] [--rate=MSG_PER_SEC] [--seconds=N] [--file=PATH] [--size=MIN[-MAX]] [--non-blocking]
+//
+// With st every thread has its own client, with other modes threads share one client. Null transport sends 
+// nothing, so only the caller side is measured.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "syslog_client.hpp"
+
+#if defined(WIN32)
+ #pragma comment(lib, "Ws2_32.lib")
+#endif
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Run options
+ */
+struct LoadArgs {
+    std::string addr{"127.0.0.1"}; ///< syslog server address
+    uint16_t    port{514}; ///< syslog server port
+    bool        null{false}; ///< null transport instead of UDP
+    std::string mode{"mt"}; ///< thread policy
+    std::string api{"stream"}; ///< stream, log() or defer()
+    uint32_t    threads{1}; ///< producer threads
+    uint64_t    rate{0}; ///< target messages per second of all threads, 0 is as fast as possible
+    uint32_t    seconds{10}; ///< duration
+    std::string file; ///< log file to replay line by line, synthetic messages if empty
+    std::size_t minSize{128}; ///< min synthetic message size
+    std::size_t maxSize{128}; ///< max synthetic message size
+    bool        nonBlocking{false}; ///< don't block on full kernel queue
+};
+
+/**
+ * Totals of one run
+ */
+struct LoadResult {
+    uint64_t                messages{0}; ///< messages logged
+    uint64_t                bytes{0}; ///< message text bytes logged
+    syslog::Metrics         metrics{}; ///< library counters, summed over clients
+    std::map<int, uint64_t> errors; ///< failed sends per errno, summed over clients
+};
+
+/**
+ * Data sender doing nothing, so only message assembly is measured
+ */
+class NullClient : public syslog::details::IClient {
+public:
+    void setAddr(const char*) noexcept override { }
+
+    void setPort(uint16_t) noexcept override { }
+
+    void setNonBlocking(bool) noexcept override { }
+
+    void setSndBuf(int32_t) noexcept override { }
+
+    void setRetry(bool) noexcept override { }
+
+    void setMaxMsgSize(std::size_t) noexcept override { }
+
+    std::size_t getMaxMsgSize() const noexcept override { return syslog::MsgSizeMng::DEFAULT_UDP_MSG_SIZE; }
+
+    int32_t getSock() const noexcept override { return 0; }
+
+    syslog::SendStats getStats() const noexcept override { return syslog::SendStats{0, 0, 0, 0, 0}; }
+
+    bool isInitialised() const noexcept override { return true; }
+
+    void send(std::string&&) const noexcept override { }
+
+    void send(const syslog::details::Segment*, std::size_t) const noexcept override { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Messages to send: file lines or synthetic ones
+ */
+static bool makeCorpus(const LoadArgs& args, std::vector<std::string>& corpus) {
+    if (!args.file.empty()) {
+        std::ifstream in{args.file};
+        std::string line;
+        while (std::getline(in, line))
+            if (!line.empty())
+                corpus.push_back(line);
+        return !corpus.empty();
+    }
+
+    // fixed seed, runs are comparable
+    static constexpr std::size_t SYNTHETIC{1024};
+    static const char ALPHABET[]{"abcdefghijklmnopqrstuvwxyz0123456789 "};
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<std::size_t> size{args.minSize, args.maxSize};
+    for (std::size_t i = 0; i < SYNTHETIC; ++i) {
+        std::string msg{"loadgen message " + std::to_string(i) + ' '};
+        auto len{size(gen)};
+        while (msg.size() < len)
+            msg += ALPHABET[(msg.size() + i) % (sizeof(ALPHABET) - 1)];
+        msg.resize(len);
+        corpus.push_back(std::move(msg));
+    }
+
+    return true;
+}
+
+/**
+ * Client with run options
+ */
+template<class Mode>
+static syslog::basic_ostream<Mode> makeClient(const LoadArgs& args) {
+    std::unique_ptr<syslog::details::IClient> client;
+    if (args.null)
+        client = std::make_unique<NullClient>();
+    else
+        client = std::make_unique<syslog::UDPClient>();
+
+    syslog::basic_ostream<Mode> syslog{std::move(client), std::make_unique<Mode>()};
+    syslog.setAddr(args.addr.c_str());
+    syslog.setPort(args.port);
+    syslog.setNonBlocking(args.nonBlocking);
+    return syslog;
+}
+
+/**
+ * Add counters of one client to totals
+ */
+template<class Mode>
+static void collect(syslog::basic_ostream<Mode>& syslog, LoadResult& res) {
+    syslog.drainDeferred();
+    auto metrics{syslog.getMetrics()};
+    res.metrics.send.sent += metrics.send.sent;
+    res.metrics.send.again += metrics.send.again;
+    res.metrics.send.retried += metrics.send.retried;
+    res.metrics.send.dropped += metrics.send.dropped;
+    res.metrics.send.errors += metrics.send.errors;
+    res.metrics.bytes += metrics.bytes;
+    res.metrics.deferredDropped += metrics.deferredDropped;
+    for (const auto& err : metrics.errors)
+        res.errors[err.first] += err.second;
+}
+
+/**
+ * Log corpus messages from one thread until time is up, paced to its share of target rate
+ */
+template<class Mode>
+static void produce(const LoadArgs& args, const std::vector<std::string>& corpus, syslog::basic_ostream<Mode>& syslog, 
+    uint32_t id, std::chrono::steady_clock::time_point end, LoadResult& res) 
+{
+    using namespace std::chrono;
+
+    const bool paced{args.rate > 0};
+    const auto interval{paced ? duration<double>(static_cast<double>(args.threads) / static_cast<double>(args.rate)) : 
+        duration<double>(0)};
+    auto next{steady_clock::now()};
+    std::size_t pos{id % corpus.size()};
+
+    for (uint64_t n = 0; ; ++n) {
+        // clock is read once per 64 messages when unpaced
+        if (paced || 0 == (n & 63)) {
+            auto now{steady_clock::now()};
+            if (now >= end)
+                break;
+            if (paced) {
+                if (next > now)
+                    std::this_thread::sleep_until(next);
+                next += duration_cast<steady_clock::duration>(interval);
+            }
+        }
+
+        const auto& msg{corpus[pos]};
+        if (++pos == corpus.size())
+            pos = 0;
+
+        if ("log" == args.api)
+            syslog.log(syslog::LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), msg);
+        else if ("defer" == args.api)
+            syslog.defer(syslog::LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), msg); // refused ones are counted by library
+        else
+            syslog << syslog::LogLvlMng::LL_INFO << msg << std::flush;
+
+        ++res.messages;
+        res.bytes += msg.size();
+    }
+}
+
+/**
+ * Run producers with given thread policy
+ */
+template<class Mode>
+static LoadResult run(const LoadArgs& args, const std::vector<std::string>& corpus) {
+    std::vector<LoadResult> perThread(args.threads);
+    std::vector<std::thread> threads;
+    auto end{std::chrono::steady_clock::now() + std::chrono::seconds(args.seconds)};
+    LoadResult res;
+
+    if (std::is_same<Mode, syslog::details::st>::value) {
+        // client per thread, as single threaded apps have
+        for (uint32_t i = 0; i < args.threads; ++i)
+            threads.emplace_back([&, i]() {
+                auto syslog{makeClient<Mode>(args)};
+                produce(args, corpus, syslog, i, end, perThread[i]);
+                collect(syslog, perThread[i]);
+            });
+        for (auto& thread : threads)
+            thread.join();
+    }
+    else {
+        auto syslog{makeClient<Mode>(args)};
+        for (uint32_t i = 0; i < args.threads; ++i)
+            threads.emplace_back([&, i]() { produce(args, corpus, syslog, i, end, perThread[i]); });
+        for (auto& thread : threads)
+            thread.join();
+        collect(syslog, res);
+    }
+
+    for (const auto& thread : perThread) {
+        res.messages += thread.messages;
+        res.bytes += thread.bytes;
+        res.metrics.send.sent += thread.metrics.send.sent;
+        res.metrics.send.again += thread.metrics.send.again;
+        res.metrics.send.retried += thread.metrics.send.retried;
+        res.metrics.send.dropped += thread.metrics.send.dropped;
+        res.metrics.send.errors += thread.metrics.send.errors;
+        res.metrics.bytes += thread.metrics.bytes;
+        res.metrics.deferredDropped += thread.metrics.deferredDropped;
+        for (const auto& err : thread.errors)
+            res.errors[err.first] += err.second;
+    }
+
+    return res;
+}
+
+/**
+ * Parse "--name=value" options
+ */
+static bool parseArgs(int argc, char** argv, LoadArgs& args) {
+    for (auto i = 1; i < argc; ++i) {
+        const char* arg{argv[i]};
+        const char* eq{std::strchr(arg, '=')};
+        std::string name{arg, eq ? static_cast<std::size_t>(eq - arg) : std::strlen(arg)};
+        std::string value{eq ? eq + 1 : ""};
+        auto num{std::strtoull(value.c_str(), nullptr, 10)};
+
+        if ("--addr" == name && !value.empty())
+            args.addr = value;
+        else if ("--port" == name && num > 0 && num <= 65535)
+            args.port = static_cast<uint16_t>(num);
+        else if ("--transport" == name && ("udp" == value || "null" == value))
+            args.null = "null" == value;
+        else if ("--mode" == name && ("st" == value || "mt" == value || "spin" == value || "lf" == value))
+            args.mode = value;
+        else if ("--api" == name && ("stream" == value || "log" == value || "defer" == value))
+            args.api = value;
+        else if ("--threads" == name && num > 0)
+            args.threads = static_cast<uint32_t>(num);
+        else if ("--rate" == name)
+            args.rate = num;
+        else if ("--seconds" == name && num > 0)
+            args.seconds = static_cast<uint32_t>(num);
+        else if ("--file" == name && !value.empty())
+            args.file = value;
+        else if ("--size" == name && num > 0) {
+            auto dash{value.find('-')};
+            args.minSize = static_cast<std::size_t>(num);
+            args.maxSize = dash == std::string::npos ? args.minSize : std::strtoull(value.c_str() + dash + 1, nullptr, 10);
+            if (args.maxSize < args.minSize)
+                return false;
+        }
+        else if ("--non-blocking" == name)
+            args.nonBlocking = true;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+int main(int argc, char** argv) {
+    LoadArgs args;
+    if (!parseArgs(argc, argv, args)) {
+        std::fprintf(stderr, "usage: %s [--addr=ADDR] [--port=PORT] [--transport=udp|null] [--mode=st|mt|spin|lf]"
+            " [--api=stream|log|defer] [--threads=N] [--rate=MSG_PER_SEC] [--seconds=N] [--file=PATH] [--size=MIN[-MAX]]"
+            " [--non-blocking]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::string> corpus;
+    if (!makeCorpus(args, corpus)) {
+        std::fprintf(stderr, "loadgen: nothing to replay in %s\n", args.file.c_str());
+        return 1;
+    }
+
+    auto cpuBegin{std::clock()};
+    auto begin{std::chrono::steady_clock::now()};
+
+    LoadResult res;
+    if ("st" == args.mode)
+        res = run<syslog::details::st>(args, corpus);
+    else if ("spin" == args.mode)
+        res = run<syslog::details::spin>(args, corpus);
+    else if ("lf" == args.mode)
+        res = run<syslog::details::lf>(args, corpus);
+    else
+        res = run<syslog::details::mt>(args, corpus);
+
+    auto seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count()};
+    auto cpu{static_cast<double>(std::clock() - cpuBegin) / CLOCKS_PER_SEC};
+    auto messages{std::max<uint64_t>(res.messages, 1)};
+
+    std::printf("%s %s %s, %u threads, %.1f s\n", args.null ? "null" : "udp", args.mode.c_str(), args.api.c_str(), 
+        args.threads, seconds);
+    std::printf("rate:   %llu messages, %.0f msg/s (target %s), %.1f MB/s of text, avg %.0f bytes\n", 
+        (unsigned long long)res.messages, static_cast<double>(res.messages) / seconds, args.rate ? std::to_string(args.rate).c_str() : "max",
+        static_cast<double>(res.bytes) / seconds / 1e6, static_cast<double>(res.bytes) / static_cast<double>(messages));
+    std::printf("cpu:    %.0f ns/msg (%.2f cores)\n", cpu * 1e9 / static_cast<double>(messages), cpu / seconds);
+    std::printf("send:   sent %llu, again %llu, retried %llu, dropped %llu, errors %llu, deferred dropped %llu\n",
+        (unsigned long long)res.metrics.send.sent, (unsigned long long)res.metrics.send.again, 
+        (unsigned long long)res.metrics.send.retried, (unsigned long long)res.metrics.send.dropped, 
+        (unsigned long long)res.metrics.send.errors, (unsigned long long)res.metrics.deferredDropped);
+    for (const auto& err : res.errors)
+        std::printf("errno:  %d (%s) %llu\n", err.first, std::strerror(err.first), (unsigned long long)err.second);
+}
@@ -83,4 +83,10 @@ int main() {
     syslog.addFormatter(std::make_shared<ModuleNameFormatter>("main")); 
 
     syslog << syslog::LogLvlMng::LL_INFO << "Message with new formatter flag" << std::endl;
+
+    // structured data of this message only
+    syslog << syslog::LogLvlMng::LL_INFO << syslog::kv("req_id", 42) << "Message with params" << std::endl;
+
+    // no iostreams, format string is checked at compile time
+    syslog.log(syslog::LogLvlMng::LL_INFO, SYSLOG_FMT("Formatted message {} of {}"), 1, 1.0);
 }
\ No newline at end of file
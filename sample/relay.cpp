@@ -0,0 +1,447 @@
+/**
+ * @file relay.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Per-host relay: accepts UDP from local apps, filters and rewrites records by facility and severity, 
+// forwards them over TCP (octet counting, RFC 6587) to a central collector, a batch per write.
+//
+// relay [--listen=ADDR:PORT] [--forward=ADDR:PORT] [--workers=N] [--pin] [--max-lvl=N] [--facility=N] 
+//       [--set-facility=N] [--batch=N] [--flush-ms=N] [--bench=SECONDS]
+//
+// With --bench the collector is an in-process TCP receiver and local producers log through the library, 
+// so the run measures the whole path: client, UDP, relay, TCP, collector.
+
+#if defined(__linux__)
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "syslog_client.hpp"
+#include "syslog_receiver.hpp"
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+static std::atomic<bool> g_Stop{false}; ///< set by SIGINT, SIGTERM or end of bench
+
+/**
+ * Run options
+ */
+struct RelayArgs {
+    std::string listenAddr{"127.0.0.1"}; ///< UDP address of local apps
+    uint16_t    listenPort{5514}; ///< UDP port, 0 for an ephemeral one
+    std::string fwdAddr{"127.0.0.1"}; ///< collector address
+    uint16_t    fwdPort{10514}; ///< collector TCP port
+    uint32_t    workers{1}; ///< threads, each with own socket on the listen port
+    bool        pin{false}; ///< pin worker N to core N
+    int         maxLvl{syslog::LogLvlMng::LL_DEBUG}; ///< forward severities up to this one
+    int         facility{-1}; ///< forward this facility only, -1 for any
+    int         setFacility{-1}; ///< rewrite facility of forwarded records, -1 keeps it
+    std::size_t batch{256}; ///< records per write
+    uint32_t    flushMs{10}; ///< max time a record waits for its batch
+    uint32_t    bench{0}; ///< seconds of self-contained benchmark, 0 relays until stopped
+};
+
+/**
+ * Counters of one worker
+ */
+struct RelayStats {
+    std::atomic<uint64_t> received{0}; ///< datagrams taken
+    std::atomic<uint64_t> filtered{0}; ///< records not matching filter
+    std::atomic<uint64_t> invalid{0}; ///< records without valid PRI
+    std::atomic<uint64_t> forwarded{0}; ///< records written to collector
+    std::atomic<uint64_t> dropped{0}; ///< records lost with collector connection
+    std::atomic<uint64_t> writes{0}; ///< write system calls
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Coalesces framed records of one worker and writes them to collector
+ */
+class Forwarder final {
+private:
+    std::string m_Addr; ///< collector address
+    uint16_t    m_Port; ///< collector port
+    int         m_Sock; ///< connection, -1 until connected
+    std::string m_Buf; ///< framed records of current batch
+    std::size_t m_Count; ///< records in current batch
+    RelayStats& m_Stats; ///< counters of worker
+public:
+    Forwarder(const std::string& addr, uint16_t port, std::size_t batch, RelayStats& stats) :
+        m_Addr{addr},
+        m_Port{port},
+        m_Sock{-1},
+        m_Count{0},
+        m_Stats{stats}
+    {
+        m_Buf.reserve(batch * 512);
+    }
+
+    Forwarder(const Forwarder&) = delete;
+
+    Forwarder& operator=(const Forwarder&) = delete;
+
+    ~Forwarder() {
+        if (m_Sock >= 0)
+            close(m_Sock);
+    }
+
+    /**
+     * Getter
+     */
+    std::size_t getCount() const noexcept { return m_Count; }
+
+    /**
+     * Add record to batch as "MSG-LEN SP <PRI>rest"
+     *
+     * @param[in] pri PRI to write
+     * @param[in] rest record after PRI
+     * @param[in] size size of rest
+     */
+    void add(int pri, const char* rest, std::size_t size) {
+        char head[32];
+        char pris[8];
+        auto priLen{std::snprintf(pris, sizeof(pris), "<%d>", pri)};
+        auto headLen{std::snprintf(head, sizeof(head), "%zu %s", size + static_cast<std::size_t>(priLen), pris)};
+        m_Buf.append(head, static_cast<std::size_t>(headLen));
+        m_Buf.append(rest, size);
+        ++m_Count;
+    }
+
+    /**
+     * Write batch, reconnecting if needed
+     *
+     * @warning Batch is dropped if collector can't be reached
+     */
+    void flush() {
+        if (!m_Count)
+            return;
+
+        if (m_Sock < 0)
+            connect();
+
+        std::size_t done{0};
+        while (m_Sock >= 0 && done < m_Buf.size()) {
+            auto sent{::send(m_Sock, m_Buf.data() + done, m_Buf.size() - done, MSG_NOSIGNAL)};
+            ++m_Stats.writes;
+            if (sent < 0 && EINTR == errno)
+                continue;
+            if (sent <= 0) {
+                close(m_Sock);
+                m_Sock = -1;
+                break;
+            }
+            done += static_cast<std::size_t>(sent);
+        }
+
+        if (done == m_Buf.size())
+            m_Stats.forwarded += m_Count;
+        else
+            m_Stats.dropped += m_Count; // records written partly are cut by collector framing too
+
+        m_Buf.clear();
+        m_Count = 0;
+    }
+private:
+    void connect() {
+        m_Sock = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_Sock < 0)
+            return;
+
+        sockaddr_in sin{};
+        sin.sin_family = AF_INET;
+        sin.sin_port = htons(m_Port);
+        sin.sin_addr.s_addr = inet_addr(m_Addr.c_str());
+        if (::connect(m_Sock, (sockaddr*)&sin, sizeof(sin))) {
+            close(m_Sock);
+            m_Sock = -1;
+            return;
+        }
+
+        // batches are already coalesced, don't hold them back
+        int on{1};
+        setsockopt(m_Sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Take datagrams, filter, rewrite and forward them until stopped
+ */
+static void relay(const RelayArgs& args, syslog::UDPReceiver& recv, RelayStats& stats) {
+    Forwarder fwd{args.fwdAddr, args.fwdPort, args.batch, stats};
+    auto deadline{std::chrono::steady_clock::now() + std::chrono::milliseconds(args.flushMs)};
+    syslog::ParsedMsg msg;
+
+    auto handle = [&](const char* data, std::size_t size) {
+        ++stats.received;
+        while (size && ('\n' == data[size - 1] || '\0' == data[size - 1]))
+            --size;
+
+        if (!syslog::parseMsg(data, size, msg)) {
+            ++stats.invalid;
+            return;
+        }
+        if (msg.getSeverity() > args.maxLvl || (args.facility >= 0 && msg.getFacility() != args.facility)) {
+            ++stats.filtered;
+            return;
+        }
+
+        auto pri{msg.pri};
+        if (args.setFacility >= 0)
+            pri = args.setFacility * 8 + msg.getSeverity();
+
+        auto rest{static_cast<const char*>(std::memchr(data, '>', size)) + 1};
+        fwd.add(pri, rest, size - static_cast<std::size_t>(rest - data));
+        if (fwd.getCount() >= args.batch)
+            fwd.flush();
+    };
+
+    while (!g_Stop.load(std::memory_order_relaxed)) {
+        recv.poll(static_cast<int>(args.flushMs), handle);
+
+        auto now{std::chrono::steady_clock::now()};
+        if (now >= deadline) {
+            fwd.flush();
+            deadline = now + std::chrono::milliseconds(args.flushMs);
+        }
+    }
+
+    // what is still queued in the socket
+    while (recv.poll(0, handle))
+        ;
+    fwd.flush();
+}
+
+/**
+ * Pin thread to core
+ */
+static void pin(std::thread& thread, uint32_t core) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+}
+
+/**
+ * Split "ADDR:PORT"
+ */
+static bool parseEndpoint(const char* str, std::string& addr, uint16_t& port) {
+    auto colon{std::strrchr(str, ':')};
+    if (!colon)
+        return false;
+
+    addr.assign(str, static_cast<std::size_t>(colon - str));
+    port = static_cast<uint16_t>(std::strtoul(colon + 1, nullptr, 10));
+    return !addr.empty();
+}
+
+/**
+ * Parse "--name=value" options
+ */
+static bool parseArgs(int argc, char** argv, RelayArgs& args) {
+    for (auto i = 1; i < argc; ++i) {
+        const char* arg{argv[i]};
+        const char* eq{std::strchr(arg, '=')};
+        std::string name{arg, eq ? static_cast<std::size_t>(eq - arg) : std::strlen(arg)};
+        const char* value{eq ? eq + 1 : ""};
+        auto num{std::strtol(value, nullptr, 10)};
+
+        if ("--listen" == name && parseEndpoint(value, args.listenAddr, args.listenPort))
+            continue;
+        if ("--forward" == name && parseEndpoint(value, args.fwdAddr, args.fwdPort))
+            continue;
+        if ("--workers" == name && num > 0)
+            args.workers = static_cast<uint32_t>(num);
+        else if ("--pin" == name)
+            args.pin = true;
+        else if ("--max-lvl" == name && num >= 0 && num <= syslog::LogLvlMng::LL_DEBUG)
+            args.maxLvl = static_cast<int>(num);
+        else if ("--facility" == name && num >= 0 && num <= 23)
+            args.facility = static_cast<int>(num);
+        else if ("--set-facility" == name && num >= 0 && num <= 23)
+            args.setFacility = static_cast<int>(num);
+        else if ("--batch" == name && num > 0)
+            args.batch = static_cast<std::size_t>(num);
+        else if ("--flush-ms" == name && num > 0)
+            args.flushMs = static_cast<uint32_t>(num);
+        else if ("--bench" == name && num > 0)
+            args.bench = static_cast<uint32_t>(num);
+        else
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Log from producer threads for given time, drain the relay and report what reached the collector
+ */
+static void bench(RelayArgs& args, std::vector<RelayStats>& stats, uint16_t port, const std::function<void()>& start) {
+    syslog::TCPReceiver collector;
+    if (!collector.isInitialised()) {
+        std::fprintf(stderr, "relay: can't listen for collector\n");
+        return;
+    }
+    args.fwdAddr = syslog::ReceiverMng::DEFAULT_ADDR;
+    args.fwdPort = collector.getPort();
+    start();
+
+    std::atomic<bool> collecting{true};
+    std::atomic<uint64_t> collected{0};
+    std::thread collectorThread{[&]() {
+        while (collecting.load(std::memory_order_relaxed))
+            collected += collector.poll(10, [](const char*, std::size_t) {});
+    }};
+
+    std::atomic<bool> producing{true};
+    std::vector<uint64_t> sent(args.workers);
+    std::vector<std::thread> producers;
+    auto begin{std::chrono::steady_clock::now()};
+    for (uint32_t p = 0; p < args.workers; ++p)
+        producers.emplace_back([&, p]() {
+            auto client{syslog::makeUDPClient_st()};
+            client.setPort(port);
+            client.setSndBuf(4 << 20);
+            for (uint64_t n = 0; producing.load(std::memory_order_relaxed); ++n, ++sent[p])
+                client << syslog::LogLvlMng::LL_INFO << "bench producer " << p << " message " << n << std::flush;
+        });
+
+    std::this_thread::sleep_for(std::chrono::seconds(args.bench));
+    producing = false;
+    for (auto& producer : producers)
+        producer.join();
+    auto seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count()};
+
+    // relay drains its sockets and flushes on stop, then collector takes the rest
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * args.flushMs + 100));
+    g_Stop = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * args.flushMs + 100));
+    collecting = false;
+    collectorThread.join();
+
+    uint64_t total{0};
+    for (auto count : sent)
+        total += count;
+    uint64_t skipped{0};
+    for (const auto& worker : stats)
+        skipped += worker.filtered + worker.invalid;
+    auto arrived{collected + skipped};
+    std::printf("bench: %u producers, %.1f s, sent %llu, collected %llu, filtered %llu (%.2f%% lost), %.0f msg/s end to end\n",
+        args.workers, seconds, (unsigned long long)total, (unsigned long long)collected.load(), (unsigned long long)skipped,
+        total ? 100.0 * static_cast<double>(total - std::min(total, arrived)) / static_cast<double>(total) : 0.0,
+        static_cast<double>(collected.load()) / seconds);
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+int main(int argc, char** argv) {
+    RelayArgs args;
+    if (!parseArgs(argc, argv, args)) {
+        std::fprintf(stderr, "usage: %s [--listen=ADDR:PORT] [--forward=ADDR:PORT] [--workers=N] [--pin] [--max-lvl=N]"
+            " [--facility=N] [--set-facility=N] [--batch=N] [--flush-ms=N] [--bench=SECONDS]\n", argv[0]);
+        return 1;
+    }
+    if (args.bench)
+        args.listenPort = 0;
+
+    // one socket per worker on the same port, kernel spreads local apps among them
+    std::vector<std::unique_ptr<syslog::UDPReceiver>> receivers;
+    uint16_t port{args.listenPort};
+    for (uint32_t i = 0; i < args.workers; ++i) {
+        receivers.push_back(std::make_unique<syslog::UDPReceiver>(args.listenAddr.c_str(), port, args.batch, 
+            syslog::ReceiverMng::DEFAULT_MAX_MSG_SIZE, true));
+        if (!receivers.back()->isInitialised()) {
+            std::fprintf(stderr, "relay: can't listen on %s:%u\n", args.listenAddr.c_str(), port);
+            return 1;
+        }
+        receivers.back()->setRcvBuf(4 << 20);
+        port = receivers.back()->getPort();
+    }
+
+    signal(SIGINT, [](int) { g_Stop = true; });
+    signal(SIGTERM, [](int) { g_Stop = true; });
+
+    std::vector<RelayStats> stats(args.workers);
+    std::vector<std::thread> workers;
+    auto start = [&]() {
+        for (uint32_t i = 0; i < args.workers; ++i) {
+            workers.emplace_back(relay, std::cref(args), std::ref(*receivers[i]), std::ref(stats[i]));
+            if (args.pin)
+                pin(workers.back(), i);
+        }
+    };
+
+    if (args.bench)
+        bench(args, stats, port, start);
+    else
+        start();
+
+    for (auto& worker : workers)
+        worker.join();
+
+    for (uint32_t i = 0; i < args.workers; ++i)
+        std::printf("worker %u: received %llu, filtered %llu, invalid %llu, forwarded %llu, dropped %llu, writes %llu\n", i,
+            (unsigned long long)stats[i].received.load(), (unsigned long long)stats[i].filtered.load(), 
+            (unsigned long long)stats[i].invalid.load(), (unsigned long long)stats[i].forwarded.load(), 
+            (unsigned long long)stats[i].dropped.load(), (unsigned long long)stats[i].writes.load());
+}
+
+#else
+
+#include <cstdio>
+
+int main() {
+    std::fprintf(stderr, "relay: Linux only\n");
+    return 1;
+}
+
+#endif // __linux__
@@ -0,0 +1,403 @@
+/**
+ * @file buf_pool.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_BUF_POOL_HPP
+#define __CPP_SYSLOG_CLIENT_BUF_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#include "mem_resource.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Message buffers pool counters
+     */
+    struct BufPoolStats {
+        uint64_t misses; ///< blocks taken from memory resource to fill the pool
+        uint64_t oversize; ///< requests too large for the pool, served by memory resource
+    };
+
+    /**
+     * Message buffers pool with size classes, per thread caches and lock-free global free lists
+     */
+    class BufPool;
+
+    /**
+     * Standard allocator taking memory from message buffers pool
+     */
+    template<class T>
+    class PoolAllocator;
+
+    /**
+     * String keeping its data in message buffers pool
+     *
+     * @warning Memory resource, the heap by default, is still called when the pool has no free block of the size class,
+     * e.g. on first messages of a new thread, and for data larger than the largest size class
+     */
+    using PooledString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+
+    /**
+     * Make shared object in message buffers pool, aligned as its type requires
+     *
+     * @param[in] args ctor arguments
+     *
+     * @warning Pool blocks and operator new before C++17 are aligned for scalar types only, so over-aligned types,
+     * e.g. ones keeping their fields on separate cache lines, are placed at an aligned offset of a larger block
+     */
+    template<class T, class... Args>
+    std::shared_ptr<T> makePooled(Args&&... args);
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::BufPool final {
+public:
+    static constexpr std::size_t MIN_BLOCK_SIZE{64}; ///< the smallest size class
+    static constexpr std::size_t CLASSES{11}; ///< size classes, from 64 bytes to 64 KiB
+    static constexpr std::size_t MAX_BLOCKS{1024}; ///< max pooled blocks of each size class
+    static constexpr std::size_t CACHE_SIZE{16}; ///< max blocks of each size class cached by a thread
+private:
+    static constexpr uint32_t    NO_INDEX{0xFFFFFFFF}; ///< block is not pooled
+    static constexpr std::size_t HDR_SIZE{alignof(std::max_align_t)}; ///< block header, keeps data aligned
+
+    /**
+     * Block header
+     */
+    struct Hdr {
+        IMemResource* res; ///< memory resource the block was taken from
+        uint32_t      idx; ///< block index in its size class
+    };
+
+    /**
+     * Size class
+     */
+    struct Class {
+        std::atomic<uint64_t> head{0}; ///< free list top, (tag << 32) | (index + 1), 0 if empty
+        std::atomic<uint32_t> count{0}; ///< blocks made
+        std::atomic<char*>    blocks[MAX_BLOCKS]; ///< blocks data
+        std::atomic<uint32_t> next[MAX_BLOCKS]; ///< free list links, index + 1, 0 is the end
+    };
+
+    /**
+     * Blocks cached by a thread, given back to global free lists on thread exit
+     */
+    struct Cache {
+        std::size_t size[CLASSES]{}; ///< number of cached blocks
+        char*       blocks[CLASSES][CACHE_SIZE]; ///< cached blocks data
+
+        ~Cache() {
+            for (std::size_t cls = 0; cls < CLASSES; ++cls) {
+                while (size[cls])
+                    instance().push(cls, blocks[cls][--size[cls]]);
+            }
+            alive() = false;
+        }
+
+        /**
+         * Calling thread cache is usable?
+         *
+         * @warning Trivially destructible, so it may be checked after the cache is destroyed
+         */
+        static bool& alive() noexcept {
+            thread_local bool on{true};
+            return on;
+        }
+    };
+private:
+    std::unique_ptr<Class[]> m_Classes; ///< size classes
+    std::atomic<uint64_t>    m_Misses; ///< blocks taken from memory resource
+    std::atomic<uint64_t>    m_Oversize; ///< requests served by memory resource
+public:
+    /**
+     * Get process wide pool
+     *
+     * @warning Never destroyed, buffers of static objects may be released after exit() begins
+     */
+    static BufPool& instance() {
+        static auto pool{new BufPool};
+        return *pool;
+    }
+
+    /**
+     * Copy ctor
+     */
+    BufPool(const BufPool&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    BufPool& operator=(const BufPool&) = delete;
+
+    /**
+     * Get memory
+     *
+     * @param[in] size size in bytes
+     *
+     * @warning Lock free, memory resource is used only to fill the pool and for requests larger than the largest size class
+     */
+    void* allocate(std::size_t size) {
+        auto cls{classOf(size)};
+        if (CLASSES == cls) {
+            m_Oversize.fetch_add(1, std::memory_order_relaxed);
+            return take(size, NO_INDEX);
+        }
+
+        auto cache{threadCache()};
+        if (cache && cache->size[cls])
+            return cache->blocks[cls][--cache->size[cls]];
+
+        auto data{pop(cls)};
+        return data ? data : make(cls);
+    }
+
+    /**
+     * Give memory back
+     *
+     * @param[in] ptr memory got by allocate()
+     * @param[in] size size passed to allocate()
+     */
+    void deallocate(void* ptr, std::size_t size) noexcept {
+        auto cls{classOf(size)};
+        auto data{static_cast<char*>(ptr)};
+        if (NO_INDEX == hdr(data).idx) {
+            hdr(data).res->deallocate(data - HDR_SIZE, HDR_SIZE + (CLASSES == cls ? size : blockSize(cls)));
+            return;
+        }
+
+        auto cache{threadCache()};
+        if (cache && cache->size[cls] < CACHE_SIZE) {
+            cache->blocks[cls][cache->size[cls]++] = data;
+            return;
+        }
+
+        push(cls, data);
+    }
+
+    /**
+     * Getter
+     *
+     * @return Pool counters snapshot
+     */
+    BufPoolStats getStats() const noexcept {
+        return BufPoolStats{
+            m_Misses.load(std::memory_order_relaxed),
+            m_Oversize.load(std::memory_order_relaxed)
+        };
+    }
+
+    /**
+     * Get block size of size class
+     *
+     * @param[in] cls size class
+     */
+    static std::size_t blockSize(std::size_t cls) noexcept { return MIN_BLOCK_SIZE << cls; }
+
+    /**
+     * Get size class fitting size
+     *
+     * @param[in] size size in bytes
+     *
+     * @return CLASSES if size exceeds the largest size class
+     */
+    static std::size_t classOf(std::size_t size) noexcept {
+        std::size_t cls{0};
+        while (cls < CLASSES && blockSize(cls) < size)
+            ++cls;
+        return cls;
+    }
+private:
+    /**
+     * Ctor
+     */
+    BufPool() : m_Classes{new Class[CLASSES]}, m_Misses{0}, m_Oversize{0} { }
+
+    /**
+     * Get calling thread cache
+     *
+     * @return nullptr if thread is exiting and its cache is already destroyed
+     */
+    static Cache* threadCache() noexcept {
+        if (!Cache::alive())
+            return nullptr;
+
+        thread_local Cache cache;
+        return &cache;
+    }
+
+    static Hdr& hdr(char* data) noexcept { return *reinterpret_cast<Hdr*>(data - HDR_SIZE); }
+
+    /**
+     * Take memory with block header from memory resource
+     *
+     * @param[in] size data size
+     * @param[in] idx block index
+     *
+     * @warning Taking a pooled block pins the resource, see syslog::setMemResource()
+     */
+    static char* take(std::size_t size, uint32_t idx) {
+        auto& res{NO_INDEX == idx ? getMemResource() : pinMemResource()};
+        auto data{static_cast<char*>(res.allocate(HDR_SIZE + size)) + HDR_SIZE};
+        hdr(data).res = &res;
+        hdr(data).idx = idx;
+        return data;
+    }
+
+    /**
+     * Take a new block from memory resource
+     *
+     * @param[in] cls size class
+     */
+    char* make(std::size_t cls) {
+        auto& sc{m_Classes[cls]};
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+
+        auto idx{sc.count.fetch_add(1, std::memory_order_relaxed)};
+        if (idx >= MAX_BLOCKS) {
+            sc.count.fetch_sub(1, std::memory_order_relaxed);
+            return take(blockSize(cls), NO_INDEX); // the pool is full, block goes back to its resource
+        }
+
+        auto data{take(blockSize(cls), idx)};
+        sc.blocks[idx].store(data, std::memory_order_relaxed);
+        return data;
+    }
+
+    /**
+     * Take a block from global free list
+     *
+     * @param[in] cls size class
+     *
+     * @return nullptr if free list is empty
+     */
+    char* pop(std::size_t cls) noexcept {
+        auto& sc{m_Classes[cls]};
+        auto head{sc.head.load(std::memory_order_acquire)};
+
+        for (;;) {
+            auto top{static_cast<uint32_t>(head)};
+            if (!top)
+                return nullptr;
+
+            // tag changes on every update, so a stale link never wins
+            auto next{sc.next[top - 1].load(std::memory_order_relaxed)};
+            auto updated{(((head >> 32) + 1) << 32) | next};
+            if (sc.head.compare_exchange_weak(head, updated, std::memory_order_acquire, std::memory_order_acquire))
+                return sc.blocks[top - 1].load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Put a block into global free list
+     *
+     * @param[in] cls size class
+     * @param[in] data block data
+     */
+    void push(std::size_t cls, char* data) noexcept {
+        auto& sc{m_Classes[cls]};
+        auto idx{hdr(data).idx};
+        auto head{sc.head.load(std::memory_order_relaxed)};
+
+        for (;;) {
+            sc.next[idx].store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            auto updated{(((head >> 32) + 1) << 32) | (idx + 1)};
+            if (sc.head.compare_exchange_weak(head, updated, std::memory_order_release, std::memory_order_relaxed))
+                return;
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class T>
+class syslog::details::PoolAllocator {
+public:
+    using value_type = T;
+public:
+    PoolAllocator() noexcept = default;
+
+    template<class U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept { }
+
+    T* allocate(std::size_t n) { return static_cast<T*>(BufPool::instance().allocate(n * sizeof(T))); }
+
+    void deallocate(T* ptr, std::size_t n) noexcept { BufPool::instance().deallocate(ptr, n * sizeof(T)); }
+
+    template<class U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+
+    template<class U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class T, class... Args>
+std::shared_ptr<T> syslog::details::makePooled(Args&&... args) {
+    static constexpr std::size_t SIZE{sizeof(T) + alignof(T)}; ///< room for the object at any aligned offset
+
+    auto raw{BufPool::instance().allocate(SIZE)};
+    void* ptr{raw};
+    std::size_t space{SIZE};
+    std::align(alignof(T), sizeof(T), ptr, space);
+
+    T* obj{nullptr};
+    try {
+        obj = new (ptr) T(std::forward<Args>(args)...);
+    }
+    catch (...) {
+        BufPool::instance().deallocate(raw, SIZE);
+        throw;
+    }
+
+    // deleter is called if control block can't be made
+    return std::shared_ptr<T>(
+        obj, 
+        [raw](T* p) { 
+            p->~T(); 
+            BufPool::instance().deallocate(raw, SIZE); 
+        }, 
+        PoolAllocator<T>{}
+    );
+}
+
+#endif // __CPP_SYSLOG_CLIENT_BUF_POOL_HPP
@@ -33,15 +33,23 @@
 #else
  #include <arpa/inet.h>
  #include <unistd.h>
+ #include <fcntl.h>
+ #include <errno.h>
  #include <sys/socket.h>
+ #include <sys/uio.h>
  #include <netinet/in.h>
 #endif // WIN32
 #include <string>
+#include <memory>
+#include <atomic>
 
 #if defined(WIN32)
  #include "winwsa.hpp"
 #endif // WIN32
 #include "client_int.hpp"
+#include "metrics.hpp"
+#include "retrier.hpp"
+#include "msg_size.hpp"
 
 /**
  * Lib space
@@ -61,10 +69,15 @@ private:
     static constexpr const char *const DEFAULT_ADDR{"127.0.0.1"}; ///< default
     static constexpr uint16_t          DEFAULT_PORT{514}; ///< default
     static constexpr int32_t           DEFAULT_SOCK{-1}; ///< default
+    static constexpr std::size_t       MAX_SEGMENTS{16}; ///< max segments gathered by one system call
 private:
-    uint32_t m_Addr; ///< host IP-address
-    uint16_t m_Port; ///< host port
-    int32_t  m_Sock; ///< socket handler
+    std::atomic<uint32_t>                  m_Addr; ///< host IP-address
+    std::atomic<uint16_t>                  m_Port; ///< host port
+    int32_t                                m_Sock; ///< socket handler
+    std::atomic<std::size_t>               m_MaxMsgSize; ///< max datagram payload
+    std::shared_ptr<details::SendCounters> m_Counters; ///< data sender counters
+    std::atomic<details::Retrier*>         m_Retrier; ///< background retry, created on demand
+    std::atomic<bool>                      m_RetryOn; ///< background retry enabled
 public:
     /**
      * Ctor
@@ -73,7 +86,11 @@ public:
     ) :
         m_Addr{inet_addr(DEFAULT_ADDR)}, // const char* -> uint32_t
         m_Port{DEFAULT_PORT},
-        m_Sock{DEFAULT_SOCK} 
+        m_Sock{DEFAULT_SOCK},
+        m_MaxMsgSize{MsgSizeMng::DEFAULT_UDP_MSG_SIZE},
+        m_Counters{std::make_shared<details::SendCounters>()},
+        m_Retrier{nullptr},
+        m_RetryOn{false}
     {
 #if defined(WIN32)
         details::WinWSA::instance().startup();
@@ -99,9 +116,13 @@ public:
     explicit UDPClient(
         UDPClient&& other
     ) noexcept : 
-        m_Addr{other.m_Addr}, 
-        m_Port{other.m_Port}, 
-        m_Sock{other.m_Sock} 
+        m_Addr{other.m_Addr.load()}, 
+        m_Port{other.m_Port.load()}, 
+        m_Sock{other.m_Sock},
+        m_MaxMsgSize{other.m_MaxMsgSize.load()},
+        m_Counters{std::move(other.m_Counters)},
+        m_Retrier{other.m_Retrier.exchange(nullptr)},
+        m_RetryOn{other.m_RetryOn.load()}
     {
         other.m_Sock = DEFAULT_SOCK; // uninitialise moving syslog::UDPClient class instance
     }
@@ -116,9 +137,15 @@ public:
         if (&other == this)
             return *this;
 
-        m_Addr = other.m_Addr;
-        m_Port = other.m_Port;
+        closeSock();
+
+        m_Addr = other.m_Addr.load();
+        m_Port = other.m_Port.load();
         m_Sock = other.m_Sock;
+        m_MaxMsgSize = other.m_MaxMsgSize.load();
+        m_Counters = std::move(other.m_Counters);
+        m_Retrier = other.m_Retrier.exchange(nullptr);
+        m_RetryOn = other.m_RetryOn.load();
 
         other.m_Sock = DEFAULT_SOCK; // uninitialise moving syslog::UDPClient class instance
         return *this;
@@ -127,16 +154,7 @@ public:
     /**
      * Dtor
      */
-    ~UDPClient() {
-        if (isInitialised()) {
-#if defined(WIN32)
-            closesocket(m_Sock);
-            details::WinWSA::instance().cleanup();
-#else
-            close(m_Sock);
-#endif // WIN32
-        }
-    }
+    ~UDPClient() { closeSock(); }
 
     /**
      * Setter
@@ -152,6 +170,84 @@ public:
      */
     void setPort(uint16_t port) noexcept override { m_Port = port; }
 
+    /**
+     * Setter
+     *
+     * @param[in] on don't block the caller when the kernel queue is full
+     *
+     * @warning By default, socket is blocking
+     * @warning If socket mode can't be changed, it's kept and the failure is counted in getStats().errors
+     * with its errno, as failed sends are
+     */
+    void setNonBlocking(bool on) noexcept override {
+        if (!isInitialised())
+            return;
+
+#if defined(WIN32)
+        u_long mode{on ? 1UL : 0UL};
+        if (ioctlsocket(m_Sock, FIONBIO, &mode))
+            m_Counters->incErrors(lastError());
+#else
+        auto flags{fcntl(m_Sock, F_GETFL, 0)};
+        if (flags < 0 || fcntl(m_Sock, F_SETFL, on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) < 0)
+            m_Counters->incErrors(lastError());
+#endif // WIN32
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] size socket send buffer size (SO_SNDBUF) in bytes
+     *
+     * @warning By default, system wide value is used
+     * @warning Kernel may round or limit requested value
+     */
+    void setSndBuf(int32_t size) noexcept override {
+        if (isInitialised() && size > 0)
+            setsockopt(m_Sock, SOL_SOCKET, SO_SNDBUF, (const char*)&size, sizeof(size));
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] on retry refused data once from a background thread
+     *
+     * @warning By default, refused data is dropped
+     * @warning Background thread is started on first enabling and lives until socket is closed,
+     * so concurrent senders never see it destroyed
+     */
+    void setRetry(bool on) noexcept override {
+        if (on && isInitialised() && !m_Retrier.load()) {
+            try {
+                details::Retrier* expected{nullptr};
+                std::unique_ptr<details::Retrier> retrier{new details::Retrier{m_Sock, m_Counters}};
+                if (m_Retrier.compare_exchange_strong(expected, retrier.get()))
+                    retrier.release();
+            }
+            catch (...) {
+                // no thread, no retry
+            }
+        }
+
+        m_RetryOn = on;
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] size max datagram payload
+     *
+     * @warning By default, max datagram payload is syslog::MsgSizeMng::DEFAULT_UDP_MSG_SIZE
+     */
+    void setMaxMsgSize(std::size_t size) noexcept override { m_MaxMsgSize = size; }
+
+    /**
+     * Getter
+     *
+     * @return Max datagram payload
+     */
+    std::size_t getMaxMsgSize() const noexcept override { return m_MaxMsgSize; }
+
     /**
      * Getter 
      *
@@ -159,6 +255,25 @@ public:
      */
     int32_t getSock() const noexcept override { return m_Sock; }
 
+    /**
+     * Getter
+     *
+     * @return Data sender counters snapshot
+     */
+    SendStats getStats() const noexcept override { 
+        return m_Counters ? m_Counters->get() : SendStats{0, 0, 0, 0, 0}; 
+    }
+
+    /**
+     * Add data sender counters, bytes, errors and queue depth to snapshot
+     *
+     * @param[in,out] metrics snapshot
+     */
+    void collectMetrics(Metrics& metrics) const noexcept override {
+        if (m_Counters)
+            m_Counters->collect(metrics);
+    }
+
     /**
      * Socket initialised?
      */
@@ -168,26 +283,146 @@ public:
      * Send data
      *
      * @param[in] buf data
+     *
+     * @warning Thread-safe
      */
     void send(
         std::string&& buf
     ) const noexcept override 
     { 
-        auto moved{std::move(buf)};
-        if (!moved.empty() && isInitialised()) {
-            sockaddr_in to;
-            to.sin_family = AF_INET;
-            to.sin_port = htons(m_Port);
-            to.sin_addr.s_addr = m_Addr;
-
-            sendto(
-                m_Sock, 
-                moved.c_str(), 
-                moved.size(), 
-                0, 
-                (sockaddr*)&to, 
-                sizeof(to)
-            );
+        details::Segment seg{buf.data(), buf.size()};
+        send(&seg, 1);
+    }
+
+    /**
+     * Send data gathered from segments as a single datagram
+     *
+     * @param[in] segs segments
+     * @param[in] count number of segments
+     *
+     * @warning In non-blocking mode data refused by a full kernel queue is counted and 
+     * either handed over to the background retry or dropped, the caller never waits
+     * @warning Thread-safe
+     */
+    void send(
+        const details::Segment* segs,
+        std::size_t count
+    ) const noexcept override
+    {
+        if (count > MAX_SEGMENTS) {
+            IClient::send(segs, count); // joined, comes back as a single segment
+            return;
+        }
+
+        std::size_t size{0};
+        for (std::size_t i = 0; i < count; ++i)
+            size += segs[i].size;
+
+        if (!size || !isInitialised())
+            return;
+
+        sockaddr_in to;
+        to.sin_family = AF_INET;
+        to.sin_port = htons(m_Port.load(std::memory_order_relaxed));
+        to.sin_addr.s_addr = m_Addr.load(std::memory_order_relaxed);
+
+#if defined(WIN32)
+        WSABUF bufs[MAX_SEGMENTS];
+        for (std::size_t i = 0; i < count; ++i) {
+            bufs[i].len = static_cast<ULONG>(segs[i].size);
+            bufs[i].buf = const_cast<CHAR*>(segs[i].data);
+        }
+
+        DWORD sent{0};
+        auto res{
+            WSASendTo(
+                m_Sock,
+                bufs,
+                static_cast<DWORD>(count),
+                &sent,
+                0,
+                (sockaddr*)&to,
+                sizeof(to),
+                nullptr,
+                nullptr
+            )
+        };
+#else
+        iovec bufs[MAX_SEGMENTS];
+        for (std::size_t i = 0; i < count; ++i) {
+            bufs[i].iov_base = const_cast<char*>(segs[i].data);
+            bufs[i].iov_len = segs[i].size;
+        }
+
+        msghdr msg{};
+        msg.msg_name = &to;
+        msg.msg_namelen = sizeof(to);
+        msg.msg_iov = bufs;
+        msg.msg_iovlen = count;
+
+        auto res{sendmsg(m_Sock, &msg, 0)};
+#endif // WIN32
+
+        if (res >= 0)
+            m_Counters->incSent(size);
+        else if (isQueueFull())
+            onQueueFull(segs, count, to);
+        else
+            m_Counters->incErrors(lastError());
+    }
+private:
+    /**
+     * Last send failed because the kernel queue is full?
+     */
+    static bool isQueueFull() noexcept {
+#if defined(WIN32)
+        auto err{WSAGetLastError()};
+        return WSAEWOULDBLOCK == err || WSAENOBUFS == err;
+#else
+        return EAGAIN == errno || EWOULDBLOCK == errno || ENOBUFS == errno;
+#endif // WIN32
+    }
+
+    /**
+     * Get error code of the last failed send
+     */
+    static int lastError() noexcept {
+#if defined(WIN32)
+        return WSAGetLastError();
+#else
+        return errno;
+#endif // WIN32
+    }
+
+    /**
+     * Account refused data
+     *
+     * @param[in] segs segments
+     * @param[in] count number of segments
+     * @param[in] to destination
+     */
+    void onQueueFull(const details::Segment* segs, std::size_t count, const sockaddr_in& to) const noexcept {
+        m_Counters->incAgain();
+
+        auto retrier{m_Retrier.load(std::memory_order_acquire)};
+        if (!m_RetryOn.load(std::memory_order_relaxed) || !retrier || !retrier->push(segs, count, to))
+            m_Counters->incDropped();
+    }
+
+    /**
+     * Stop background retry and close socket
+     */
+    void closeSock() noexcept {
+        delete m_Retrier.exchange(nullptr); // pending data still needs the socket
+
+        if (isInitialised()) {
+#if defined(WIN32)
+            closesocket(m_Sock);
+            details::WinWSA::instance().cleanup();
+#else
+            close(m_Sock);
+#endif // WIN32
+            m_Sock = DEFAULT_SOCK;
         }
     }
 };
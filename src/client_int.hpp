@@ -28,7 +28,11 @@
 #ifndef __CPP_SYSLOG_CLIENT_CLIENT_INT_HPP
 #define __CPP_SYSLOG_CLIENT_CLIENT_INT_HPP
 
+#include <cstddef>
 #include <string>
+#include <limits>
+
+#include "metrics.hpp"
 
 /**
  * Lib space
@@ -38,6 +42,14 @@ namespace syslog {
  * Details
  */
 namespace details {
+    /**
+     * Piece of data sent without copying
+     */
+    struct Segment {
+        const char* data; ///< data
+        std::size_t size; ///< data size
+    };
+
     /**
      * Interface for sending data
      */
@@ -68,6 +80,51 @@ public:
      */
     virtual void setPort(uint16_t port) noexcept = 0;
 
+    /**
+     * Setter
+     *
+     * @param[in] on don't block the caller when the kernel queue is full
+     *
+     * @warning By default, ignored
+     */
+    virtual void setNonBlocking(bool) noexcept { }
+
+    /**
+     * Setter
+     *
+     * @param[in] size socket send buffer size (SO_SNDBUF) in bytes
+     *
+     * @warning By default, ignored
+     */
+    virtual void setSndBuf(int32_t) noexcept { }
+
+    /**
+     * Setter
+     *
+     * @param[in] on retry refused data once from a background thread
+     *
+     * @warning By default, ignored
+     */
+    virtual void setRetry(bool) noexcept { }
+
+    /**
+     * Setter
+     *
+     * @param[in] size max message size fitting one transport unit
+     *
+     * @warning By default, ignored, see getMaxMsgSize()
+     */
+    virtual void setMaxMsgSize(std::size_t) noexcept { }
+
+    /**
+     * Getter
+     *
+     * @return Max message size fitting one transport unit
+     *
+     * @warning By default, unlimited, so messages are never truncated or split
+     */
+    virtual std::size_t getMaxMsgSize() const noexcept { return std::numeric_limits<std::size_t>::max(); }
+
     /**
      * Getter 
      *
@@ -75,6 +132,24 @@ public:
      */
     virtual int32_t getSock() const noexcept = 0;
 
+    /**
+     * Getter
+     *
+     * @return Data sender counters snapshot
+     *
+     * @warning By default, all counters are zero
+     */
+    virtual SendStats getStats() const noexcept { return SendStats{0, 0, 0, 0, 0}; }
+
+    /**
+     * Add data sender counters, bytes, errors and queue depth to snapshot
+     *
+     * @param[in,out] metrics snapshot
+     *
+     * @warning By default, only getStats() counters are added
+     */
+    virtual void collectMetrics(Metrics& metrics) const noexcept { metrics.send = getStats(); }
+
     /**
      * Socket initialised?
      */
@@ -84,8 +159,38 @@ public:
      * Send data
      *
      * @param[in] buf data
+     *
+     * @warning Must be thread-safe, it's called without any lock
      */
     virtual void send(std::string&& buf) const noexcept = 0;
+
+    /**
+     * Send data gathered from segments as a single message
+     *
+     * @param[in] segs segments
+     * @param[in] count number of segments
+     *
+     * @warning Must be thread-safe, it's called without any lock
+     * @warning By default, segments are joined and sent by send(std::string&&), 
+     * transports able to gather data (sendmsg(), WSASendTo()) should override it
+     */
+    virtual void send(const Segment* segs, std::size_t count) const noexcept {
+        try {
+            std::size_t size{0};
+            for (std::size_t i = 0; i < count; ++i)
+                size += segs[i].size;
+
+            std::string buf;
+            buf.reserve(size);
+            for (std::size_t i = 0; i < count; ++i)
+                buf.append(segs[i].data, segs[i].size);
+
+            send(std::move(buf));
+        }
+        catch (...) {
+            // no memory, no message
+        }
+    }
 };
 
 #endif // __CPP_SYSLOG_CLIENT_CLIENT_INT_HPP
\ No newline at end of file
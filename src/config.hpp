@@ -0,0 +1,82 @@
+/**
+ * @file config.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_CONFIG_HPP
+#define __CPP_SYSLOG_CLIENT_CONFIG_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <string>
+
+#include "level.hpp"
+#include "facility.hpp"
+#include "msg_size.hpp"
+#include "fmt_int.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Message assembly configuration
+     *
+     * @warning Immutable once published by syslog::details::Snapshot
+     */
+    struct Config;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::Config {
+    LogLvlMng::LogLvl                        lvl; ///< log severity level
+    LogFacilityMng::LogFacility              facility; ///< log facility
+    MsgSizeMng::MsgSizePolicy                sizePolicy; ///< oversized messages policy
+    bool                                     sanitize; ///< control chars and malformed UTF-8 of messages are replaced
+    std::vector<std::shared_ptr<IFormatter>> formatters; ///< formatter flags
+    std::string                              sdId; ///< SD-ID of structured data element
+    std::array<std::string, 8>               pri; ///< message header start "<PRI> " of each log severity level
+
+    /**
+     * Cache message header start of each log severity level
+     *
+     * @warning Must be called whenever log facility is changed
+     * 
+     * @link https://datatracker.ietf.org/doc/html/rfc5424#section-6.2.1
+     */
+    void cachePri() {
+        for (std::size_t lvl = 0; lvl < pri.size(); ++lvl)
+            pri[lvl] = "<" + std::to_string((facility << 3) + lvl) + "> ";
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_CONFIG_HPP
@@ -0,0 +1,699 @@
+/**
+ * @file conv.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_CONV_HPP
+#define __CPP_SYSLOG_CLIENT_CONV_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * String of chars with any allocator
+     *
+     * @tparam A allocator
+     */
+    template<class A>
+    using BasicString = std::basic_string<char, std::char_traits<char>, A>;
+
+    /**
+     * Unsigned integer of fixed capacity, exact arithmetic for floating point to decimal conversion
+     *
+     * @tparam WORDS capacity in 32 bit words
+     */
+    template<std::size_t WORDS>
+    class BigUInt;
+
+    /**
+     * Get two digit decimal pairs table "000102...99"
+     */
+    inline const char* digitPairs() noexcept {
+        static const char table[]{
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899"
+        };
+        return table;
+    }
+
+    /**
+     * Write unsigned integer in decimal backwards
+     *
+     * @param[in] val value to convert
+     * @param[in] end end of output buffer, at least 20 chars before it must be available
+     *
+     * @return Beginning of written text
+     */
+    template<class T>
+    char* writeDec(T val, char* end) noexcept {
+        static_assert(std::is_unsigned<T>::value, "unsigned type is expected");
+
+        auto pairs{digitPairs()};
+        while (val >= 100) {
+            auto idx{static_cast<std::size_t>(val % 100) * 2};
+            val /= 100;
+            *--end = pairs[idx + 1];
+            *--end = pairs[idx];
+        }
+
+        if (val >= 10) {
+            auto idx{static_cast<std::size_t>(val) * 2};
+            *--end = pairs[idx + 1];
+            *--end = pairs[idx];
+        }
+        else {
+            *--end = static_cast<char>('0' + val);
+        }
+
+        return end;
+    }
+
+    /**
+     * Append integer in decimal, as std::ostream in "C" locale does
+     *
+     * @param[in,out] out output
+     * @param[in] val value to convert
+     */
+    template<class A, class T>
+    typename std::enable_if<std::is_integral<T>::value>::type appendDec(
+        BasicString<A>& out, 
+        T val
+    ) 
+    {
+        using U = typename std::make_unsigned<T>::type;
+
+        char buf[24];
+        auto end{buf + sizeof(buf)};
+        auto uval{static_cast<U>(val)};
+        auto negative{val < 0};
+        if (negative)
+            uval = static_cast<U>(0) - uval; // safe for min value
+
+        auto begin{writeDec(uval, end)};
+        if (negative)
+            *--begin = '-';
+
+        out.append(begin, end);
+    }
+
+    /**
+     * Power of 10 approximated by 64 bit significand, 10^dexp ~= sig * 2^exp
+     */
+    struct CachedPow10 {
+        uint64_t sig; ///< significand rounded to nearest, the highest bit is set
+        int      exp; ///< binary exponent
+        int      dexp; ///< decimal exponent
+    };
+
+    /**
+     * Get cached power of 10 scaling binary exponent into [minExp, minExp + 28]
+     *
+     * @param[in] minExp min binary exponent of the scaled value
+     * @param[out] pow power of 10
+     *
+     * @return false if value is out of the table range, e.g. it's a long double with a huge exponent
+     */
+    inline bool cachedPow10(int minExp, CachedPow10& pow) noexcept {
+        static constexpr int FIRST_DEXP{-348}; ///< decimal exponent of the first power
+        static constexpr int STEP{8}; ///< decimal exponent distance
+        static const CachedPow10 pows[]{
+            {0xFA8FD5A0081C0288ULL, -1220, -348},
+            {0xBAAEE17FA23EBF76ULL, -1193, -340},
+            {0x8B16FB203055AC76ULL, -1166, -332},
+            {0xCF42894A5DCE35EAULL, -1140, -324},
+            {0x9A6BB0AA55653B2DULL, -1113, -316},
+            {0xE61ACF033D1A45DFULL, -1087, -308},
+            {0xAB70FE17C79AC6CAULL, -1060, -300},
+            {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+            {0xBE5691EF416BD60CULL, -1007, -284},
+            {0x8DD01FAD907FFC3CULL, -980, -276},
+            {0xD3515C2831559A83ULL, -954, -268},
+            {0x9D71AC8FADA6C9B5ULL, -927, -260},
+            {0xEA9C227723EE8BCBULL, -901, -252},
+            {0xAECC49914078536DULL, -874, -244},
+            {0x823C12795DB6CE57ULL, -847, -236},
+            {0xC21094364DFB5637ULL, -821, -228},
+            {0x9096EA6F3848984FULL, -794, -220},
+            {0xD77485CB25823AC7ULL, -768, -212},
+            {0xA086CFCD97BF97F4ULL, -741, -204},
+            {0xEF340A98172AACE5ULL, -715, -196},
+            {0xB23867FB2A35B28EULL, -688, -188},
+            {0x84C8D4DFD2C63F3BULL, -661, -180},
+            {0xC5DD44271AD3CDBAULL, -635, -172},
+            {0x936B9FCEBB25C996ULL, -608, -164},
+            {0xDBAC6C247D62A584ULL, -582, -156},
+            {0xA3AB66580D5FDAF6ULL, -555, -148},
+            {0xF3E2F893DEC3F126ULL, -529, -140},
+            {0xB5B5ADA8AAFF80B8ULL, -502, -132},
+            {0x87625F056C7C4A8BULL, -475, -124},
+            {0xC9BCFF6034C13053ULL, -449, -116},
+            {0x964E858C91BA2655ULL, -422, -108},
+            {0xDFF9772470297EBDULL, -396, -100},
+            {0xA6DFBD9FB8E5B88FULL, -369, -92},
+            {0xF8A95FCF88747D94ULL, -343, -84},
+            {0xB94470938FA89BCFULL, -316, -76},
+            {0x8A08F0F8BF0F156BULL, -289, -68},
+            {0xCDB02555653131B6ULL, -263, -60},
+            {0x993FE2C6D07B7FACULL, -236, -52},
+            {0xE45C10C42A2B3B06ULL, -210, -44},
+            {0xAA242499697392D3ULL, -183, -36},
+            {0xFD87B5F28300CA0EULL, -157, -28},
+            {0xBCE5086492111AEBULL, -130, -20},
+            {0x8CBCCC096F5088CCULL, -103, -12},
+            {0xD1B71758E219652CULL, -77, -4},
+            {0x9C40000000000000ULL, -50, 4},
+            {0xE8D4A51000000000ULL, -24, 12},
+            {0xAD78EBC5AC620000ULL, 3, 20},
+            {0x813F3978F8940984ULL, 30, 28},
+            {0xC097CE7BC90715B3ULL, 56, 36},
+            {0x8F7E32CE7BEA5C70ULL, 83, 44},
+            {0xD5D238A4ABE98068ULL, 109, 52},
+            {0x9F4F2726179A2245ULL, 136, 60},
+            {0xED63A231D4C4FB27ULL, 162, 68},
+            {0xB0DE65388CC8ADA8ULL, 189, 76},
+            {0x83C7088E1AAB65DBULL, 216, 84},
+            {0xC45D1DF942711D9AULL, 242, 92},
+            {0x924D692CA61BE758ULL, 269, 100},
+            {0xDA01EE641A708DEAULL, 295, 108},
+            {0xA26DA3999AEF774AULL, 322, 116},
+            {0xF209787BB47D6B85ULL, 348, 124},
+            {0xB454E4A179DD1877ULL, 375, 132},
+            {0x865B86925B9BC5C2ULL, 402, 140},
+            {0xC83553C5C8965D3DULL, 428, 148},
+            {0x952AB45CFA97A0B3ULL, 455, 156},
+            {0xDE469FBD99A05FE3ULL, 481, 164},
+            {0xA59BC234DB398C25ULL, 508, 172},
+            {0xF6C69A72A3989F5CULL, 534, 180},
+            {0xB7DCBF5354E9BECEULL, 561, 188},
+            {0x88FCF317F22241E2ULL, 588, 196},
+            {0xCC20CE9BD35C78A5ULL, 614, 204},
+            {0x98165AF37B2153DFULL, 641, 212},
+            {0xE2A0B5DC971F303AULL, 667, 220},
+            {0xA8D9D1535CE3B396ULL, 694, 228},
+            {0xFB9B7CD9A4A7443CULL, 720, 236},
+            {0xBB764C4CA7A44410ULL, 747, 244},
+            {0x8BAB8EEFB6409C1AULL, 774, 252},
+            {0xD01FEF10A657842CULL, 800, 260},
+            {0x9B10A4E5E9913129ULL, 827, 268},
+            {0xE7109BFBA19C0C9DULL, 853, 276},
+            {0xAC2820D9623BF429ULL, 880, 284},
+            {0x80444B5E7AA7CF85ULL, 907, 292},
+            {0xBF21E44003ACDD2DULL, 933, 300},
+            {0x8E679C2F5E44FF8FULL, 960, 308},
+            {0xD433179D9C8CB841ULL, 986, 316},
+            {0x9E19DB92B4E31BA9ULL, 1013, 324},
+            {0xEB96BF6EBADF77D9ULL, 1039, 332},
+            {0xAF87023B9BF0EE6BULL, 1066, 340}
+        };
+        static constexpr int SIZE{static_cast<int>(sizeof(pows) / sizeof(pows[0]))};
+
+        // 1 / log2(10)
+        auto k{static_cast<int>(std::ceil((minExp + 63) * 0.30102999566398114))};
+        auto idx{(-FIRST_DEXP + k - 1) / STEP + 1};
+        if (-FIRST_DEXP + k - 1 < 0 || idx < 0 || idx >= SIZE)
+            return false;
+
+        pow = pows[idx];
+        return pow.exp >= minExp && pow.exp <= minExp + 28;
+    }
+
+    /**
+     * Multiply 64 bit significands, keep the highest 64 bits rounded to nearest
+     */
+    inline uint64_t mulHigh(uint64_t a, uint64_t b) noexcept {
+        const uint64_t M32{0xFFFFFFFFu};
+        auto ah{a >> 32};
+        auto al{a & M32};
+        auto bh{b >> 32};
+        auto bl{b & M32};
+        auto mid{((al * bl) >> 32) + ((ah * bl) & M32) + ((al * bh) & M32) + (uint64_t{1} << 31)};
+        return ah * bh + ((ah * bl) >> 32) + ((al * bh) >> 32) + (mid >> 32);
+    }
+
+    /**
+     * Generate first digits of mant * 2^exp from its approximation by cached power of 10 (Grisu counted mode)
+     *
+     * @param[in] mant significand, the highest bit is set
+     * @param[in] exp binary exponent
+     * @param[out] digits rounded digits
+     * @param[in] count number of digits
+     * @param[out] dexp decimal exponent of the first digit
+     *
+     * @return false if the approximation error doesn't allow to round for sure, e.g. the value is a tie
+     *
+     * @link https://www.cs.tufts.edu/~nr/cs257/archive/florian-loitsch/printf.pdf
+     */
+    inline bool fastDigits(uint64_t mant, int exp, char* digits, int count, int& dexp) noexcept {
+        // scaled value has integral part of 4..32 bits, its digits are taken by division
+        static constexpr int MIN_EXP{-60};
+
+        CachedPow10 pow;
+        if (!cachedPow10(MIN_EXP - (exp + 64), pow))
+            return false;
+
+        auto scaled{mulHigh(mant, pow.sig)};
+        auto shift{-(exp + pow.exp + 64)};
+        auto one{uint64_t{1} << shift};
+        auto integrals{static_cast<uint32_t>(scaled >> shift)};
+        auto fractionals{scaled & (one - 1)};
+        uint64_t error{1}; // cached power and product are within half an unit each
+
+        uint32_t divisor{1};
+        int kappa{1};
+        while (integrals / divisor >= 10) {
+            divisor *= 10;
+            ++kappa;
+        }
+
+        int n{0};
+        uint64_t rest;
+        uint64_t tenKappa;
+        for (;;) {
+            digits[n++] = static_cast<char>('0' + integrals / divisor);
+            integrals %= divisor;
+            --kappa;
+            if (n == count || 0 == kappa)
+                break;
+            divisor /= 10;
+        }
+
+        if (n == count) {
+            rest = (static_cast<uint64_t>(integrals) << shift) + fractionals;
+            tenKappa = static_cast<uint64_t>(divisor) << shift;
+        }
+        else {
+            for (; n < count && fractionals > error; --kappa) {
+                fractionals *= 10;
+                error *= 10;
+                digits[n++] = static_cast<char>('0' + (fractionals >> shift));
+                fractionals &= one - 1;
+            }
+            if (n != count)
+                return false;
+            rest = fractionals;
+            tenKappa = one;
+        }
+
+        if (error >= tenKappa || tenKappa - error <= error)
+            return false;
+
+        dexp = kappa + count - 1 - pow.dexp;
+
+        // rest + error is below half of the last digit
+        if (tenKappa - rest > rest && tenKappa - 2 * rest >= 2 * error)
+            return true;
+
+        // rest - error is above half of the last digit
+        if (rest > error && tenKappa - (rest - error) <= rest - error) {
+            auto i{count};
+            while (i > 0 && '9' == digits[i - 1])
+                digits[--i] = '0';
+            if (i > 0) {
+                ++digits[i - 1];
+            }
+            else {
+                digits[0] = '1';
+                ++dexp;
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * Generate first digits of floating point number exactly, rounded half to even
+     *
+     * @param[in] val positive finite value
+     * @param[out] digits rounded digits
+     * @param[in] count number of digits
+     * @param[out] dexp decimal exponent of the first digit
+     */
+    template<class T>
+    void exactDigits(T val, char* digits, int count, int& dexp) noexcept {
+        using Limits = std::numeric_limits<T>;
+
+        // scaled value and divisor stay below 10 times the value or the divisor of the least denormal
+        static constexpr std::size_t WORDS{
+            static_cast<std::size_t>(
+                (Limits::max_exponent > 2 * Limits::digits - Limits::min_exponent ? 
+                    Limits::max_exponent : 2 * Limits::digits - Limits::min_exponent) + 64
+            ) / 32 + 1
+        };
+
+        // val = mant * 2^exp exactly
+        int exp;
+        auto mant{static_cast<uint64_t>(std::ldexp(std::frexp(val, &exp), Limits::digits))};
+        exp -= Limits::digits;
+
+        // val = 10^dexp * rem / div, 1 <= rem / div < 10
+        BigUInt<WORDS> rem{mant};
+        BigUInt<WORDS> div{1};
+        if (exp > 0)
+            rem.shl(static_cast<std::size_t>(exp));
+        else
+            div.shl(static_cast<std::size_t>(-exp));
+
+        dexp = static_cast<int>(std::floor(std::log10(static_cast<long double>(val))));
+        if (dexp > 0)
+            div.mulPow10(static_cast<std::size_t>(dexp));
+        else
+            rem.mulPow10(static_cast<std::size_t>(-dexp));
+
+        // logarithm may be off by one next to powers of 10
+        if (rem.compare(div) < 0) {
+            rem.mul(10);
+            --dexp;
+        }
+        else {
+            BigUInt<WORDS> next{div};
+            next.mul(10);
+            if (rem.compare(next) >= 0) {
+                div = next;
+                ++dexp;
+            }
+        }
+
+        for (auto i = 0; i < count; ++i) {
+            char digit{'0'};
+            while (rem.compare(div) >= 0) {
+                rem.sub(div);
+                ++digit;
+            }
+            digits[i] = digit;
+            rem.mul(10);
+        }
+
+        // remainder was multiplied by 10 already, half of the last digit is 5 times the divisor
+        div.mul(5);
+        auto cmp{rem.compare(div)};
+        if (cmp > 0 || (0 == cmp && ((digits[count - 1] - '0') & 1))) {
+            auto i{count};
+            while (i > 0 && '9' == digits[i - 1])
+                digits[--i] = '0';
+            if (i > 0) {
+                ++digits[i - 1];
+            }
+            else {
+                digits[0] = '1';
+                ++dexp;
+            }
+        }
+    }
+
+    /**
+     * Append floating point number, as std::ostream in "C" locale does with default precision
+     *
+     * @param[in,out] out output
+     * @param[in] val value to convert
+     *
+     * @warning Digits are taken from a 64 bit approximation when it rounds for sure, else they are generated 
+     * exactly and rounded half to even like "%g" of glibc, current locale isn't used
+     */
+    template<class A, class T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type appendDec(
+        BasicString<A>& out, 
+        T val
+    ) 
+    {
+        using Limits = std::numeric_limits<T>;
+
+        static constexpr int PRECISION{6};
+        static_assert(Limits::radix == 2 && Limits::digits <= 64, "binary floating point type is expected");
+
+        if (std::isnan(val)) {
+            out.append(std::signbit(val) ? "-nan" : "nan");
+            return;
+        }
+
+        char buf[32];
+        auto end{buf};
+        if (std::signbit(val)) {
+            *end++ = '-';
+            val = -val;
+        }
+
+        if (std::isinf(val)) {
+            out.append(buf, end).append("inf");
+            return;
+        }
+
+        if (0 == val) {
+            *end++ = '0';
+            out.append(buf, end);
+            return;
+        }
+
+        // val = mant * 2^exp exactly, the highest bit of mant is set
+        int exp;
+        auto mant{static_cast<uint64_t>(std::ldexp(std::frexp(val, &exp), 64))};
+        exp -= 64;
+
+        char digits[PRECISION];
+        int dexp;
+        if (!fastDigits(mant, exp, digits, PRECISION, dexp))
+            exactDigits(val, digits, PRECISION, dexp);
+
+        auto last{PRECISION};
+        while (last > 1 && '0' == digits[last - 1])
+            --last;
+
+        if (dexp < -4 || dexp >= PRECISION) {
+            *end++ = digits[0];
+            if (last > 1) {
+                *end++ = '.';
+                end = std::copy(digits + 1, digits + last, end);
+            }
+            *end++ = 'e';
+            *end++ = dexp < 0 ? '-' : '+';
+            auto uexp{static_cast<unsigned>(dexp < 0 ? -dexp : dexp)};
+            if (uexp < 10)
+                *end++ = '0';
+            char expBuf[8];
+            auto expEnd{expBuf + sizeof(expBuf)};
+            end = std::copy(writeDec(uexp, expEnd), expEnd, end);
+        }
+        else if (dexp >= 0) {
+            end = std::copy(digits, digits + dexp + 1, end);
+            if (last > dexp + 1) {
+                *end++ = '.';
+                end = std::copy(digits + dexp + 1, digits + last, end);
+            }
+        }
+        else {
+            *end++ = '0';
+            *end++ = '.';
+            for (auto i = -1; i > dexp; --i)
+                *end++ = '0';
+            end = std::copy(digits, digits + last, end);
+        }
+
+        out.append(buf, end);
+    }
+
+    /**
+     * Append value as text
+     *
+     * @param[in,out] out output
+     * @param[in] val value
+     */
+    template<class A, class T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type appendArg(
+        BasicString<A>& out, 
+        T val
+    ) 
+    { 
+        appendDec(out, val); 
+    }
+
+    template<class A>
+    void appendArg(BasicString<A>& out, bool val) { out += val ? '1' : '0'; }
+
+    template<class A>
+    void appendArg(BasicString<A>& out, char val) { out += val; }
+
+    template<class A>
+    void appendArg(BasicString<A>& out, signed char val) { out += static_cast<char>(val); }
+
+    template<class A>
+    void appendArg(BasicString<A>& out, unsigned char val) { out += static_cast<char>(val); }
+
+    template<class A>
+    void appendArg(BasicString<A>& out, const char* val) { 
+        if (val)
+            out.append(val); 
+    }
+
+    template<class A, class B>
+    void appendArg(BasicString<A>& out, const BasicString<B>& val) { out.append(val.data(), val.size()); }
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<std::size_t WORDS>
+class syslog::details::BigUInt final {
+private:
+    uint32_t    m_Words[WORDS]; ///< little endian words, m_Size of them are used
+    std::size_t m_Size; ///< used words, no leading zero ones
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] val initial value
+     */
+    explicit BigUInt(uint64_t val) noexcept : m_Size{0} {
+        for (; val; val >>= 32)
+            m_Words[m_Size++] = static_cast<uint32_t>(val);
+    }
+
+    /**
+     * Copy ctor
+     */
+    BigUInt(const BigUInt& other) noexcept : m_Size{other.m_Size} { 
+        std::memcpy(m_Words, other.m_Words, m_Size * sizeof(uint32_t)); 
+    }
+
+    /**
+     * Copy assignment operator
+     */
+    BigUInt& operator=(const BigUInt& other) noexcept {
+        m_Size = other.m_Size;
+        std::memmove(m_Words, other.m_Words, m_Size * sizeof(uint32_t));
+        return *this;
+    }
+
+    /**
+     * Multiply by 2^bits
+     *
+     * @param[in] bits shift
+     */
+    void shl(std::size_t bits) noexcept {
+        if (!m_Size)
+            return;
+
+        const auto words{bits / 32};
+        const auto rest{static_cast<uint32_t>(bits % 32)};
+        m_Words[m_Size + words] = rest ? m_Words[m_Size - 1] >> (32 - rest) : 0;
+        for (auto i = m_Size - 1; i > 0; --i)
+            m_Words[i + words] = (m_Words[i] << rest) | (rest ? m_Words[i - 1] >> (32 - rest) : 0);
+        m_Words[words] = m_Words[0] << rest;
+        std::fill(m_Words, m_Words + words, 0);
+
+        m_Size += words + 1;
+        trim();
+    }
+
+    /**
+     * Multiply by small factor
+     *
+     * @param[in] factor factor
+     */
+    void mul(uint32_t factor) noexcept {
+        uint64_t carry{0};
+        for (std::size_t i = 0; i < m_Size; ++i) {
+            carry += static_cast<uint64_t>(m_Words[i]) * factor;
+            m_Words[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry)
+            m_Words[m_Size++] = static_cast<uint32_t>(carry);
+    }
+
+    /**
+     * Multiply by 10^exp
+     *
+     * @param[in] exp power
+     */
+    void mulPow10(std::size_t exp) noexcept {
+        static const uint32_t pows[]{1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+        for (; exp >= 9; exp -= 9)
+            mul(1000000000);
+        mul(pows[exp]);
+    }
+
+    /**
+     * Compare
+     *
+     * @param[in] other other number
+     *
+     * @return Negative, zero or positive as this one is less, equal or greater
+     */
+    int compare(const BigUInt& other) const noexcept {
+        if (m_Size != other.m_Size)
+            return m_Size < other.m_Size ? -1 : 1;
+        for (auto i = m_Size; i > 0; --i) {
+            if (m_Words[i - 1] != other.m_Words[i - 1])
+                return m_Words[i - 1] < other.m_Words[i - 1] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    /**
+     * Subtract
+     *
+     * @param[in] other other number, not greater than this one
+     */
+    void sub(const BigUInt& other) noexcept {
+        uint64_t borrow{0};
+        for (std::size_t i = 0; i < m_Size; ++i) {
+            auto word{static_cast<uint64_t>(m_Words[i]) - borrow - (i < other.m_Size ? other.m_Words[i] : 0)};
+            m_Words[i] = static_cast<uint32_t>(word);
+            borrow = word >> 63;
+        }
+        trim();
+    }
+private:
+    /**
+     * Drop leading zero words
+     */
+    void trim() noexcept {
+        while (m_Size && !m_Words[m_Size - 1])
+            --m_Size;
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_CONV_HPP
@@ -0,0 +1,480 @@
+/**
+ * @file deferred.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_DEFERRED_HPP
+#define __CPP_SYSLOG_CLIENT_DEFERRED_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <type_traits>
+
+#include "level.hpp"
+#include "conv.hpp"
+#include "format.hpp"
+#include "local.hpp"
+#include "spsc_ring.hpp"
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Raw bytes of argument kept in ring until message is rendered
+     *
+     * @tparam T argument type, see syslog::details::DeferredArg
+     */
+    template<class T, class = void>
+    struct ArgCodec;
+
+    /**
+     * Numbers, bools and chars are copied as is
+     */
+    template<class T>
+    struct ArgCodec<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+        static std::size_t size(T) noexcept { return sizeof(T); }
+
+        static char* encode(char* out, T val) noexcept {
+            std::memcpy(out, &val, sizeof(val));
+            return out + sizeof(val);
+        }
+
+        static const char* append(PooledString& out, const char* in) {
+            T val;
+            std::memcpy(&val, in, sizeof(val));
+            appendArg(out, val);
+            return in + sizeof(val);
+        }
+    };
+
+    /**
+     * Strings are copied with their length ahead
+     */
+    template<class T>
+    struct ArgCodec<T, typename std::enable_if<std::is_same<T, const char*>::value || std::is_same<T, std::string>::value>::type> {
+        static std::size_t len(const char* val) noexcept { return val ? std::strlen(val) : 0; }
+
+        static std::size_t len(const std::string& val) noexcept { return val.size(); }
+
+        static const char* data(const char* val) noexcept { return val; }
+
+        static const char* data(const std::string& val) noexcept { return val.data(); }
+
+        static std::size_t size(const T& val) noexcept { return sizeof(uint32_t) + len(val); }
+
+        static char* encode(char* out, const T& val) noexcept {
+            auto size{static_cast<uint32_t>(len(val))};
+            std::memcpy(out, &size, sizeof(size));
+            if (size)
+                std::memcpy(out + sizeof(size), data(val), size);
+            return out + sizeof(size) + size;
+        }
+
+        static const char* append(PooledString& out, const char* in) {
+            uint32_t size;
+            std::memcpy(&size, in, sizeof(size));
+            out.append(in + sizeof(size), size);
+            return in + sizeof(size) + size;
+        }
+    };
+
+    /**
+     * Argument type as kept in ring, string literals and char pointers become const char*
+     */
+    template<class T>
+    using DeferredArg = typename std::conditional<
+        std::is_same<typename std::decay<T>::type, char*>::value,
+        const char*,
+        typename std::decay<T>::type
+    >::type;
+
+    /**
+     * Renders message from format string and raw arguments
+     *
+     * @tparam Fmt format string made by SYSLOG_FMT()
+     * @tparam Args argument types as kept in ring
+     */
+    template<class Fmt, class... Args>
+    struct DeferredFmt {
+        /**
+         * Append formatted text
+         *
+         * @param[in,out] out output
+         * @param[in] in raw arguments
+         */
+        static void render(PooledString& out, const char* in) {
+            constexpr auto info = parseFmt(Fmt::data());
+            constexpr auto parsed = splitFmt<(info.pieces > 0 ? info.pieces : 1)>(Fmt::data());
+
+            std::size_t idx{0};
+            int expand[] = {0, (appendLiterals(out, Fmt::data(), parsed, idx), in = ArgCodec<Args>::append(out, in), ++idx, 0)...};
+            (void)expand;
+            (void)in; // format string without arguments
+            appendLiterals(out, Fmt::data(), parsed, idx);
+        }
+    };
+
+    /**
+     * Per thread rings of raw messages rendered and sent by a background thread
+     */
+    class Deferred;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::Deferred final {
+public:
+    using Sink = std::function<void(LogLvlMng::LogLvl, const PooledString&)>; ///< sends rendered message
+    using Render = void (*)(PooledString&, const char*); ///< format descriptor, see syslog::details::DeferredFmt
+private:
+    using Rings = std::vector<std::shared_ptr<SpscRing>, PoolAllocator<std::shared_ptr<SpscRing>>>; ///< rings list
+    using RingPtrs = std::vector<SpscRing*, PoolAllocator<SpscRing*>>; ///< worker view of rings list
+private:
+    /**
+     * Raw message header
+     */
+    struct Hdr {
+        Render   render; ///< format descriptor
+        uint32_t lvl; ///< log severity level
+    };
+private:
+    static constexpr std::size_t DEFAULT_RING_SIZE{1 << 16}; ///< default
+    static constexpr std::size_t BATCH{256}; ///< max messages taken from one ring in a row
+    static constexpr int         IDLE_SLEEP_US{100}; ///< worker nap when rings are empty, microseconds
+    static constexpr std::size_t IDLE_PASSES{16}; ///< empty passes before worker parks
+    static constexpr std::size_t PRUNE_PASSES{1024}; ///< busy passes between checks for rings of exited threads
+private:
+    Sink                                   m_Sink; ///< message sender
+    std::size_t                            m_RingSize; ///< ring size of each thread
+    InstanceId                             m_Id; ///< instance ID, keys per thread rings
+    Rings                                  m_Rings; ///< rings of all threads
+    mutable std::mutex                     m_RingsMtx; ///< guards rings list
+    std::atomic<bool>                      m_RingsChanged; ///< worker should reload rings list
+    std::atomic<uint64_t>                  m_Dropped; ///< messages not fitting calling thread ring
+    std::atomic<bool>                      m_Stop; ///< worker should exit
+    std::atomic<bool>                      m_Parked; ///< worker waits for a message
+    std::mutex                             m_ParkMtx; ///< guards worker wake up
+    std::condition_variable                m_ParkCv; ///< wakes parked worker
+    std::thread                            m_Worker; ///< background thread
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] sink message sender, called by background thread only
+     * @param[in] ringSize ring size of each thread in bytes
+     */
+    explicit Deferred(
+        Sink sink,
+        std::size_t ringSize = DEFAULT_RING_SIZE
+    ) :
+        m_Sink{std::move(sink)},
+        m_RingSize{ringSize},
+        m_Id{},
+        m_RingsChanged{false},
+        m_Dropped{0},
+        m_Stop{false},
+        m_Parked{false},
+        m_Worker{&Deferred::run, this} {
+    }
+
+    /**
+     * Copy ctor
+     */
+    Deferred(const Deferred&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Deferred& operator=(const Deferred&) = delete;
+
+    /**
+     * Dtor
+     *
+     * @warning Pending messages are sent before the worker exits
+     */
+    ~Deferred() {
+        m_Stop.store(true, std::memory_order_release);
+        wake();
+        m_Worker.join();
+    }
+
+    /**
+     * Copy message format descriptor and raw arguments into calling thread ring
+     *
+     * @param[in] lvl log severity level
+     * @param[in] fmt format string made by SYSLOG_FMT()
+     * @param[in] args arguments
+     *
+     * @return false if the ring is full and message was dropped
+     *
+     * @warning Lock free, no formatting is done by calling thread
+     */
+    template<class Fmt, class... Args>
+    bool push(LogLvlMng::LogLvl lvl, Fmt, const Args&... args) {
+        static_assert(std::is_base_of<FmtString, Fmt>::value, "format string must be made by SYSLOG_FMT()");
+
+        constexpr auto info = parseFmt(Fmt::data());
+        static_assert(info.valid, "unmatched brace in format string");
+        static_assert(info.args == sizeof...(Args), "format string placeholders don't match arguments count");
+
+        std::size_t sizes[] = {sizeof(Hdr), ArgCodec<DeferredArg<Args>>::size(args)...};
+        std::size_t size{0};
+        for (auto s : sizes)
+            size += s;
+
+        auto& dst{ring()};
+        auto out{dst.reserve(size)};
+        if (!out) {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Hdr hdr{&DeferredFmt<Fmt, DeferredArg<Args>...>::render, static_cast<uint32_t>(lvl)};
+        std::memcpy(out, &hdr, sizeof(hdr));
+        out += sizeof(hdr);
+
+        int expand[] = {0, (out = ArgCodec<DeferredArg<Args>>::encode(out, args), 0)...};
+        (void)expand;
+
+        dst.commit();
+
+        // worker parks only when all rings are empty, so it's woken by the first message after that
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_Parked.load(std::memory_order_relaxed))
+            wake();
+
+        return true;
+    }
+
+    /**
+     * Wait until messages pushed so far are sent
+     */
+    void drain() {
+        Rings rings;
+        {
+            std::lock_guard<std::mutex> lock{m_RingsMtx};
+            rings = m_Rings;
+        }
+
+        for (const auto& ring : rings) {
+            while (ring->size())
+                nap();
+        }
+    }
+
+    /**
+     * Getter
+     *
+     * @return Number of messages dropped because of full rings
+     */
+    uint64_t getDropped() const noexcept { return m_Dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Getter
+     *
+     * @return Number of rings, rings of exited threads are freed by the worker once they are empty
+     */
+    std::size_t getRings() const {
+        std::lock_guard<std::mutex> lock{m_RingsMtx};
+        return m_Rings.size();
+    }
+private:
+    /**
+     * Get calling thread ring, register it on first use
+     *
+     * @warning Ring is shared with the worker, so it outlives calling thread until the worker has emptied it
+     */
+    SpscRing& ring() {
+        auto& local{threadLocal<std::shared_ptr<SpscRing>>(m_Id.get())};
+        if (!local) {
+            local = makePooled<SpscRing>(m_RingSize); // head and tail on their own cache lines
+
+            std::lock_guard<std::mutex> lock{m_RingsMtx};
+            m_Rings.push_back(local);
+            m_RingsChanged.store(true, std::memory_order_release);
+        }
+
+        return *local;
+    }
+
+    /**
+     * Worker loop
+     */
+    void run() noexcept {
+        RingPtrs rings;
+        PooledString out;
+        std::size_t idle{0};
+        std::size_t passes{0};
+
+        for (;;) {
+            // messages pushed before stop are visible once it's seen
+            auto stop{m_Stop.load(std::memory_order_acquire)};
+
+            if (m_RingsChanged.exchange(false, std::memory_order_acq_rel))
+                reload(rings);
+
+            std::size_t n{0};
+            for (auto ring : rings)
+                n += take(*ring, out, stop ? SIZE_MAX : BATCH);
+
+            if (stop)
+                return;
+
+            if (!n || 0 == ++passes % PRUNE_PASSES)
+                prune();
+
+            if (n)
+                idle = 0;
+            else if (++idle < IDLE_PASSES)
+                nap();
+            else
+                park(rings);
+        }
+    }
+
+    /**
+     * Copy rings list for the worker
+     *
+     * @param[out] rings worker view of rings list
+     */
+    void reload(RingPtrs& rings) {
+        std::lock_guard<std::mutex> lock{m_RingsMtx};
+        rings.clear();
+        for (const auto& ring : m_Rings)
+            rings.push_back(ring.get());
+    }
+
+    /**
+     * Free empty rings of exited threads
+     *
+     * @warning Worker only, it holds no references to rings, so the list is their last owner
+     */
+    void prune() {
+        std::lock_guard<std::mutex> lock{m_RingsMtx};
+        auto it{std::remove_if(m_Rings.begin(), m_Rings.end(), [](const std::shared_ptr<SpscRing>& ring) {
+            if (1 != ring.use_count())
+                return false;
+            // pairs with release of the reference by exited thread, its last records are visible
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return 0 == ring->size();
+        })};
+
+        if (it != m_Rings.end()) {
+            m_Rings.erase(it, m_Rings.end());
+            m_RingsChanged.store(true, std::memory_order_release);
+        }
+    }
+
+    /**
+     * Wait until a message is pushed or worker is stopped
+     *
+     * @param[in] rings worker view of rings list
+     */
+    void park(const RingPtrs& rings) {
+        m_Parked.store(true, std::memory_order_relaxed);
+        // pairs with fence of push(), either worker sees the message or producer sees worker parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto busy{m_Stop.load(std::memory_order_relaxed) || m_RingsChanged.load(std::memory_order_relaxed)};
+        for (auto ring : rings)
+            busy = busy || ring->size();
+
+        std::unique_lock<std::mutex> lock{m_ParkMtx};
+        if (!busy) {
+            m_ParkCv.wait(lock, [this]() { 
+                return !m_Parked.load(std::memory_order_relaxed) || m_Stop.load(std::memory_order_relaxed); 
+            });
+        }
+        m_Parked.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wake parked worker
+     */
+    void wake() {
+        m_Parked.store(false, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock{m_ParkMtx};
+        m_ParkCv.notify_one();
+    }
+
+    /**
+     * Sleep while rings are empty
+     */
+    static void nap() {
+        std::chrono::microseconds::rep us{IDLE_SLEEP_US};
+        std::this_thread::sleep_for(std::chrono::microseconds{us});
+    }
+
+    /**
+     * Render and send messages from ring
+     *
+     * @param[in] ring ring
+     * @param[in,out] out render buffer
+     * @param[in] max max number of messages
+     *
+     * @return Number of messages taken
+     */
+    std::size_t take(SpscRing& ring, PooledString& out, std::size_t max) noexcept {
+        std::size_t n{0};
+        std::size_t size{0};
+
+        for (const char* rec; n < max && (rec = ring.front(size)); ++n) {
+            Hdr hdr;
+            std::memcpy(&hdr, rec, sizeof(hdr));
+
+            try {
+                out.clear();
+                hdr.render(out, rec + sizeof(hdr));
+                m_Sink(static_cast<LogLvlMng::LogLvl>(hdr.lvl), out);
+            }
+            catch (...) {
+                // message is lost, keep the worker alive
+            }
+
+            ring.release(size);
+        }
+
+        return n;
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_DEFERRED_HPP
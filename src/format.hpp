@@ -0,0 +1,240 @@
+/**
+ * @file format.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_FORMAT_HPP
+#define __CPP_SYSLOG_CLIENT_FORMAT_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "conv.hpp"
+
+/**
+ * Make format string checked and parsed at compile time
+ * 
+ * @param[in] s string literal, "{}" is an argument placeholder, "{{" and "}}" are escaped braces
+ */
+#define SYSLOG_FMT(s) \
+    [] { \
+        struct str : syslog::details::FmtString { \
+            static constexpr const char* data() { return s; } \
+        }; \
+        return str{}; \
+    }()
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Base of format string types made by SYSLOG_FMT()
+     */
+    struct FmtString { };
+
+    /**
+     * Part of parsed format string
+     */
+    struct FmtPiece {
+        std::size_t offset; ///< literal text offset in format string
+        std::size_t size; ///< literal text size
+        bool        arg; ///< argument placeholder, not a literal text
+    };
+
+    /**
+     * Parsed format string
+     *
+     * @tparam N number of pieces
+     */
+    template<std::size_t N>
+    struct FmtPieces {
+        FmtPiece pieces[N]; ///< literal texts and argument placeholders in order
+    };
+
+    /**
+     * Format string summary
+     */
+    struct FmtInfo {
+        bool        valid; ///< well formed
+        std::size_t args; ///< number of argument placeholders
+        std::size_t pieces; ///< number of literal texts and argument placeholders
+        std::size_t literal; ///< total size of literal texts
+    };
+
+    /**
+     * Check format string and count its pieces
+     *
+     * @param[in] fmt format string
+     */
+    constexpr FmtInfo parseFmt(const char* fmt) {
+        FmtInfo info{true, 0, 0, 0};
+        std::size_t begin{0};
+        std::size_t i{0};
+
+        for (; fmt[i]; ++i) {
+            if ('{' != fmt[i] && '}' != fmt[i])
+                continue;
+
+            if ('{' == fmt[i] && '}' == fmt[i + 1]) {
+                if (i > begin)
+                    ++info.pieces;
+                info.literal += i - begin;
+                ++info.pieces;
+                ++info.args;
+                begin = ++i + 1;
+            }
+            else if (fmt[i] == fmt[i + 1]) {
+                // escaped brace, keep the first one in literal text
+                ++info.pieces;
+                info.literal += i + 1 - begin;
+                begin = ++i + 1;
+            }
+            else {
+                info.valid = false;
+                return info;
+            }
+        }
+
+        if (i > begin)
+            ++info.pieces;
+        info.literal += i - begin;
+
+        return info;
+    }
+
+    /**
+     * Split format string into pieces
+     *
+     * @tparam N number of pieces, see syslog::details::parseFmt()
+     *
+     * @param[in] fmt well formed format string
+     */
+    template<std::size_t N>
+    constexpr FmtPieces<N> splitFmt(const char* fmt) {
+        FmtPieces<N> res{};
+        std::size_t n{0};
+        std::size_t begin{0};
+        std::size_t i{0};
+
+        for (; fmt[i] && n < N; ++i) {
+            if ('{' != fmt[i] && '}' != fmt[i])
+                continue;
+
+            if ('{' == fmt[i] && '}' == fmt[i + 1]) {
+                if (i > begin)
+                    res.pieces[n++] = FmtPiece{begin, i - begin, false};
+                res.pieces[n++] = FmtPiece{0, 0, true};
+            }
+            else {
+                res.pieces[n++] = FmtPiece{begin, i + 1 - begin, false};
+            }
+            begin = ++i + 1;
+        }
+
+        if (i > begin && n < N)
+            res.pieces[n++] = FmtPiece{begin, i - begin, false};
+
+        return res;
+    }
+
+    /**
+     * Append literal texts up to the next argument placeholder
+     *
+     * @param[in,out] out output
+     * @param[in] fmt format string
+     * @param[in] parsed parsed format string
+     * @param[in,out] idx current piece
+     */
+    template<class A, std::size_t N>
+    void appendLiterals(
+        BasicString<A>& out,
+        const char* fmt,
+        const FmtPieces<N>& parsed,
+        std::size_t& idx
+    )
+    {
+        for (; idx < N && !parsed.pieces[idx].arg; ++idx)
+            out.append(fmt + parsed.pieces[idx].offset, parsed.pieces[idx].size);
+    }
+
+    template<class A, std::size_t N>
+    void formatPieces(
+        BasicString<A>& out,
+        const char* fmt,
+        const FmtPieces<N>& parsed,
+        std::size_t idx
+    )
+    {
+        appendLiterals(out, fmt, parsed, idx);
+    }
+
+    template<class A, std::size_t N, class T, class... Args>
+    void formatPieces(
+        BasicString<A>& out,
+        const char* fmt,
+        const FmtPieces<N>& parsed,
+        std::size_t idx,
+        const T& arg,
+        const Args&... args
+    )
+    {
+        appendLiterals(out, fmt, parsed, idx);
+        appendArg(out, arg);
+        formatPieces(out, fmt, parsed, idx + 1, args...);
+    }
+
+    /**
+     * Append formatted text
+     *
+     * @param[in,out] out output
+     * @param[in] fmt format string made by SYSLOG_FMT()
+     * @param[in] args arguments
+     *
+     * @warning Format string is checked against arguments count at compile time
+     */
+    template<class A, class Fmt, class... Args>
+    void formatTo(
+        BasicString<A>& out,
+        Fmt,
+        const Args&... args
+    )
+    {
+        static_assert(std::is_base_of<FmtString, Fmt>::value, "format string must be made by SYSLOG_FMT()");
+
+        constexpr auto info = parseFmt(Fmt::data());
+        static_assert(info.valid, "unmatched brace in format string");
+        static_assert(info.args == sizeof...(Args), "format string placeholders don't match arguments count");
+
+        constexpr auto parsed = splitFmt<(info.pieces > 0 ? info.pieces : 1)>(Fmt::data());
+        formatPieces(out, Fmt::data(), parsed, 0, args...);
+    }
+};};
+
+#endif // __CPP_SYSLOG_CLIENT_FORMAT_HPP
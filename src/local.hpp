@@ -0,0 +1,240 @@
+/**
+ * @file local.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_LOCAL_HPP
+#define __CPP_SYSLOG_CLIENT_LOCAL_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Get new instance ID, never reused in process lifetime
+     */
+    inline uint64_t nextInstanceId() noexcept {
+        static std::atomic<uint64_t> id{1};
+        return id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Set of instance IDs whose per thread objects are alive
+     */
+    class InstanceRegistry;
+
+    /**
+     * Instance ID registered while its owner lives, keys per thread objects of owner
+     */
+    class InstanceId;
+
+    /**
+     * Get calling thread own object bound to instance
+     *
+     * @tparam T object type
+     * @tparam Tag distinguishes storages of the same object type
+     *
+     * @param[in] owner instance ID, see syslog::details::InstanceId
+     *
+     * @warning Object lives until calling thread exit or until the thread looks up an object of another instance 
+     * after owner was destroyed, whichever comes first
+     */
+    template<class T, class Tag = T>
+    T& threadLocal(uint64_t owner);
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::InstanceRegistry final {
+private:
+    std::mutex                   m_Mtx; ///< guards live IDs
+    std::unordered_set<uint64_t> m_Live; ///< IDs of living owners
+    std::atomic<uint64_t>        m_Retired; ///< number of IDs retired so far, tells threads to prune
+public:
+    /**
+     * Get registry
+     *
+     * @warning Never destroyed, thread local objects may be pruned during process exit
+     */
+    static InstanceRegistry& instance() {
+        static auto registry{new InstanceRegistry};
+        return *registry;
+    }
+
+    /**
+     * Get new registered ID
+     */
+    uint64_t add() {
+        auto id{nextInstanceId()};
+        std::lock_guard<std::mutex> lock{m_Mtx};
+        m_Live.insert(id);
+        return id;
+    }
+
+    /**
+     * Unregister ID, per thread objects bound to it are pruned by their threads later
+     */
+    void retire(uint64_t id) noexcept {
+        {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            m_Live.erase(id);
+        }
+        m_Retired.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * Getter
+     */
+    uint64_t getRetired() const noexcept { return m_Retired.load(std::memory_order_acquire); }
+
+    /**
+     * Erase objects of retired IDs
+     *
+     * @param[in,out] objs per thread objects by instance ID
+     */
+    template<class Objs>
+    void prune(Objs& objs) {
+        std::lock_guard<std::mutex> lock{m_Mtx};
+        for (auto it = objs.begin(); it != objs.end();) {
+            if (m_Live.count(it->first))
+                ++it;
+            else
+                it = objs.erase(it);
+        }
+    }
+private:
+    InstanceRegistry() : m_Retired{0} {}
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::InstanceId final {
+private:
+    uint64_t m_Id; ///< registered ID, 0 if moved out
+public:
+    /**
+     * Ctor
+     */
+    InstanceId() : m_Id{InstanceRegistry::instance().add()} {}
+
+    /**
+     * Copy ctor
+     */
+    InstanceId(const InstanceId&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    InstanceId& operator=(const InstanceId&) = delete;
+
+    /**
+     * Move ctor
+     *
+     * @param[in] other moving instance ID, per thread objects go with it
+     */
+    InstanceId(InstanceId&& other) noexcept : m_Id{other.m_Id} { other.m_Id = 0; }
+
+    /**
+     * Move assignment operator
+     *
+     * @param[in] other moving instance ID, per thread objects of the current one are retired
+     */
+    InstanceId& operator=(InstanceId&& other) noexcept {
+        if (&other == this)
+            return *this;
+
+        retire();
+        m_Id = other.m_Id;
+        other.m_Id = 0;
+        return *this;
+    }
+
+    /**
+     * Dtor
+     */
+    ~InstanceId() { retire(); }
+
+    /**
+     * Getter
+     */
+    uint64_t get() const noexcept { return m_Id; }
+private:
+    void retire() noexcept {
+        if (m_Id)
+            InstanceRegistry::instance().retire(m_Id);
+        m_Id = 0;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class T, class Tag>
+T& syslog::details::threadLocal(uint64_t owner) {
+    using Objs = std::unordered_map<
+        uint64_t, 
+        T, 
+        std::hash<uint64_t>, 
+        std::equal_to<uint64_t>, 
+        PoolAllocator<std::pair<const uint64_t, T>>
+    >;
+
+    thread_local Objs objs;
+    thread_local uint64_t lastOwner{0};
+    thread_local T* last{nullptr};
+    thread_local uint64_t retired{0};
+
+    if (lastOwner != owner || !last) {
+        // objects of destroyed owners go when the thread turns to another owner, so the fast path stays a compare
+        auto& registry{InstanceRegistry::instance()};
+        auto now{registry.getRetired()};
+        if (now != retired) {
+            registry.prune(objs);
+            retired = now;
+        }
+
+        last = &objs[owner];
+        lastOwner = owner;
+    }
+
+    return *last;
+}
+
+#endif // __CPP_SYSLOG_CLIENT_LOCAL_HPP
@@ -0,0 +1,78 @@
+/**
+ * @file lock_prof.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_LOCK_PROF_HPP
+#define __CPP_SYSLOG_CLIENT_LOCK_PROF_HPP
+
+#include <cstddef>
+#include <array>
+
+#include "metrics.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage lock acquisition sites
+     */
+    class LockSiteMng;
+
+    /**
+     * Snapshot of lock wait and hold times per acquisition site
+     */
+    struct LockProfile;
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::LockSiteMng final {
+public:
+    /**
+     * Code holding or waiting for a thread policy lock
+     */
+    enum LockSite {
+        LS_CONFIG = 0, ///< socket and size setters, under plain mutex
+        LS_ASSEMBLY, ///< message composing by stream insertions, under recursive mutex
+        LS_HEADER, ///< PRI header build
+        LS_FORMATTERS, ///< structured data element with formatter flags and message parameters
+        LS_SEND ///< data sender call
+    };
+
+    static constexpr std::size_t COUNT{5}; ///< number of sites
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::LockProfile {
+    std::array<LatencyHist, LockSiteMng::COUNT> wait; ///< wait for the lock, per site taking it
+    std::array<LatencyHist, LockSiteMng::COUNT> hold; ///< time spent with the lock held, per site
+};
+
+#endif // __CPP_SYSLOG_CLIENT_LOCK_PROF_HPP
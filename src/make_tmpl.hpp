@@ -44,7 +44,7 @@ namespace details {
      * @param[in] key formatter key
      * @param[in] value formatter value
      */
-    std::string makeTmpl(
+    inline std::string makeTmpl(
         const std::string& key, 
         const std::string& value
     ) noexcept 
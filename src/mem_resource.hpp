@@ -0,0 +1,278 @@
+/**
+ * @file mem_resource.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_MEM_RESOURCE_HPP
+#define __CPP_SYSLOG_CLIENT_MEM_RESOURCE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <new>
+#include <thread>
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Interface for providing log memory
+     */
+    class IMemResource;
+
+    /**
+     * Memory resource carving a fixed region, never touches the heap
+     *
+     * @tparam Capacity region size in bytes
+     */
+    template<std::size_t Capacity>
+    class StaticMemResource;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Memory resource using global operator new/delete
+     */
+    class NewDeleteResource;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::IMemResource {
+public:
+    /**
+     * Dtor
+     */
+    virtual ~IMemResource() = default;
+
+    /**
+     * Get memory aligned for any scalar type
+     *
+     * @param[in] size size in bytes
+     *
+     * @warning Throws std::bad_alloc if there is no memory, must be thread-safe
+     */
+    virtual void* allocate(std::size_t size) = 0;
+
+    /**
+     * Give memory back
+     *
+     * @param[in] ptr memory got by allocate()
+     * @param[in] size size passed to allocate()
+     *
+     * @warning Must be thread-safe
+     */
+    virtual void deallocate(void* ptr, std::size_t size) noexcept = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::NewDeleteResource final : public syslog::IMemResource {
+public:
+    void* allocate(std::size_t size) override { return ::operator new(size); }
+
+    void deallocate(void* ptr, std::size_t) noexcept override { ::operator delete(ptr); }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<std::size_t Capacity>
+class syslog::StaticMemResource final : public syslog::IMemResource {
+private:
+    static constexpr std::size_t ALIGN{alignof(std::max_align_t)}; ///< every block alignment
+    static constexpr std::size_t CLASSES{48}; ///< power of two size classes
+private:
+    alignas(std::max_align_t) char m_Region[Capacity]; ///< memory
+    std::size_t                    m_Used; ///< carved bytes
+    void*                          m_Free[CLASSES]; ///< released blocks of each size class, linked through their first bytes
+    std::atomic_flag               m_Lock = ATOMIC_FLAG_INIT; ///< guards carving and free lists, no system calls
+public:
+    /**
+     * Ctor
+     */
+    StaticMemResource() noexcept : m_Used{0}, m_Free{} { }
+
+    /**
+     * Copy ctor
+     */
+    StaticMemResource(const StaticMemResource&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    StaticMemResource& operator=(const StaticMemResource&) = delete;
+
+    /**
+     * Get memory from free lists or carve it from the region
+     *
+     * @param[in] size size in bytes
+     *
+     * @warning Throws std::bad_alloc if the region is exhausted
+     */
+    void* allocate(std::size_t size) override {
+        auto cls{classOf(size)};
+        void* ptr{nullptr};
+
+        lock();
+
+        if (m_Free[cls]) {
+            ptr = m_Free[cls];
+            m_Free[cls] = *static_cast<void**>(ptr);
+        }
+        else if (Capacity - m_Used >= blockSize(cls)) {
+            ptr = m_Region + m_Used;
+            m_Used += blockSize(cls);
+        }
+
+        unlock();
+
+        if (!ptr)
+            throw std::bad_alloc{};
+
+        return ptr;
+    }
+
+    /**
+     * Put memory into free list of its size class
+     *
+     * @param[in] ptr memory got by allocate()
+     * @param[in] size size passed to allocate()
+     */
+    void deallocate(void* ptr, std::size_t size) noexcept override {
+        auto cls{classOf(size)};
+
+        lock();
+
+        *static_cast<void**>(ptr) = m_Free[cls];
+        m_Free[cls] = ptr;
+
+        unlock();
+    }
+
+    /**
+     * Getter
+     *
+     * @return Number of bytes carved from the region
+     */
+    std::size_t getUsed() noexcept {
+        lock();
+        auto used{m_Used};
+        unlock();
+
+        return used;
+    }
+private:
+    /**
+     * Take spinlock, yielding to the holder while it's busy
+     */
+    void lock() noexcept {
+        while (m_Lock.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+
+    void unlock() noexcept { m_Lock.clear(std::memory_order_release); }
+
+    static std::size_t blockSize(std::size_t cls) noexcept { return ALIGN << cls; }
+
+    static std::size_t classOf(std::size_t size) noexcept {
+        std::size_t cls{0};
+        while (cls + 1 < CLASSES && blockSize(cls) < size)
+            ++cls;
+        return cls;
+    }
+};
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    static constexpr std::uintptr_t MEM_RESOURCE_PINNED{1}; ///< slot flag, the pool keeps blocks of the resource
+
+    /**
+     * Get process wide memory resource slot
+     *
+     * @warning Resource address with syslog::details::MEM_RESOURCE_PINNED flag in the low bit, 0 for operator new/delete
+     */
+    inline std::atomic<std::uintptr_t>& memResource() noexcept {
+        static std::atomic<std::uintptr_t> res{0};
+        return res;
+    }
+
+    /**
+     * Get resource from slot
+     */
+    inline IMemResource& toMemResource(std::uintptr_t slot) noexcept {
+        static auto newDelete{new NewDeleteResource}; // never destroyed, like the pool
+        auto res{reinterpret_cast<IMemResource*>(slot & ~MEM_RESOURCE_PINNED)};
+        return res ? *res : *newDelete;
+    }
+
+    /**
+     * Get memory resource the pool keeps blocks of, so it can't be switched any more
+     */
+    inline IMemResource& pinMemResource() noexcept {
+        return toMemResource(memResource().fetch_or(MEM_RESOURCE_PINNED, std::memory_order_acq_rel));
+    }
+};
+
+    /**
+     * Set memory resource used by the library for message buffers, queues and rings
+     *
+     * @param[in] res memory resource, nullptr restores operator new/delete
+     *
+     * @return false if the pool already keeps blocks taken from the current resource, it stays in use then
+     *
+     * @warning Resource must live for the whole process: pooled blocks are reused by new messages and never go back,
+     * so set it before the first client is created, a scoped arena can't be plugged in and dropped later
+     */
+    inline bool setMemResource(IMemResource* res) noexcept {
+        auto slot{details::memResource().load(std::memory_order_acquire)};
+        for (;;) {
+            if (slot & details::MEM_RESOURCE_PINNED)
+                return false;
+            if (details::memResource().compare_exchange_weak(slot, reinterpret_cast<std::uintptr_t>(res), std::memory_order_acq_rel))
+                return true;
+        }
+    }
+
+    /**
+     * Get memory resource used by the library
+     */
+    inline IMemResource& getMemResource() noexcept {
+        return details::toMemResource(details::memResource().load(std::memory_order_acquire));
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_MEM_RESOURCE_HPP
@@ -0,0 +1,605 @@
+/**
+ * @file metrics.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_METRICS_HPP
+#define __CPP_SYSLOG_CLIENT_METRICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+#include "level.hpp"
+#include "send_stats.hpp"
+#include "local.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage metrics layout
+     */
+    class MetricsMng;
+
+    /**
+     * Snapshot of a latency histogram
+     */
+    struct LatencyHist;
+
+    /**
+     * Snapshot of client metrics
+     */
+    struct Metrics;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Get monotonic clock in ns
+     */
+    inline uint64_t nowNs() noexcept {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count()
+        );
+    }
+
+    /**
+     * Counter written by a single thread at a time and read by any
+     */
+    class ShardCounter;
+
+    /**
+     * Latency histogram written by a single thread and read by any
+     */
+    class ShardHist;
+
+    /**
+     * Per-thread shards of counters, so writers never share cache lines
+     *
+     * @tparam Shard counters of one thread
+     */
+    template<class Shard>
+    class Shards;
+
+    /**
+     * Counters of one thread for messages built by the stream buffer
+     */
+    struct MsgShard;
+
+    /**
+     * Message counters and stage latencies of the stream buffer
+     */
+    class MsgCounters;
+
+    /**
+     * Counters of one thread for data sender
+     */
+    struct SendShard;
+
+    /**
+     * Data sender counters shared between caller and background threads
+     */
+    class SendCounters;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::MetricsMng final {
+public:
+    static constexpr std::size_t LATENCY_BUCKETS{32}; ///< bucket i holds latencies below 2^i ns, the last one holds the rest
+    static constexpr std::size_t ERRNO_SLOTS{128}; ///< errno values tracked one by one, the last slot holds the rest
+    static constexpr int         OTHER_ERRNO{-1}; ///< key of send errors with errno out of tracked range
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::LatencyHist {
+    uint64_t                                          count; ///< number of samples
+    uint64_t                                          sumNs; ///< sum of samples in ns
+    std::array<uint64_t, MetricsMng::LATENCY_BUCKETS> buckets; ///< power of two buckets
+
+    /**
+     * Get upper bound of the bucket holding q-quantile
+     *
+     * @param[in] q quantile, 0..1
+     *
+     * @return Latency in ns, 0 if there are no samples
+     */
+    uint64_t percentile(double q) const noexcept {
+        if (!count)
+            return 0;
+
+        auto rank{static_cast<uint64_t>(q * static_cast<double>(count))};
+        if (rank >= count)
+            rank = count - 1;
+
+        uint64_t seen{0};
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen > rank)
+                return uint64_t{1} << i;
+        }
+
+        return uint64_t{1} << (buckets.size() - 1);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::Metrics {
+    std::array<uint64_t, 8>               messages; ///< messages sent by stream, log() and defer(), per severity level
+    uint64_t                              bytes; ///< bytes accepted by the kernel
+    SendStats                             send; ///< data sender counters
+    std::vector<std::pair<int, uint64_t>> errors; ///< failed sends per errno, only nonzero ones
+    uint64_t                              queueDepth; ///< datagrams waiting for background retry
+    uint64_t                              queueHighWater; ///< max datagrams ever waiting for background retry
+    uint64_t                              deferredDropped; ///< deferred messages lost because a thread ring was full
+    LatencyHist                           format; ///< message header and format string rendering, if enabled
+    LatencyHist                           lockWait; ///< wait for the message lock by the first insertion, if enabled
+    LatencyHist                           sending; ///< data sender call, if enabled
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::ShardCounter final {
+private:
+    std::atomic<uint64_t> m_Val; ///< value
+public:
+    /**
+     * Ctor
+     */
+    ShardCounter() : m_Val{0} {}
+
+    /**
+     * Increase value
+     *
+     * @param[in] n increment
+     *
+     * @warning One writer at a time, it's a plain load and store, no locked instruction
+     */
+    void add(uint64_t n = 1) noexcept { m_Val.store(m_Val.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+
+    /**
+     * Getter
+     */
+    uint64_t get() const noexcept { return m_Val.load(std::memory_order_relaxed); }
+
+    /**
+     * Add value of another counter
+     *
+     * @param[in] other counter
+     *
+     * @warning One writer at a time
+     */
+    void merge(const ShardCounter& other) noexcept { add(other.get()); }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::ShardHist final {
+private:
+    ShardCounter                                          m_Count; ///< number of samples
+    ShardCounter                                          m_Sum; ///< sum of samples in ns
+    std::array<ShardCounter, MetricsMng::LATENCY_BUCKETS> m_Buckets; ///< power of two buckets
+public:
+    /**
+     * Add sample
+     *
+     * @param[in] ns latency
+     *
+     * @warning One writer at a time
+     */
+    void record(uint64_t ns) noexcept {
+        m_Count.add();
+        m_Sum.add(ns);
+        m_Buckets[bucketOf(ns)].add();
+    }
+
+    /**
+     * Add samples of another histogram
+     *
+     * @param[in] other histogram
+     *
+     * @warning One writer at a time
+     */
+    void merge(const ShardHist& other) noexcept {
+        m_Count.merge(other.m_Count);
+        m_Sum.merge(other.m_Sum);
+        for (std::size_t i = 0; i < m_Buckets.size(); ++i)
+            m_Buckets[i].merge(other.m_Buckets[i]);
+    }
+
+    /**
+     * Add samples to snapshot
+     *
+     * @param[in,out] hist snapshot
+     */
+    void addTo(LatencyHist& hist) const noexcept {
+        hist.count += m_Count.get();
+        hist.sumNs += m_Sum.get();
+        for (std::size_t i = 0; i < m_Buckets.size(); ++i)
+            hist.buckets[i] += m_Buckets[i].get();
+    }
+
+    /**
+     * Get bucket of latency
+     *
+     * @param[in] ns latency
+     */
+    static std::size_t bucketOf(uint64_t ns) noexcept {
+        std::size_t idx{0};
+        while (ns && idx < MetricsMng::LATENCY_BUCKETS - 1) {
+            ns >>= 1;
+            ++idx;
+        }
+
+        return idx;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class Shard>
+class syslog::details::Shards final {
+private:
+    InstanceId                                  m_Id; ///< instance ID, keys per thread shards
+    mutable std::vector<std::shared_ptr<Shard>> m_All; ///< shards of live threads, pruned by forEach()
+    mutable std::shared_ptr<Shard>              m_Retired; ///< counters of exited threads
+    mutable std::mutex                          m_Mtx; ///< guards shards list and retired counters
+public:
+    /**
+     * Ctor
+     */
+    Shards() : m_Id{}, m_Retired{makePooled<Shard>()} {}
+
+    /**
+     * Copy ctor
+     */
+    Shards(const Shards&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Shards& operator=(const Shards&) = delete;
+
+    /**
+     * Get calling thread shard, create it on first call
+     *
+     * @warning Lock free except for the first call of each thread
+     */
+    Shard& local() {
+        auto& shard{threadLocal<std::shared_ptr<Shard>, Shards>(m_Id.get())};
+        if (!shard) {
+            shard = makePooled<Shard>(); // its own cache lines
+
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            m_All.push_back(shard);
+        }
+
+        return *shard;
+    }
+
+    /**
+     * Visit shards of all threads
+     *
+     * @param[in] fn visitor, void(const Shard&)
+     *
+     * @warning Writers are not stopped, so the visited values are not consistent as a whole
+     * @warning Shards of exited threads are folded into one, so the cost follows live threads
+     */
+    template<class Fn>
+    void forEach(Fn fn) const {
+        std::lock_guard<std::mutex> lock{m_Mtx};
+        prune();
+
+        fn(*m_Retired);
+        for (const auto& shard : m_All)
+            fn(*shard);
+    }
+
+    /**
+     * Getter
+     *
+     * @return Number of shards kept for threads, shards of exited threads are counted until next forEach()
+     */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock{m_Mtx};
+        return m_All.size();
+    }
+private:
+    /**
+     * Fold shards of exited threads into retired counters
+     *
+     * @warning Lock zone
+     */
+    void prune() const noexcept {
+        auto it{std::remove_if(m_All.begin(), m_All.end(), [this](const std::shared_ptr<Shard>& shard) {
+            // thread storage is the other owner
+            if (1 != shard.use_count())
+                return false;
+            // pairs with release of the reference by exited thread, its last counts are visible
+            std::atomic_thread_fence(std::memory_order_acquire);
+            m_Retired->merge(*shard);
+            return true;
+        })};
+        m_All.erase(it, m_All.end());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::MsgShard {
+    static constexpr std::size_t CACHE_LINE{64}; ///< keeps shards of different threads apart
+
+    alignas(CACHE_LINE) std::array<ShardCounter, 8> messages; ///< per severity level
+    ShardHist                                       format; ///< header and body rendering
+    ShardHist                                       lockWait; ///< wait for the message lock
+    ShardHist                                       sending; ///< data sender call
+
+    /**
+     * Add counters of another shard
+     *
+     * @param[in] other shard
+     */
+    void merge(const MsgShard& other) noexcept {
+        for (std::size_t i = 0; i < messages.size(); ++i)
+            messages[i].merge(other.messages[i]);
+        format.merge(other.format);
+        lockWait.merge(other.lockWait);
+        sending.merge(other.sending);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::MsgCounters final {
+private:
+    Shards<MsgShard>  m_Shards; ///< per thread counters
+    std::atomic<bool> m_Timing; ///< latencies are measured
+public:
+    /**
+     * Ctor
+     */
+    MsgCounters() : m_Timing{false} {}
+
+    /**
+     * Setter
+     *
+     * @param[in] on measure stage latencies
+     *
+     * @warning By default, latencies are not measured, as it costs two clock reads per stage
+     */
+    void setTiming(bool on) noexcept { m_Timing.store(on, std::memory_order_relaxed); }
+
+    /**
+     * Getter
+     */
+    bool isTiming() const noexcept { return m_Timing.load(std::memory_order_relaxed); }
+
+    /**
+     * Get timestamp for latency measurement
+     *
+     * @return 0 if latencies are not measured
+     */
+    uint64_t now() const noexcept { return isTiming() ? nowNs() : 0; }
+
+    /**
+     * Get calling thread shard
+     */
+    MsgShard& local() { return m_Shards.local(); }
+
+    /**
+     * Add counters to snapshot
+     *
+     * @param[in,out] metrics snapshot
+     */
+    void collect(Metrics& metrics) const {
+        m_Shards.forEach([&](const MsgShard& shard) {
+            for (std::size_t i = 0; i < shard.messages.size(); ++i)
+                metrics.messages[i] += shard.messages[i].get();
+
+            shard.format.addTo(metrics.format);
+            shard.lockWait.addTo(metrics.lockWait);
+            shard.sending.addTo(metrics.sending);
+        });
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::SendShard {
+    static constexpr std::size_t CACHE_LINE{64}; ///< keeps shards of different threads apart
+
+    alignas(CACHE_LINE) ShardCounter                  sent; ///< datagrams accepted by the kernel
+    ShardCounter                                      bytes; ///< bytes accepted by the kernel
+    ShardCounter                                      again; ///< sends refused with EAGAIN/EWOULDBLOCK/ENOBUFS
+    ShardCounter                                      retried; ///< refused datagrams delivered by the background retry
+    ShardCounter                                      dropped; ///< datagrams lost because the kernel queue was full
+    ShardCounter                                      errors; ///< sends failed by any other reason
+    std::array<ShardCounter, MetricsMng::ERRNO_SLOTS> byErrno; ///< failed sends per errno
+
+    /**
+     * Add counters of another shard
+     *
+     * @param[in] other shard
+     */
+    void merge(const SendShard& other) noexcept {
+        sent.merge(other.sent);
+        bytes.merge(other.bytes);
+        again.merge(other.again);
+        retried.merge(other.retried);
+        dropped.merge(other.dropped);
+        errors.merge(other.errors);
+        for (std::size_t i = 0; i < byErrno.size(); ++i)
+            byErrno[i].merge(other.byErrno[i]);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::SendCounters final {
+private:
+    Shards<SendShard>     m_Shards; ///< per thread counters
+    std::atomic<uint64_t> m_QueueDepth; ///< datagrams waiting for background retry
+    std::atomic<uint64_t> m_QueueHighWater; ///< max datagrams ever waiting for background retry
+public:
+    /**
+     * Ctor
+     */
+    SendCounters() : m_QueueDepth{0}, m_QueueHighWater{0} {}
+
+    /**
+     * Account datagram accepted by the kernel
+     *
+     * @param[in] size datagram size
+     */
+    void incSent(std::size_t size) noexcept { 
+        auto& shard{local()};
+        shard.sent.add();
+        shard.bytes.add(size);
+    }
+
+    void incAgain() noexcept { local().again.add(); }
+
+    /**
+     * Account refused datagram delivered by the background retry
+     *
+     * @param[in] size datagram size
+     */
+    void incRetried(std::size_t size) noexcept { 
+        auto& shard{local()};
+        shard.retried.add();
+        shard.bytes.add(size);
+    }
+
+    void incDropped() noexcept { local().dropped.add(); }
+
+    /**
+     * Account failed send
+     *
+     * @param[in] err errno, or WSAGetLastError() on Windows
+     */
+    void incErrors(int err) noexcept { 
+        auto& shard{local()};
+        shard.errors.add();
+        shard.byErrno[err >= 0 && err < static_cast<int>(MetricsMng::ERRNO_SLOTS) - 1 ? err : MetricsMng::ERRNO_SLOTS - 1].add();
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] depth datagrams waiting for background retry
+     */
+    void setQueueDepth(std::size_t depth) noexcept { 
+        m_QueueDepth.store(depth, std::memory_order_relaxed); 
+
+        auto max{m_QueueHighWater.load(std::memory_order_relaxed)};
+        while (depth > max && !m_QueueHighWater.compare_exchange_weak(max, depth, std::memory_order_relaxed))
+            ;
+    }
+
+    /**
+     * Get counters snapshot
+     *
+     * @warning Counters are read one by one, so the snapshot is not atomic as a whole
+     */
+    SendStats get() const noexcept {
+        Metrics metrics{};
+        collect(metrics);
+        return metrics.send;
+    }
+
+    /**
+     * Add counters to snapshot
+     *
+     * @param[in,out] metrics snapshot
+     */
+    void collect(Metrics& metrics) const noexcept {
+        std::array<uint64_t, MetricsMng::ERRNO_SLOTS> byErrno{};
+        try {
+            m_Shards.forEach([&](const SendShard& shard) {
+                metrics.send.sent += shard.sent.get();
+                metrics.bytes += shard.bytes.get();
+                metrics.send.again += shard.again.get();
+                metrics.send.retried += shard.retried.get();
+                metrics.send.dropped += shard.dropped.get();
+                metrics.send.errors += shard.errors.get();
+                for (std::size_t i = 0; i < byErrno.size(); ++i)
+                    byErrno[i] += shard.byErrno[i].get();
+            });
+
+            for (std::size_t i = 0; i < byErrno.size(); ++i) {
+                if (byErrno[i])
+                    metrics.errors.emplace_back(i + 1 < byErrno.size() ? static_cast<int>(i) : MetricsMng::OTHER_ERRNO, byErrno[i]);
+            }
+        }
+        catch (...) {
+            // partial snapshot
+        }
+
+        metrics.queueDepth += m_QueueDepth.load(std::memory_order_relaxed);
+        metrics.queueHighWater += m_QueueHighWater.load(std::memory_order_relaxed);
+    }
+private:
+    /**
+     * Get calling thread shard
+     *
+     * @warning Counting is skipped if the shard can't be allocated, 
+     * senders are noexcept
+     */
+    SendShard& local() noexcept {
+        try {
+            return m_Shards.local();
+        }
+        catch (...) {
+            thread_local SendShard lost;
+            return lost;
+        }
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_METRICS_HPP
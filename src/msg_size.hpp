@@ -0,0 +1,115 @@
+/**
+ * @file msg_size.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_MSG_SIZE_HPP
+#define __CPP_SYSLOG_CLIENT_MSG_SIZE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage oversized messages
+     */
+    class MsgSizeMng;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Find the longest prefix not splitting an UTF-8 sequence
+     * 
+     * @param[in] data text
+     * @param[in] size text size
+     * @param[in] max max prefix size
+     * 
+     * @return Prefix size
+     */
+    inline std::size_t utf8Cut(
+        const char* data,
+        std::size_t size,
+        std::size_t max
+    ) noexcept
+    {
+        if (size <= max)
+            return size;
+
+        auto cut{max};
+        // step back over continuation bytes (10xxxxxx) to the lead byte of the split sequence
+        while (cut > 0 && 0x80 == (static_cast<unsigned char>(data[cut]) & 0xC0))
+            --cut;
+
+        return cut;
+    }
+
+    /**
+     * Get new correlation ID for continuation records
+     */
+    inline uint32_t nextCorrelationId() noexcept {
+        static std::atomic<uint32_t> id{0};
+        return id.fetch_add(1, std::memory_order_relaxed);
+    }
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::MsgSizeMng final {
+public:
+    /**
+     * Available policies for messages exceeding transport max message size
+     */
+    enum MsgSizePolicy {
+        MSP_NONE = 0, ///< send as is, let the network fragment or refuse it
+        MSP_TRUNCATE, ///< cut at UTF-8 boundary and append TRUNCATION_MARKER
+        MSP_SPLIT ///< send as continuation records sharing a correlation ID
+    };
+public:
+    static constexpr const char *const TRUNCATION_MARKER{"..."}; ///< appended to truncated message
+    static constexpr const char *const CORRELATION_KEY{"cid"}; ///< name of continuation records SD-ID, enterprise number is the one of SD-ID
+
+    /**
+     * Max IPv4 message size every receiver MUST accept
+     * 
+     * @link https://datatracker.ietf.org/doc/html/rfc5426#section-3.2
+     */
+    static constexpr std::size_t MIN_UDP_MSG_SIZE{480};
+
+    /**
+     * Max message size fitting a single Ethernet frame (MTU 1500 - IPv4 header - UDP header)
+     * 
+     * @link https://datatracker.ietf.org/doc/html/rfc5426#section-3.2
+     */
+    static constexpr std::size_t DEFAULT_UDP_MSG_SIZE{1500 - 20 - 8};
+};
+
+#endif // __CPP_SYSLOG_CLIENT_MSG_SIZE_HPP
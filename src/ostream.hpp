@@ -30,12 +30,19 @@
 
 #include <iostream>
 #include <memory>
+#include <string>
+#include <type_traits>
 
 #include "level.hpp"
 #include "facility.hpp"
+#include "msg_size.hpp"
+#include "sd.hpp"
 #include "client_int.hpp"
 #include "tmode.hpp"
 #include "fmt_int.hpp"
+#include "send_stats.hpp"
+#include "metrics.hpp"
+#include "format.hpp"
 #include "streambuf.hpp"
 
 /**
@@ -44,26 +51,35 @@
 namespace syslog {
     /**
      * Stream-designed syslog client
+     *
+     * @tparam Mode thread policy, syslog::details::<TMode|st|mt|mt_prof|spin|lf>
+     */
+    template<class Mode>
+    class basic_ostream;
+
+    /**
+     * Stream-designed syslog client choosing thread policy at runtime
      */
-    class ostream;
+    using ostream = basic_ostream<details::TMode>;
 };
 
 ////////////////////////////////////////////////////////////////////////////
 ///
 //
-class syslog::ostream final : public std::ostream {
+template<class Mode>
+class syslog::basic_ostream final : public std::ostream {
 private:
-    details::streambuf m_Buf; ///< stream buffer
+    details::basic_streambuf<Mode> m_Buf; ///< stream buffer
 public:
     /**
      * Ctor
      * 
-     * @param[in] mode <single|multi> thread
      * @param[in] clnt data sender
+     * @param[in] mode thread policy
      */
-    explicit ostream(
+    explicit basic_ostream(
         std::unique_ptr<details::IClient>&& clnt,
-        std::unique_ptr<details::TMode>&& mode
+        std::unique_ptr<Mode>&& mode
     ) : 
         m_Buf{std::move(clnt), std::move(mode)},
         std::ostream{&m_Buf} {
@@ -72,18 +88,18 @@ public:
     /**
      * Copy ctor
      */
-    ostream(const ostream&) = delete;
+    basic_ostream(const basic_ostream&) = delete;
 
     /**
      * Copy assignment operator
      */
-    ostream &operator=(const ostream&) = delete;
+    basic_ostream &operator=(const basic_ostream&) = delete;
 
     /**
      * Move ctor
      */
-    ostream(
-        ostream&& other
+    basic_ostream(
+        basic_ostream&& other
     ) noexcept : 
         m_Buf{std::move(other.m_Buf)},
         std::ostream{&m_Buf} {
@@ -92,7 +108,7 @@ public:
     /**
      * Move assignment operator
      */
-    ostream& operator=(ostream&& other) noexcept {
+    basic_ostream& operator=(basic_ostream&& other) noexcept {
         // self-assignment check
         if (&other == this)
             return *this;
@@ -119,6 +135,115 @@ public:
      */
     void setPort(uint16_t port) noexcept { m_Buf.setPort(port); }
 
+    /**
+     * Setter
+     *
+     * @param[in] on don't block the caller when the kernel queue is full
+     *
+     * @warning By default, socket is blocking
+     */
+    void setNonBlocking(bool on) noexcept { m_Buf.setNonBlocking(on); }
+
+    /**
+     * Setter
+     *
+     * @param[in] size socket send buffer size (SO_SNDBUF) in bytes
+     *
+     * @warning By default, system wide value is used
+     */
+    void setSndBuf(int32_t size) noexcept { m_Buf.setSndBuf(size); }
+
+    /**
+     * Setter
+     *
+     * @param[in] on retry data refused by a full kernel queue once from a background thread
+     *
+     * @warning By default, refused data is dropped
+     */
+    void setRetry(bool on) noexcept { m_Buf.setRetry(on); }
+
+    /**
+     * Getter
+     *
+     * @return Data sender counters snapshot
+     */
+    SendStats getStats() const noexcept { return m_Buf.getStats(); }
+
+    /**
+     * Getter
+     *
+     * @return Metrics snapshot: messages per severity level, bytes, errors per errno, queue depth, drops and latencies
+     *
+     * @warning Counters are kept per thread, so they are summed up here and never contended by senders
+     */
+    Metrics getMetrics() const { return m_Buf.getMetrics(); }
+
+    /**
+     * Setter
+     *
+     * @param[in] on measure format, lock wait and send latencies
+     *
+     * @warning By default, latencies are not measured
+     */
+    void setLatencyMetrics(bool on) noexcept { m_Buf.setLatencyMetrics(on); }
+
+    /**
+     * Setter
+     *
+     * @param[in] period seconds between self-telemetry records, 0 stops them
+     *
+     * @warning By default, self-telemetry is off
+     * @warning Records carry element syslog::TelemetryMng::SD_NAME with rate, msgs, records, sent, bytes, dropped, again, errors and qmax
+     */
+    void setTelemetryPeriod(uint32_t period) noexcept { m_Buf.setTelemetryPeriod(period); }
+
+    /**
+     * Setter
+     *
+     * @param[in] on number records, for receivers to detect loss and reordering
+     *
+     * @warning By default, records are not numbered
+     * @warning Records carry [meta sequenceId="N"] counting records of the client, 1 to syslog::SequenceMng::MAX_SEQUENCE_ID, 
+     * and element syslog::SequenceMng::THREAD_SD_NAME with thread number and its own counter
+     */
+    void setSequence(bool on) noexcept { m_Buf.setSequence(on); }
+
+    /**
+     * Getter
+     *
+     * @return Lock wait and hold times per acquisition site, empty unless thread policy is syslog::details::mt_prof
+     */
+    LockProfile getLockProfile() const { return m_Buf.getLockProfile(); }
+
+    /**
+     * Setter
+     *
+     * @param[in] size max message size fitting one transport unit
+     *
+     * @warning By default, it depends on transport, e.g. syslog::MsgSizeMng::DEFAULT_UDP_MSG_SIZE for UDP
+     */
+    void setMaxMsgSize(std::size_t size) noexcept { m_Buf.setMaxMsgSize(size); }
+
+    /**
+     * Setter
+     *
+     * @param[in] policy what to do with messages exceeding max message size
+     *
+     * @warning By default, oversized messages policy is syslog::MsgSizeMng::MsgSizePolicy::MSP_TRUNCATE
+     */
+    void setMsgSizePolicy(MsgSizeMng::MsgSizePolicy policy) { m_Buf.setMsgSizePolicy(policy); }
+
+    /**
+     * Setter
+     *
+     * @param[in] on replace control chars by syslog::ScanMng::CONTROL_REPLACEMENT and malformed UTF-8 by 
+     * syslog::ScanMng::UTF8_REPLACEMENT, drop trailing line feeds
+     *
+     * @warning By default, messages are sent as written
+     * @warning Clean messages are checked only, 16 or 32 bytes at once where CPU allows it
+     */
+    void setSanitize(bool on) { m_Buf.setSanitize(on); }
+
     /**
      * Setter
      *
@@ -126,28 +251,120 @@ public:
      *
      * @warning By default, log facility is syslog::LogFacilityMng::LogFacility::LF_LOCAL7
      */
-    void setFacility(LogFacilityMng::LogFacility facility) noexcept { m_Buf.setFacility(facility); }
+    void setFacility(LogFacilityMng::LogFacility facility) { m_Buf.setFacility(facility); }
 
     /**
      * Setter
      *
-     * @param[in] lvl log severity level
+     * @param[in] lvl default log severity level, used by messages with no level set in stream
      *
      * @warning By default, log severity level is syslog::LogLvlMng::LogLvl::LL_DEBUG
      */
-    void setLvl(LogLvlMng::LogLvl lvl) noexcept { m_Buf.setLvl(lvl); }
+    void setLvl(LogLvlMng::LogLvl lvl) { m_Buf.setLvl(lvl); }
+
+    /**
+     * Setter
+     *
+     * @param[in] lvl log severity level of the message being composed by calling thread
+     *
+     * @warning Applies to the next message only
+     */
+    void setRecordLvl(LogLvlMng::LogLvl lvl) noexcept { m_Buf.setRecordLvl(lvl); }
+
+    /**
+     * Add structured data parameter to the message being composed by calling thread
+     *
+     * @param[in] key SD-PARAM name
+     * @param[in] value SD-PARAM value, integers, floating point numbers, chars and strings
+     *
+     * @warning Applies to the next message only, see also syslog::kv()
+     */
+    template<class T>
+    void addRecordParam(const char* key, const T& value) { m_Buf.addRecordParam(key, value); }
+
+    /**
+     * Setter
+     *
+     * @param[in] sdId SD-ID of the element grouping formatter flags and message parameters
+     *
+     * @warning By default, SD-ID is syslog::SDMng::DEFAULT_SD_ID
+     */
+    void setSDId(const std::string& sdId) { m_Buf.setSDId(sdId); }
 
     /**
      * Setter
      *
      * @param[in] formatter new formatter flag
      */
-    void addFormatter(std::shared_ptr<IFormatter>&& formatter) noexcept { m_Buf.addFormatter(std::move(formatter)); }
+    void addFormatter(std::shared_ptr<IFormatter>&& formatter) { m_Buf.addFormatter(std::move(formatter)); }
 
     /**
      * Remove all formatter flags
      */
-    void cleanFormatters() noexcept { m_Buf.cleanFormatters(); }
+    void cleanFormatters() { m_Buf.cleanFormatters(); }
+
+    /**
+     * Format message and send it to syslog server, bypassing iostreams
+     *
+     * @param[in] lvl log severity level
+     * @param[in] fmt format string made by SYSLOG_FMT(), e.g. SYSLOG_FMT("user {} took {} ms")
+     * @param[in] args arguments, integers, floating point numbers, chars and strings
+     *
+     * @warning Format string is checked against arguments at compile time
+     */
+    template<class Fmt, class... Args>
+    void log(LogLvlMng::LogLvl lvl, Fmt fmt, const Args&... args) { m_Buf.log(lvl, fmt, args...); }
+
+    /**
+     * Log message with formatting and sending done by a background thread
+     *
+     * @param[in] lvl log severity level
+     * @param[in] fmt format string made by SYSLOG_FMT()
+     * @param[in] args arguments, integers, floating point numbers, chars and strings
+     *
+     * @return false if calling thread ring is full and message was dropped
+     *
+     * @warning Caller only copies format descriptor and raw arguments, messages are sent in order per thread
+     */
+    template<class Fmt, class... Args>
+    bool defer(LogLvlMng::LogLvl lvl, Fmt fmt, const Args&... args) { return m_Buf.defer(lvl, fmt, args...); }
+
+    /**
+     * Wait until deferred messages logged so far are sent
+     */
+    void drainDeferred() { m_Buf.drainDeferred(); }
+
+    /**
+     * Insert value, formatting it straight into the message being composed
+     *
+     * @param[in] val integer, floating point number, char or string
+     *
+     * @return Stream
+     *
+     * @warning Falls back to std::ostream when format flags, width, precision or locale differ from defaults
+     */
+    template<class T>
+    basic_ostream& insert(const T& val) {
+        if (isPlain(std::is_floating_point<T>::value))
+            m_Buf.append(val);
+        else
+            static_cast<std::ostream&>(*this) << val;
+
+        return *this;
+    }
+private:
+    /**
+     * Output of std::ostream equals "C" locale with default formatting?
+     *
+     * @param[in] floating value is floating point number, so precision matters
+     */
+    bool isPlain(bool floating) const {
+        return good() && 
+            0 == width() && 
+            (std::ios_base::skipws | std::ios_base::dec) == flags() && 
+            (!floating || 6 == precision()) && 
+            m_Buf.isClassicLocale();
+    }
 };
 
 /**
@@ -155,16 +372,115 @@ public:
  */
 namespace syslog {
     /**
-     * Set log severity level in stream
+     * Set log severity level of the message being composed
      *
      * @param[in] os stream
      * @param[in] lvl log severity level
+     *
+     * @warning Lock free, each thread keeps its own level, it's reset to default when message is sent
      */
-    inline ostream &operator<<(
-        ostream &os,
+    template<class Mode>
+    basic_ostream<Mode> &operator<<(
+        basic_ostream<Mode> &os,
         LogLvlMng::LogLvl lvl)
     {
-        os.setLvl(lvl);
+        os.setRecordLvl(lvl);
+        return os;
+    }
+
+    /**
+     * Add structured data parameter to the message being composed
+     *
+     * @param[in] os stream
+     * @param[in] param parameter made by syslog::kv()
+     *
+     * @warning Lock free, each thread keeps its own parameters, they are cleared when message is sent
+     */
+    template<class Mode, class T>
+    basic_ostream<Mode> &operator<<(
+        basic_ostream<Mode> &os,
+        const details::KV<T>& param)
+    {
+        os.addRecordParam(param.key, param.value);
+        return os;
+    }
+
+    /**
+     * Insert integer, floating point number or char
+     *
+     * @param[in] os stream
+     * @param[in] val value
+     *
+     * @warning Digits are written with no locale lookup or std::num_put, while output stays as in "C" locale
+     */
+    template<class Mode, class T>
+    typename std::enable_if<std::is_arithmetic<T>::value, basic_ostream<Mode>&>::type operator<<(
+        basic_ostream<Mode> &os,
+        T val)
+    {
+        return os.insert(val);
+    }
+
+    /**
+     * Insert C-string
+     *
+     * @param[in] os stream
+     * @param[in] val value
+     */
+    template<class Mode>
+    basic_ostream<Mode> &operator<<(
+        basic_ostream<Mode> &os,
+        const char* val)
+    {
+        if (nullptr == val) {
+            static_cast<std::ostream&>(os) << val; // let std::ostream set badbit
+            return os;
+        }
+
+        return os.insert(val);
+    }
+
+    /**
+     * Insert string
+     *
+     * @param[in] os stream
+     * @param[in] val value
+     */
+    template<class Mode, class A>
+    basic_ostream<Mode> &operator<<(
+        basic_ostream<Mode> &os,
+        const std::basic_string<char, std::char_traits<char>, A>& val)
+    {
+        return os.insert(val);
+    }
+
+    /**
+     * Apply manipulator, e.g. std::endl, keeping the stream type for next insertions
+     *
+     * @param[in] os stream
+     * @param[in] manip manipulator
+     */
+    template<class Mode>
+    basic_ostream<Mode> &operator<<(
+        basic_ostream<Mode> &os,
+        std::ostream& (*manip)(std::ostream&))
+    {
+        manip(os);
+        return os;
+    }
+
+    /**
+     * Apply format manipulator, e.g. std::hex, keeping the stream type for next insertions
+     *
+     * @param[in] os stream
+     * @param[in] manip manipulator
+     */
+    template<class Mode>
+    basic_ostream<Mode> &operator<<(
+        basic_ostream<Mode> &os,
+        std::ios_base& (*manip)(std::ios_base&))
+    {
+        manip(os);
         return os;
     }
 };
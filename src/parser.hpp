@@ -0,0 +1,378 @@
+/**
+ * @file parser.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_PARSER_HPP
+#define __CPP_SYSLOG_CLIENT_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "scan.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage parsed message formats
+     */
+    class ParserMng;
+
+    /**
+     * Non-owning reference to chars of a received record
+     */
+    struct StrRef;
+
+    /**
+     * Fields of a received record, referencing its buffer
+     */
+    struct ParsedMsg;
+
+    /**
+     * Split record into fields, nothing is copied
+     *
+     * @param[in] data record, framing stripped
+     * @param[in] size record size
+     * @param[out] msg fields, valid while data is
+     *
+     * @return false if record has no valid PRI
+     */
+    inline bool parseMsg(const char* data, std::size_t size, ParsedMsg& msg) noexcept;
+
+    /**
+     * Visit SD-ELEMENTs of structured data
+     *
+     * @param[in] sd structured data, see syslog::ParsedMsg::sd
+     * @param[in] fn visitor, void(StrRef id, StrRef params), params are raw "name=\"value\"..." pairs
+     */
+    template<class Fn>
+    void forEachSDElement(StrRef sd, Fn&& fn);
+
+    /**
+     * Visit SD-PARAMs of SD-ELEMENT
+     *
+     * @param[in] params params of element, see syslog::forEachSDElement()
+     * @param[in] fn visitor, void(StrRef name, StrRef value), value is raw, escapes \", \\ and \] are kept
+     */
+    template<class Fn>
+    void forEachSDParam(StrRef params, Fn&& fn);
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Find end of SD-ELEMENT
+     *
+     * @param[in] pos opening bracket
+     * @param[in] end end of data
+     *
+     * @return Closing bracket, end if element isn't closed
+     */
+    inline const char* sdElementEnd(const char* pos, const char* end) noexcept;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::ParserMng final {
+public:
+    /**
+     * Record format
+     */
+    enum MsgFormat {
+        MF_BARE = 0, ///< "<PRI> [SD-ELEMENTs ]MSG", as syslog::basic_ostream makes it
+        MF_RFC3164, ///< "<PRI>Mmm dd hh:mm:ss HOST TAG[PID]: MSG"
+        MF_RFC5424 ///< "<PRI>VERSION TIMESTAMP HOST APP PROCID MSGID SD MSG"
+    };
+
+    static constexpr int MAX_PRI{191}; ///< facility 23, severity 7
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::StrRef {
+    const char* data{nullptr}; ///< first char
+    std::size_t size{0}; ///< number of chars
+
+    /**
+     * Getter
+     */
+    bool empty() const noexcept { return 0 == size; }
+
+    /**
+     * Compare with C string
+     */
+    bool equals(const char* str) const noexcept { 
+        return std::strlen(str) == size && (0 == size || 0 == std::memcmp(data, str, size)); 
+    }
+
+    /**
+     * Copy chars
+     */
+    std::string str() const { return std::string(data ? data : "", size); }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::ParsedMsg {
+    ParserMng::MsgFormat format{ParserMng::MF_BARE}; ///< record format
+    int                  pri{0}; ///< facility * 8 + severity
+    int                  version{0}; ///< RFC 5424 version, 0 for other formats
+    StrRef               timestamp; ///< as sent, empty if nil or absent
+    StrRef               host; ///< hostname, empty if nil or absent
+    StrRef               app; ///< RFC 5424 APP-NAME or RFC 3164 TAG, empty if nil or absent
+    StrRef               procId; ///< RFC 5424 PROCID or RFC 3164 "[PID]", empty if nil or absent
+    StrRef               msgId; ///< RFC 5424 MSGID, empty if nil or absent
+    StrRef               sd; ///< SD-ELEMENTs as sent, brackets included, empty if nil or absent
+    StrRef               msg; ///< message, trailing LF and NUL dropped
+
+    /**
+     * Getter
+     */
+    int getSeverity() const noexcept { return pri & 7; }
+
+    /**
+     * Getter
+     */
+    int getFacility() const noexcept { return pri >> 3; }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline const char* syslog::details::sdElementEnd(const char* pos, const char* end) noexcept {
+    const auto& kernels{scanKernels()};
+    bool quoted{false};
+    for (++pos; pos < end; ++pos) {
+        pos += kernels.findSDSpecial(pos, static_cast<std::size_t>(end - pos)); // only '"', '\\' and ']' matter
+        if (pos >= end)
+            break;
+
+        if (quoted) {
+            if ('\\' == *pos)
+                ++pos; // escaped char
+            else if ('"' == *pos)
+                quoted = false;
+        }
+        else if ('"' == *pos) {
+            quoted = true;
+        }
+        else if (']' == *pos) {
+            return pos;
+        }
+    }
+
+    return end;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline bool syslog::parseMsg(const char* data, std::size_t size, ParsedMsg& msg) noexcept {
+    msg = ParsedMsg{};
+
+    const char* pos{data};
+    const char* end{data + size};
+    while (end > pos && ('\n' == end[-1] || '\0' == end[-1]))
+        --end;
+
+    // <PRI>, 1 to 3 digits
+    if (end - pos < 3 || '<' != *pos)
+        return false;
+    ++pos;
+
+    int pri{0};
+    const char* digits{pos};
+    while (pos < end && pos - digits < 3 && *pos >= '0' && *pos <= '9')
+        pri = pri * 10 + (*pos++ - '0');
+    if (pos == digits || pos == end || '>' != *pos || pri > ParserMng::MAX_PRI)
+        return false;
+    msg.pri = pri;
+    ++pos;
+
+    auto token = [&end](const char*& cur) noexcept {
+        StrRef ref;
+        if (cur >= end)
+            return ref;
+
+        auto space{static_cast<const char*>(std::memchr(cur, ' ', static_cast<std::size_t>(end - cur)))};
+        if (!space)
+            space = end;
+        if (!(1 == space - cur && '-' == *cur)) // nil
+            ref = StrRef{cur, static_cast<std::size_t>(space - cur)};
+
+        cur = space < end ? space + 1 : end;
+        return ref;
+    };
+
+    auto structured = [&end](const char*& cur) noexcept {
+        StrRef ref;
+        const char* begin{cur};
+        while (cur < end && '[' == *cur) {
+            auto close{details::sdElementEnd(cur, end)};
+            if (close == end)
+                break; // unterminated element is left in message
+            cur = close + 1;
+        }
+        if (cur != begin)
+            ref = StrRef{begin, static_cast<std::size_t>(cur - begin)};
+
+        return ref;
+    };
+
+    // RFC 5424: VERSION SP
+    if (pos < end && *pos >= '1' && *pos <= '9') {
+        const char* ver{pos};
+        int version{0};
+        while (pos < end && pos - ver < 2 && *pos >= '0' && *pos <= '9')
+            version = version * 10 + (*pos++ - '0');
+
+        if (pos < end && ' ' == *pos) {
+            msg.format = ParserMng::MF_RFC5424;
+            msg.version = version;
+            ++pos;
+            msg.timestamp = token(pos);
+            msg.host = token(pos);
+            msg.app = token(pos);
+            msg.procId = token(pos);
+            msg.msgId = token(pos);
+            if (pos < end && '-' == *pos)
+                ++pos; // nil SD
+            else
+                msg.sd = structured(pos);
+            if (pos < end && ' ' == *pos)
+                ++pos;
+            msg.msg = StrRef{pos, static_cast<std::size_t>(end - pos)};
+            return true;
+        }
+
+        pos = ver;
+    }
+
+    // RFC 3164: "Mmm dd hh:mm:ss " TIMESTAMP
+    static constexpr std::size_t STAMP_SIZE{15};
+    if (static_cast<std::size_t>(end - pos) > STAMP_SIZE && ' ' == pos[3] && ' ' == pos[STAMP_SIZE] && 
+        ':' == pos[9] && ':' == pos[12] && std::strchr("JFMASOND", pos[0])) {
+        msg.format = ParserMng::MF_RFC3164;
+        msg.timestamp = StrRef{pos, STAMP_SIZE};
+        pos += STAMP_SIZE + 1;
+        msg.host = token(pos);
+
+        // TAG[PID]: 
+        const char* tag{pos};
+        while (pos < end && ':' != *pos && '[' != *pos && ' ' != *pos)
+            ++pos;
+        msg.app = StrRef{tag, static_cast<std::size_t>(pos - tag)};
+        if (pos < end && '[' == *pos) {
+            auto close{static_cast<const char*>(std::memchr(pos, ']', static_cast<std::size_t>(end - pos)))};
+            if (close) {
+                msg.procId = StrRef{pos + 1, static_cast<std::size_t>(close - pos - 1)};
+                pos = close + 1;
+            }
+        }
+        if (pos < end && ':' == *pos)
+            ++pos;
+        if (pos < end && ' ' == *pos)
+            ++pos;
+        msg.msg = StrRef{pos, static_cast<std::size_t>(end - pos)};
+        return true;
+    }
+
+    // bare: [SD-ELEMENTs ]MSG
+    if (pos < end && ' ' == *pos)
+        ++pos;
+    msg.sd = structured(pos);
+    if (!msg.sd.empty() && pos < end && ' ' == *pos)
+        ++pos;
+    msg.msg = StrRef{pos, static_cast<std::size_t>(end - pos)};
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class Fn>
+void syslog::forEachSDElement(StrRef sd, Fn&& fn) {
+    const char* pos{sd.data};
+    const char* end{sd.data + sd.size};
+    while (pos < end && '[' == *pos) {
+        auto close{details::sdElementEnd(pos, end)};
+        if (close == end)
+            return;
+
+        const char* id{pos + 1};
+        const char* idEnd{id};
+        while (idEnd < close && ' ' != *idEnd)
+            ++idEnd;
+
+        const char* params{idEnd < close ? idEnd + 1 : close};
+        fn(StrRef{id, static_cast<std::size_t>(idEnd - id)}, StrRef{params, static_cast<std::size_t>(close - params)});
+        pos = close + 1;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class Fn>
+void syslog::forEachSDParam(StrRef params, Fn&& fn) {
+    const char* pos{params.data};
+    const char* end{params.data + params.size};
+    while (pos < end) {
+        while (pos < end && ' ' == *pos)
+            ++pos;
+
+        const char* name{pos};
+        while (pos < end && '=' != *pos)
+            ++pos;
+        if (end - pos < 2 || '"' != pos[1])
+            return;
+
+        StrRef key{name, static_cast<std::size_t>(pos - name)};
+        pos += 2;
+        const char* value{pos};
+        const auto& kernels{details::scanKernels()};
+        while (pos < end) {
+            pos += kernels.findSDSpecial(pos, static_cast<std::size_t>(end - pos));
+            if (pos >= end || '"' == *pos)
+                break;
+            pos += '\\' == *pos ? 2 : 1;
+        }
+        if (pos >= end)
+            return;
+
+        fn(key, StrRef{value, static_cast<std::size_t>(pos - value)});
+        ++pos;
+    }
+}
+
+#endif // __CPP_SYSLOG_CLIENT_PARSER_HPP
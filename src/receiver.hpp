@@ -0,0 +1,571 @@
+/**
+ * @file receiver.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_RECEIVER_HPP
+#define __CPP_SYSLOG_CLIENT_RECEIVER_HPP
+
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <unordered_map>
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage receivers defaults
+     */
+    class ReceiverMng;
+
+    /**
+     * Receiver counters
+     */
+    struct RecvStats;
+
+    /**
+     * Class for receiving records over UDP, a batch of datagrams per system call
+     */
+    class UDPReceiver;
+
+    /**
+     * Class for receiving records over TCP, octet counting and LF framing (RFC 6587)
+     */
+    class TCPReceiver;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Open socket bound to address
+     *
+     * @param[in] type SOCK_DGRAM or SOCK_STREAM
+     * @param[in] addr IPv4 address
+     * @param[in] port port, 0 for an ephemeral one
+     * @param[out] bound actual port
+     * @param[in] reusePort share port with other sockets having it set (SO_REUSEPORT), kernel balances load among them
+     *
+     * @return Socket, -1 on error
+     */
+    inline int bindSock(int type, const char* addr, uint16_t port, uint16_t& bound, bool reusePort = false) noexcept;
+
+    /**
+     * TCP connection state
+     */
+    struct TCPConn;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::ReceiverMng final {
+public:
+    static constexpr const char *const DEFAULT_ADDR{"127.0.0.1"}; ///< default
+    static constexpr std::size_t       DEFAULT_BATCH{64}; ///< datagrams per recvmmsg() call
+    static constexpr std::size_t       DEFAULT_MAX_MSG_SIZE{8192}; ///< max record, longer ones are truncated
+    static constexpr int               DEFAULT_SOCK{-1}; ///< default
+    static constexpr int               MAX_EVENTS{64}; ///< events per epoll_wait() call
+    static constexpr int               BACKLOG{128}; ///< pending connections
+    static constexpr int               MAX_READS{16}; ///< reads of one connection or batches of datagrams per poll, so a busy peer doesn't starve others
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::RecvStats {
+    uint64_t records; ///< records delivered
+    uint64_t bytes; ///< bytes of records delivered
+    uint64_t truncated; ///< records longer than max size, delivered cut
+    uint64_t calls; ///< receiving system calls
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline int syslog::details::bindSock(int type, const char* addr, uint16_t port, uint16_t& bound, bool reusePort) noexcept {
+    int sock{socket(AF_INET, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+    if (sock < 0)
+        return ReceiverMng::DEFAULT_SOCK;
+
+    int on{1};
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (reusePort && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on))) {
+        close(sock);
+        return ReceiverMng::DEFAULT_SOCK;
+    }
+
+    sockaddr_in sin{};
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(port);
+    sin.sin_addr.s_addr = inet_addr(addr);
+    socklen_t len{sizeof(sin)};
+    if (bind(sock, (sockaddr*)&sin, sizeof(sin)) || getsockname(sock, (sockaddr*)&sin, &len) ||
+        (SOCK_STREAM == type && listen(sock, ReceiverMng::BACKLOG))) {
+        close(sock);
+        return ReceiverMng::DEFAULT_SOCK;
+    }
+
+    bound = ntohs(sin.sin_port);
+    return sock;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::UDPReceiver final {
+private:
+    int                  m_Sock; ///< bound socket
+    uint16_t             m_Port; ///< bound port
+    std::size_t          m_MaxMsgSize; ///< slot size of each datagram
+    std::vector<char>    m_Bufs; ///< datagram slots, batch * max size
+    std::vector<iovec>   m_Iovs; ///< slot of each datagram
+    std::vector<mmsghdr> m_Hdrs; ///< recvmmsg() headers
+    RecvStats            m_Stats; ///< counters
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] addr IPv4 address to listen on
+     * @param[in] port port, 0 for an ephemeral one, see getPort()
+     * @param[in] batch max datagrams taken by one system call
+     * @param[in] maxMsgSize max record size, longer ones are truncated
+     * @param[in] reusePort several receivers, e.g. one per thread, may listen on the same port, 
+     * datagrams are spread among them by source address
+     *
+     * @warning Check isInitialised(), socket errors are not thrown
+     */
+    explicit UDPReceiver(
+        const char* addr = ReceiverMng::DEFAULT_ADDR,
+        uint16_t port = 0,
+        std::size_t batch = ReceiverMng::DEFAULT_BATCH,
+        std::size_t maxMsgSize = ReceiverMng::DEFAULT_MAX_MSG_SIZE,
+        bool reusePort = false
+    ) :
+        m_Sock{ReceiverMng::DEFAULT_SOCK},
+        m_Port{0},
+        m_MaxMsgSize{maxMsgSize ? maxMsgSize : 1},
+        m_Bufs((batch ? batch : 1) * m_MaxMsgSize),
+        m_Iovs(batch ? batch : 1),
+        m_Hdrs(batch ? batch : 1),
+        m_Stats{0, 0, 0, 0}
+    {
+        for (std::size_t i = 0; i < m_Hdrs.size(); ++i) {
+            m_Iovs[i].iov_base = m_Bufs.data() + i * m_MaxMsgSize;
+            m_Iovs[i].iov_len = m_MaxMsgSize;
+            std::memset(&m_Hdrs[i], 0, sizeof(mmsghdr));
+            m_Hdrs[i].msg_hdr.msg_iov = &m_Iovs[i];
+            m_Hdrs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        m_Sock = details::bindSock(SOCK_DGRAM, addr, port, m_Port, reusePort);
+    }
+
+    /**
+     * Copy ctor
+     */
+    UDPReceiver(const UDPReceiver&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    UDPReceiver& operator=(const UDPReceiver&) = delete;
+
+    /**
+     * Dtor
+     */
+    ~UDPReceiver() {
+        if (isInitialised())
+            close(m_Sock);
+    }
+
+    /**
+     * Getter
+     */
+    bool isInitialised() const noexcept { return m_Sock != ReceiverMng::DEFAULT_SOCK; }
+
+    /**
+     * Getter
+     */
+    uint16_t getPort() const noexcept { return m_Port; }
+
+    /**
+     * Getter
+     */
+    int getSock() const noexcept { return m_Sock; }
+
+    /**
+     * Getter
+     */
+    const RecvStats& getStats() const noexcept { return m_Stats; }
+
+    /**
+     * Setter
+     *
+     * @param[in] size socket receive buffer size in bytes, absorbs bursts
+     */
+    void setRcvBuf(int size) noexcept {
+        if (isInitialised())
+            setsockopt(m_Sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+
+    /**
+     * Wait for datagrams and deliver all queued ones
+     *
+     * @param[in] timeoutMs max wait, 0 doesn't wait, -1 waits forever
+     * @param[in] fn handler, void(const char* data, std::size_t size), data is valid until it returns
+     *
+     * @return Number of records delivered
+     */
+    template<class Fn>
+    std::size_t poll(int timeoutMs, Fn&& fn) {
+        if (!isInitialised())
+            return 0;
+
+        pollfd pfd{m_Sock, POLLIN, 0};
+        if (timeoutMs && ::poll(&pfd, 1, timeoutMs) <= 0)
+            return 0;
+
+        std::size_t total{0};
+        for (auto reads = 0; reads < ReceiverMng::MAX_READS; ++reads) {
+            auto got{recvmmsg(m_Sock, m_Hdrs.data(), static_cast<unsigned>(m_Hdrs.size()), MSG_DONTWAIT, nullptr)};
+            ++m_Stats.calls;
+            if (got <= 0)
+                break;
+
+            for (auto i = 0; i < got; ++i) {
+                auto& hdr{m_Hdrs[i]};
+                if (hdr.msg_hdr.msg_flags & MSG_TRUNC)
+                    ++m_Stats.truncated;
+
+                m_Stats.bytes += hdr.msg_len;
+                fn(static_cast<const char*>(m_Iovs[i].iov_base), static_cast<std::size_t>(hdr.msg_len));
+            }
+
+            m_Stats.records += static_cast<uint64_t>(got);
+            total += static_cast<std::size_t>(got);
+            if (static_cast<std::size_t>(got) < m_Hdrs.size())
+                break;
+        }
+
+        return total;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::TCPConn {
+    std::vector<char> buf; ///< received data, framed records and a partial one
+    std::size_t       begin{0}; ///< start of unparsed data
+    std::size_t       end{0}; ///< end of received data
+    bool              skip{false}; ///< rest of a cut LF framed record is dropped
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::TCPReceiver final {
+private:
+    int                                              m_Sock; ///< listening socket
+    int                                              m_Epoll; ///< epoll instance
+    uint16_t                                         m_Port; ///< bound port
+    std::size_t                                      m_MaxMsgSize; ///< max record size
+    std::unordered_map<int, details::TCPConn>        m_Conns; ///< connections by socket
+    std::vector<epoll_event>                         m_Events; ///< epoll_wait() output
+    RecvStats                                        m_Stats; ///< counters
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] addr IPv4 address to listen on
+     * @param[in] port port, 0 for an ephemeral one, see getPort()
+     * @param[in] maxMsgSize max record size, longer LF framed ones are cut, connection sending longer octet counted one is closed
+     *
+     * @warning Check isInitialised(), socket errors are not thrown
+     */
+    explicit TCPReceiver(
+        const char* addr = ReceiverMng::DEFAULT_ADDR,
+        uint16_t port = 0,
+        std::size_t maxMsgSize = ReceiverMng::DEFAULT_MAX_MSG_SIZE
+    ) :
+        m_Sock{ReceiverMng::DEFAULT_SOCK},
+        m_Epoll{epoll_create1(EPOLL_CLOEXEC)},
+        m_Port{0},
+        m_MaxMsgSize{maxMsgSize ? maxMsgSize : 1},
+        m_Events(ReceiverMng::MAX_EVENTS),
+        m_Stats{0, 0, 0, 0}
+    {
+        if (m_Epoll < 0)
+            return;
+
+        m_Sock = details::bindSock(SOCK_STREAM, addr, port, m_Port);
+        if (!isInitialised())
+            return;
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = m_Sock;
+        epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_Sock, &ev);
+    }
+
+    /**
+     * Copy ctor
+     */
+    TCPReceiver(const TCPReceiver&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    TCPReceiver& operator=(const TCPReceiver&) = delete;
+
+    /**
+     * Dtor
+     */
+    ~TCPReceiver() {
+        for (const auto& conn : m_Conns)
+            close(conn.first);
+        if (isInitialised())
+            close(m_Sock);
+        if (m_Epoll >= 0)
+            close(m_Epoll);
+    }
+
+    /**
+     * Getter
+     */
+    bool isInitialised() const noexcept { return m_Sock != ReceiverMng::DEFAULT_SOCK; }
+
+    /**
+     * Getter
+     */
+    uint16_t getPort() const noexcept { return m_Port; }
+
+    /**
+     * Getter
+     */
+    std::size_t getConnCount() const noexcept { return m_Conns.size(); }
+
+    /**
+     * Getter
+     */
+    const RecvStats& getStats() const noexcept { return m_Stats; }
+
+    /**
+     * Wait for connections and data, deliver all complete records
+     *
+     * @param[in] timeoutMs max wait, 0 doesn't wait, -1 waits forever
+     * @param[in] fn handler, void(const char* data, std::size_t size), data is valid until it returns
+     *
+     * @return Number of records delivered
+     *
+     * @warning Partial record left by a closed connection is dropped
+     */
+    template<class Fn>
+    std::size_t poll(int timeoutMs, Fn&& fn) {
+        if (!isInitialised())
+            return 0;
+
+        auto count{epoll_wait(m_Epoll, m_Events.data(), static_cast<int>(m_Events.size()), timeoutMs)};
+        std::size_t total{0};
+        for (auto i = 0; i < count; ++i) {
+            auto fd{m_Events[i].data.fd};
+            if (fd == m_Sock)
+                accept();
+            else
+                total += read(fd, fn);
+        }
+
+        return total;
+    }
+private:
+    /**
+     * Accept pending connections
+     */
+    void accept() {
+        for (;;) {
+            auto conn{accept4(m_Sock, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+            if (conn < 0)
+                return;
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = conn;
+            if (epoll_ctl(m_Epoll, EPOLL_CTL_ADD, conn, &ev)) {
+                close(conn);
+                continue;
+            }
+
+            // room for two max records, so a partial one never blocks the next read
+            m_Conns[conn].buf.resize(2 * m_MaxMsgSize + 32);
+        }
+    }
+
+    /**
+     * Read connection data and deliver complete records
+     */
+    template<class Fn>
+    std::size_t read(int fd, Fn& fn) {
+        auto it{m_Conns.find(fd)};
+        if (it == m_Conns.end())
+            return 0;
+
+        auto& conn{it->second};
+        std::size_t total{0};
+        for (auto reads = 0; reads < ReceiverMng::MAX_READS; ++reads) {
+            if (conn.begin) {
+                std::memmove(conn.buf.data(), conn.buf.data() + conn.begin, conn.end - conn.begin);
+                conn.end -= conn.begin;
+                conn.begin = 0;
+            }
+
+            auto got{::read(fd, conn.buf.data() + conn.end, conn.buf.size() - conn.end)};
+            ++m_Stats.calls;
+            if (got < 0 && (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno))
+                return total;
+            if (got <= 0) {
+                drop(fd);
+                return total;
+            }
+
+            conn.end += static_cast<std::size_t>(got);
+            bool ok{true};
+            total += unframe(conn, fn, ok);
+            if (!ok) {
+                drop(fd);
+                return total;
+            }
+        }
+
+        return total; // level triggered, the rest is taken by next poll
+    }
+
+    /**
+     * Deliver complete records of connection buffer
+     *
+     * @param[in,out] conn connection
+     * @param[in] fn handler
+     * @param[out] ok false if framing is broken
+     *
+     * @return Number of records delivered
+     *
+     * @link https://datatracker.ietf.org/doc/html/rfc6587#section-3.4
+     */
+    template<class Fn>
+    std::size_t unframe(details::TCPConn& conn, Fn& fn, bool& ok) {
+        std::size_t total{0};
+        const char* base{conn.buf.data()};
+        while (conn.begin < conn.end) {
+            const char* pos{base + conn.begin};
+            const char* end{base + conn.end};
+            if (!conn.skip && *pos >= '1' && *pos <= '9') {
+                // octet counting: MSG-LEN SP SYSLOG-MSG
+                std::size_t len{0};
+                const char* cur{pos};
+                while (cur < end && *cur >= '0' && *cur <= '9' && len <= m_MaxMsgSize)
+                    len = len * 10 + static_cast<std::size_t>(*cur++ - '0');
+                if (len > m_MaxMsgSize || (cur < end && ' ' != *cur)) {
+                    ok = false;
+                    return total;
+                }
+                if (cur == end || static_cast<std::size_t>(end - cur - 1) < len)
+                    return total; // incomplete
+
+                deliver(fn, cur + 1, len, false);
+                ++total;
+                conn.begin = static_cast<std::size_t>(cur + 1 + len - base);
+            }
+            else {
+                // non-transparent framing: SYSLOG-MSG LF
+                auto lf{static_cast<const char*>(std::memchr(pos, '\n', static_cast<std::size_t>(end - pos)))};
+                if (!lf) {
+                    if (!conn.skip && static_cast<std::size_t>(end - pos) < m_MaxMsgSize)
+                        return total; // incomplete
+
+                    if (!conn.skip) {
+                        deliver(fn, pos, m_MaxMsgSize, true);
+                        ++total;
+                    }
+                    conn.skip = true; // rest of the record, up to LF
+                    conn.begin = conn.end;
+                    return total;
+                }
+
+                auto len{static_cast<std::size_t>(lf - pos)};
+                if (len && '\r' == pos[len - 1])
+                    --len;
+                if (len && !conn.skip) {
+                    deliver(fn, pos, std::min(len, m_MaxMsgSize), len > m_MaxMsgSize);
+                    ++total;
+                }
+                conn.skip = false;
+                conn.begin = static_cast<std::size_t>(lf + 1 - base);
+            }
+        }
+
+        return total;
+    }
+
+    /**
+     * Pass record to handler
+     */
+    template<class Fn>
+    void deliver(Fn& fn, const char* data, std::size_t size, bool truncated) {
+        ++m_Stats.records;
+        m_Stats.bytes += size;
+        if (truncated)
+            ++m_Stats.truncated;
+        fn(data, size);
+    }
+
+    /**
+     * Close connection
+     */
+    void drop(int fd) {
+        epoll_ctl(m_Epoll, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        m_Conns.erase(fd);
+    }
+};
+
+#endif // __linux__
+
+#endif // __CPP_SYSLOG_CLIENT_RECEIVER_HPP
@@ -0,0 +1,79 @@
+/**
+ * @file record.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_RECORD_HPP
+#define __CPP_SYSLOG_CLIENT_RECORD_HPP
+
+#include "level.hpp"
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Per message state, kept by each thread separately
+     */
+    struct Record;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::Record {
+    bool              hasLvl{false}; ///< log severity level was set for this message
+    LogLvlMng::LogLvl lvl{LogLvlMng::LL_DEBUG}; ///< log severity level of this message
+    PooledString      params; ///< serialized SD-PARAMs of this message
+
+    /**
+     * Ctor
+     */
+    Record() = default;
+
+    /**
+     * Ctor
+     *
+     * @param[in] level log severity level of this message
+     */
+    explicit Record(LogLvlMng::LogLvl level) : hasLvl{true}, lvl{level}, params{} {}
+
+    /**
+     * Forget everything set for the sent message
+     * 
+     * @warning Params buffer keeps its capacity for the next message
+     */
+    void reset() noexcept { 
+        hasLvl = false; 
+        params.clear();
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_RECORD_HPP
@@ -0,0 +1,270 @@
+/**
+ * @file retrier.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_RETRIER_HPP
+#define __CPP_SYSLOG_CLIENT_RETRIER_HPP
+
+#if defined(WIN32)
+ #include <winsock2.h>
+#else
+ #include <poll.h>
+ #include <sys/socket.h>
+ #include <netinet/in.h>
+#endif // WIN32
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+#include "metrics.hpp"
+#include "client_int.hpp"
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Background thread retrying once datagrams refused by a full kernel queue
+     */
+    class Retrier;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::Retrier final {
+private:
+    /**
+     * Refused datagram
+     */
+    struct Item {
+        PooledString buf; ///< data
+        sockaddr_in to; ///< destination
+    };
+private:
+    static constexpr std::size_t DEFAULT_CAPACITY{1024}; ///< default
+    static constexpr int         RETRY_TIMEOUT_MS{10}; ///< max wait for the socket to become writable
+    static constexpr int         SHUTDOWN_DRAIN_MS{100}; ///< max time to retry pending datagrams on stop
+private:
+    int32_t                               m_Sock; ///< socket handler
+    std::size_t                           m_Capacity; ///< max number of pending datagrams
+    std::shared_ptr<SendCounters>         m_Counters; ///< data sender counters
+    std::deque<Item, PoolAllocator<Item>> m_Queue; ///< pending datagrams
+    std::mutex                            m_Mtx; ///< guards queue and stop flag
+    std::condition_variable               m_Cond; ///< wakes worker up
+    bool                                  m_Stop; ///< worker should exit
+    std::thread                           m_Worker; ///< background thread
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] sock socket handler
+     * @param[in] counters data sender counters
+     * @param[in] capacity max number of pending datagrams
+     */
+    Retrier(
+        int32_t sock,
+        std::shared_ptr<SendCounters> counters,
+        std::size_t capacity = DEFAULT_CAPACITY
+    ) :
+        m_Sock{sock},
+        m_Capacity{capacity},
+        m_Counters{std::move(counters)},
+        m_Stop{false},
+        m_Worker{&Retrier::run, this} {
+    }
+
+    /**
+     * Copy ctor
+     */
+    Retrier(const Retrier&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Retrier& operator=(const Retrier&) = delete;
+
+    /**
+     * Dtor
+     *
+     * @warning Pending datagrams are retried for SHUTDOWN_DRAIN_MS at most, the rest are dropped
+     */
+    ~Retrier() {
+        {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            m_Stop = true;
+        }
+        m_Cond.notify_one();
+        m_Worker.join();
+    }
+
+    /**
+     * Queue datagram for retry
+     *
+     * @param[in] buf data
+     * @param[in] size data size
+     * @param[in] to destination
+     *
+     * @return false if the queue is full and datagram was dropped
+     *
+     * @warning Never waits for the socket, only for the short queue critical section
+     */
+    bool push(const char* buf, std::size_t size, const sockaddr_in& to) noexcept {
+        Segment seg{buf, size};
+        return push(&seg, 1, to);
+    }
+
+    /**
+     * Queue datagram gathered from segments for retry
+     *
+     * @param[in] segs segments
+     * @param[in] count number of segments
+     * @param[in] to destination
+     *
+     * @return false if the queue is full and datagram was dropped
+     *
+     * @warning Segments are joined, data is copied only here into a pooled buffer
+     */
+    bool push(const Segment* segs, std::size_t count, const sockaddr_in& to) noexcept {
+        try {
+            std::size_t size{0};
+            for (std::size_t i = 0; i < count; ++i)
+                size += segs[i].size;
+
+            PooledString buf;
+            buf.reserve(size);
+            for (std::size_t i = 0; i < count; ++i)
+                buf.append(segs[i].data, segs[i].size);
+
+            std::unique_lock<std::mutex> lock{m_Mtx};
+            if (m_Queue.size() >= m_Capacity)
+                return false;
+
+            m_Queue.push_back(Item{std::move(buf), to});
+            m_Counters->setQueueDepth(m_Queue.size());
+        }
+        catch (...) {
+            return false;
+        }
+
+        m_Cond.notify_one();
+        return true;
+    }
+private:
+    /**
+     * Worker loop
+     */
+    void run() noexcept {
+        using Clock = std::chrono::steady_clock;
+
+        std::unique_lock<std::mutex> lock{m_Mtx};
+        Clock::time_point deadline{};
+        for (;;) {
+            m_Cond.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+            if (m_Queue.empty())
+                return; // stopped and drained
+
+            auto timeout{RETRY_TIMEOUT_MS};
+            if (m_Stop) {
+                auto now{Clock::now()};
+                if (Clock::time_point{} == deadline)
+                    deadline = now + std::chrono::milliseconds{static_cast<std::chrono::milliseconds::rep>(SHUTDOWN_DRAIN_MS)};
+                if (now >= deadline) {
+                    dropAll();
+                    return;
+                }
+
+                auto left{std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()};
+                timeout = static_cast<int>(std::min<decltype(left)>(timeout, left));
+            }
+
+            auto item{std::move(m_Queue.front())};
+            m_Queue.pop_front();
+            m_Counters->setQueueDepth(m_Queue.size());
+
+            lock.unlock();
+            retry(item, timeout);
+            lock.lock();
+        }
+    }
+
+    /**
+     * Count pending datagrams as dropped
+     *
+     * @warning Called under m_Mtx
+     */
+    void dropAll() noexcept {
+        for (std::size_t i = 0; i < m_Queue.size(); ++i)
+            m_Counters->incDropped();
+
+        m_Queue.clear();
+        m_Counters->setQueueDepth(0);
+    }
+
+    /**
+     * Wait for the socket to become writable and send datagram once more
+     *
+     * @param[in] item refused datagram
+     * @param[in] timeout max wait for the socket, ms
+     */
+    void retry(const Item& item, int timeout) noexcept {
+#if defined(WIN32)
+        WSAPOLLFD fd{static_cast<SOCKET>(m_Sock), POLLWRNORM, 0};
+        WSAPoll(&fd, 1, timeout);
+#else
+        pollfd fd{m_Sock, POLLOUT, 0};
+        poll(&fd, 1, timeout);
+#endif // WIN32
+
+        auto res{
+            sendto(
+                m_Sock,
+                item.buf.c_str(),
+                item.buf.size(),
+                0,
+                (const sockaddr*)&item.to,
+                sizeof(item.to)
+            )
+        };
+
+        if (res < 0)
+            m_Counters->incDropped();
+        else
+            m_Counters->incRetried(item.buf.size());
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_RETRIER_HPP
@@ -0,0 +1,389 @@
+/**
+ * @file scan.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_SCAN_HPP
+#define __CPP_SYSLOG_CLIENT_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+ #define CPP_SYSLOG_CLIENT_HAS_SSE2 1
+ #include <emmintrin.h>
+#endif
+#if defined(CPP_SYSLOG_CLIENT_HAS_SSE2) && defined(__GNUC__)
+ #define CPP_SYSLOG_CLIENT_HAS_AVX2 1 // compiled for the target attribute, taken only if CPU has it
+ #include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+ #include <intrin.h>
+#endif
+
+#include "conv.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage text scanning kernels
+     */
+    class ScanMng;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Scanning functions of one instruction set
+     */
+    struct ScanKernels;
+
+    /**
+     * Get kernels of instruction set
+     *
+     * @param[in] kind instruction set, falls back to a narrower one unsupported by compiler or CPU
+     */
+    inline const ScanKernels& scanKernels(int kind) noexcept;
+
+    /**
+     * Get kernels of the widest instruction set supported by CPU, chosen on first call
+     */
+    inline const ScanKernels& scanKernels() noexcept;
+
+    /**
+     * Get length of a valid UTF-8 sequence
+     *
+     * @param[in] data sequence start
+     * @param[in] size bytes available
+     *
+     * @return 1 to 4, 0 for a malformed, overlong, surrogate, out of range or truncated sequence
+     *
+     * @link https://datatracker.ietf.org/doc/html/rfc3629#section-4
+     */
+    inline std::size_t utf8SeqLen(const char* data, std::size_t size) noexcept;
+
+    /**
+     * Find the first byte syslog::details::appendSanitized() changes
+     *
+     * @param[in] data text
+     * @param[in] size text size
+     *
+     * @return Offset of it, size if text is clean
+     */
+    inline std::size_t findDirty(const char* data, std::size_t size) noexcept;
+
+    /**
+     * Append text with control chars replaced by ScanMng::CONTROL_REPLACEMENT and malformed UTF-8 
+     * by ScanMng::UTF8_REPLACEMENT, clean spans are copied in bulk
+     *
+     * @param[in,out] out output
+     * @param[in] data text
+     * @param[in] size text size
+     */
+    template<class A>
+    void appendSanitized(BasicString<A>& out, const char* data, std::size_t size);
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::ScanMng final {
+public:
+    /**
+     * Instruction sets
+     */
+    enum ScanKernel {
+        SK_SCALAR = 0, ///< byte by byte
+        SK_SSE2, ///< 16 bytes at once
+        SK_AVX2 ///< 32 bytes at once
+    };
+
+    static constexpr char              CONTROL_REPLACEMENT{' '}; ///< control chars are sent as it
+    static constexpr const char *const UTF8_REPLACEMENT{"\xEF\xBF\xBD"}; ///< U+FFFD, malformed UTF-8 is sent as it
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::ScanKernels {
+    using Find = std::size_t (*)(const char*, std::size_t); ///< offset of the first matching byte, size if none
+
+    ScanMng::ScanKernel kind; ///< instruction set
+    Find                findSDSpecial; ///< '"', '\\' or ']', escaped in SD-PARAM values
+    Find                findNonPrintable; ///< control chars (0x00-0x1F, 0x7F) and non-ASCII bytes
+};
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Get index of the lowest set bit, mask must not be 0
+     */
+    inline unsigned lowestBit(uint32_t mask) noexcept {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward(&idx, mask);
+        return static_cast<unsigned>(idx);
+#else
+        return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+    }
+
+    inline bool isSDSpecial(char ch) noexcept { return '"' == ch || '\\' == ch || ']' == ch; }
+
+    inline bool isNonPrintable(char ch) noexcept {
+        auto uch{static_cast<unsigned char>(ch)};
+        return uch < 0x20 || uch >= 0x7F;
+    }
+
+    inline std::size_t findSDSpecialScalar(const char* data, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (isSDSpecial(data[i]))
+                return i;
+        }
+        return size;
+    }
+
+    inline std::size_t findNonPrintableScalar(const char* data, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (isNonPrintable(data[i]))
+                return i;
+        }
+        return size;
+    }
+
+#if defined(CPP_SYSLOG_CLIENT_HAS_SSE2)
+    inline std::size_t findSDSpecialSSE2(const char* data, std::size_t size) {
+        const __m128i quote{_mm_set1_epi8('"')};
+        const __m128i slash{_mm_set1_epi8('\\')};
+        const __m128i bracket{_mm_set1_epi8(']')};
+
+        std::size_t i{0};
+        for (; i + 16 <= size; i += 16) {
+            auto v{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))};
+            auto hit{_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, slash)), _mm_cmpeq_epi8(v, bracket))};
+            auto mask{static_cast<uint32_t>(_mm_movemask_epi8(hit))};
+            if (mask)
+                return i + lowestBit(mask);
+        }
+
+        return i + findSDSpecialScalar(data + i, size - i);
+    }
+
+    inline std::size_t findNonPrintableSSE2(const char* data, std::size_t size) {
+        const __m128i space{_mm_set1_epi8(0x20)};
+        const __m128i del{_mm_set1_epi8(0x7F)};
+
+        std::size_t i{0};
+        for (; i + 16 <= size; i += 16) {
+            auto v{_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))};
+            // signed compare: bytes 0x80-0xFF are negative, so below 0x20 too
+            auto hit{_mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, del))};
+            auto mask{static_cast<uint32_t>(_mm_movemask_epi8(hit))};
+            if (mask)
+                return i + lowestBit(mask);
+        }
+
+        return i + findNonPrintableScalar(data + i, size - i);
+    }
+#endif // CPP_SYSLOG_CLIENT_HAS_SSE2
+
+#if defined(CPP_SYSLOG_CLIENT_HAS_AVX2)
+    __attribute__((target("avx2")))
+    inline std::size_t findSDSpecialAVX2(const char* data, std::size_t size) {
+        const __m256i quote{_mm256_set1_epi8('"')};
+        const __m256i slash{_mm256_set1_epi8('\\')};
+        const __m256i bracket{_mm256_set1_epi8(']')};
+
+        std::size_t i{0};
+        for (; i + 32 <= size; i += 32) {
+            auto v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))};
+            auto hit{_mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, slash)), 
+                _mm256_cmpeq_epi8(v, bracket)
+            )};
+            auto mask{static_cast<uint32_t>(_mm256_movemask_epi8(hit))};
+            if (mask)
+                return i + lowestBit(mask);
+        }
+
+        return i + findSDSpecialSSE2(data + i, size - i);
+    }
+
+    __attribute__((target("avx2")))
+    inline std::size_t findNonPrintableAVX2(const char* data, std::size_t size) {
+        const __m256i space{_mm256_set1_epi8(0x20)};
+        const __m256i del{_mm256_set1_epi8(0x7F)};
+
+        std::size_t i{0};
+        for (; i + 32 <= size; i += 32) {
+            auto v{_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))};
+            // signed compare: bytes 0x80-0xFF are negative, so below 0x20 too
+            auto hit{_mm256_or_si256(_mm256_cmpgt_epi8(space, v), _mm256_cmpeq_epi8(v, del))};
+            auto mask{static_cast<uint32_t>(_mm256_movemask_epi8(hit))};
+            if (mask)
+                return i + lowestBit(mask);
+        }
+
+        return i + findNonPrintableSSE2(data + i, size - i);
+    }
+#endif // CPP_SYSLOG_CLIENT_HAS_AVX2
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline const syslog::details::ScanKernels& syslog::details::scanKernels(int kind) noexcept {
+    static const ScanKernels SCALAR{ScanMng::SK_SCALAR, findSDSpecialScalar, findNonPrintableScalar};
+#if defined(CPP_SYSLOG_CLIENT_HAS_SSE2)
+    static const ScanKernels SSE2{ScanMng::SK_SSE2, findSDSpecialSSE2, findNonPrintableSSE2};
+#endif
+#if defined(CPP_SYSLOG_CLIENT_HAS_AVX2)
+    static const ScanKernels AVX2{ScanMng::SK_AVX2, findSDSpecialAVX2, findNonPrintableAVX2};
+    static const bool hasAVX2{[]() {
+        __builtin_cpu_init();
+        return 0 != __builtin_cpu_supports("avx2");
+    }()};
+
+    if (ScanMng::SK_AVX2 <= kind && hasAVX2)
+        return AVX2;
+#endif
+#if defined(CPP_SYSLOG_CLIENT_HAS_SSE2)
+    if (ScanMng::SK_SSE2 <= kind)
+        return SSE2;
+#endif
+    return SCALAR;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline const syslog::details::ScanKernels& syslog::details::scanKernels() noexcept {
+    static const ScanKernels& best{scanKernels(ScanMng::SK_AVX2)};
+    return best;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline std::size_t syslog::details::utf8SeqLen(const char* data, std::size_t size) noexcept {
+    if (!size)
+        return 0;
+
+    auto b0{static_cast<unsigned char>(data[0])};
+    if (b0 < 0x80)
+        return 1;
+
+    std::size_t len{0};
+    unsigned char lo{0x80};
+    unsigned char hi{0xBF};
+    if (b0 >= 0xC2 && b0 <= 0xDF) {
+        len = 2;
+    }
+    else if (b0 >= 0xE0 && b0 <= 0xEF) {
+        len = 3;
+        if (0xE0 == b0)
+            lo = 0xA0; // overlong
+        else if (0xED == b0)
+            hi = 0x9F; // surrogates
+    }
+    else if (b0 >= 0xF0 && b0 <= 0xF4) {
+        len = 4;
+        if (0xF0 == b0)
+            lo = 0x90; // overlong
+        else if (0xF4 == b0)
+            hi = 0x8F; // above U+10FFFF
+    }
+    else {
+        return 0;
+    }
+
+    if (size < len)
+        return 0;
+
+    auto b1{static_cast<unsigned char>(data[1])};
+    if (b1 < lo || b1 > hi)
+        return 0;
+    for (std::size_t i = 2; i < len; ++i) {
+        if (0x80 != (static_cast<unsigned char>(data[i]) & 0xC0))
+            return 0;
+    }
+
+    return len;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+inline std::size_t syslog::details::findDirty(const char* data, std::size_t size) noexcept {
+    const auto& kernels{scanKernels()};
+    std::size_t pos{0};
+    for (;;) {
+        pos += kernels.findNonPrintable(data + pos, size - pos);
+        if (pos >= size || static_cast<unsigned char>(data[pos]) < 0x80)
+            return pos; // clean or control char
+
+        auto len{utf8SeqLen(data + pos, size - pos)};
+        if (!len)
+            return pos;
+        pos += len;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class A>
+void syslog::details::appendSanitized(BasicString<A>& out, const char* data, std::size_t size) {
+    std::size_t pos{0};
+    while (pos < size) {
+        auto dirty{pos + findDirty(data + pos, size - pos)};
+        out.append(data + pos, dirty - pos);
+        if (dirty >= size)
+            return;
+
+        auto uch{static_cast<unsigned char>(data[dirty])};
+        if (uch < 0x80) {
+            out += ScanMng::CONTROL_REPLACEMENT;
+        }
+        else {
+            out += ScanMng::UTF8_REPLACEMENT;
+            // skip the rest of the broken sequence
+            while (dirty + 1 < size && 0x80 == (static_cast<unsigned char>(data[dirty + 1]) & 0xC0))
+                ++dirty;
+        }
+        pos = dirty + 1;
+    }
+}
+
+#endif // __CPP_SYSLOG_CLIENT_SCAN_HPP
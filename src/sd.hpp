@@ -0,0 +1,212 @@
+/**
+ * @file sd.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_SD_HPP
+#define __CPP_SYSLOG_CLIENT_SD_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "conv.hpp"
+#include "scan.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage structured data
+     * 
+     * @link https://datatracker.ietf.org/doc/html/rfc5424#section-6.3
+     */
+    class SDMng;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Structured data parameter of a single message
+     *
+     * @tparam T value type, integers, floating point numbers, chars and strings
+     */
+    template<class T>
+    struct KV {
+        const char* key; ///< SD-PARAM name
+        const T&    value; ///< SD-PARAM value
+    };
+};
+
+    /**
+     * Make structured data parameter of the message being composed
+     *
+     * @param[in] key SD-PARAM name
+     * @param[in] value SD-PARAM value, integers, floating point numbers, chars and strings
+     *
+     * @warning Value is referenced until the message is written to stream
+     */
+    template<class T>
+    details::KV<T> kv(const char* key, const T& value) noexcept { return details::KV<T>{key, value}; }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::SDMng final {
+public:
+    /**
+     * SD-ID of the element grouping formatter flags and message parameters
+     *
+     * @link https://datatracker.ietf.org/doc/html/rfc5612 32473 is the enterprise number reserved for documentation
+     *
+     * @warning Set your own one with setSDId(), telemetry, thread sequence and continuation elements take its
+     * enterprise number
+     */
+    static constexpr const char *const DEFAULT_SD_ID{"cpp-syslog@32473"};
+
+    static constexpr std::size_t MAX_NAME_SIZE{32}; ///< max SD-ID and SD-PARAM name size
+};
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Append SD-NAME, chars not allowed by RFC 5424 are replaced with '_'
+     *
+     * @param[in,out] out output
+     * @param[in] name name
+     * @param[in] size name size
+     * @param[in] max max name size
+     */
+    template<class A>
+    void appendSDName(
+        BasicString<A>& out,
+        const char* name,
+        std::size_t size,
+        std::size_t max
+    ) 
+    {
+        if (size > max)
+            size = max;
+
+        for (std::size_t i = 0; i < size; ++i) {
+            auto ch{static_cast<unsigned char>(name[i])};
+            // PRINTUSASCII except '=', SP, ']', '"'
+            auto valid{ch >= 33 && ch <= 126 && '=' != ch && ']' != ch && '"' != ch};
+            out += valid ? name[i] : '_';
+        }
+    }
+
+    /**
+     * Escape PARAM-VALUE written to the end of output in place
+     *
+     * @param[in,out] out output
+     * @param[in] from value offset in output
+     */
+    template<class A>
+    void escapeSDValue(
+        BasicString<A>& out,
+        std::size_t from
+    )
+    {
+        const auto& kernels{scanKernels()};
+        auto src{out.size()};
+        auto first{from + kernels.findSDSpecial(out.data() + from, src - from)};
+        if (first == src)
+            return;
+
+        std::size_t special{0};
+        for (auto i = first; i < src; i += 1 + kernels.findSDSpecial(out.data() + i + 1, src - i - 1))
+            ++special;
+
+        out.resize(src + special);
+        for (auto dst = out.size(); src > first; ) {
+            auto ch{out[--src]};
+            out[--dst] = ch;
+            if ('"' == ch || '\\' == ch || ']' == ch)
+                out[--dst] = '\\';
+        }
+    }
+
+    /**
+     * Append SD-PARAM, i.e. SP name="value"
+     *
+     * @param[in,out] out output
+     * @param[in] name SD-PARAM name
+     * @param[in] size name size
+     * @param[in] value SD-PARAM value
+     */
+    template<class A, class T>
+    void appendSDParam(
+        BasicString<A>& out,
+        const char* name,
+        std::size_t size,
+        const T& value
+    )
+    {
+        out += ' ';
+        appendSDName(out, name, size, SDMng::MAX_NAME_SIZE);
+        out += "=\"";
+        auto from{out.size()};
+        appendArg(out, value);
+        escapeSDValue(out, from);
+        out += '"';
+    }
+
+    /**
+     * Append SD-ID of an element of the client, made of its name and enterprise number of another SD-ID
+     *
+     * @param[in,out] out output
+     * @param[in] name element name
+     * @param[in] base SD-ID the enterprise number is taken from, syslog::SDMng::DEFAULT_SD_ID one if it has none
+     */
+    template<class A>
+    void appendRelatedSDId(
+        BasicString<A>& out,
+        const char* name,
+        const std::string& base
+    )
+    {
+        auto at{base.find('@')};
+        out.append(name);
+        if (std::string::npos != at) {
+            out.append(base.data() + at, base.size() - at);
+        }
+        else {
+            const char* pen{std::strchr(SDMng::DEFAULT_SD_ID, '@')};
+            out.append(pen);
+        }
+    }
+};};
+
+#endif // __CPP_SYSLOG_CLIENT_SD_HPP
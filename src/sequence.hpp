@@ -0,0 +1,165 @@
+/**
+ * @file sequence.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_SEQUENCE_HPP
+#define __CPP_SYSLOG_CLIENT_SEQUENCE_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <string>
+
+#include "local.hpp"
+#include "conv.hpp"
+#include "buf_pool.hpp"
+#include "sd.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage message sequence numbers
+     */
+    class SequenceMng;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Sequence counter of a thread
+     */
+    struct ThreadSeq;
+
+    /**
+     * Numbers records of a client as a whole and of each sending thread
+     */
+    class Sequencer;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::SequenceMng final {
+public:
+    static constexpr const char *const META_SD_ID{"meta"}; ///< SD-ID of element with client sequence number
+    static constexpr const char *const THREAD_SD_NAME{"cpp-syslog-seq"}; ///< name of thread sequence element SD-ID, enterprise number is the one of SD-ID
+    static constexpr uint32_t          MAX_SEQUENCE_ID{2147483647}; ///< sequenceId wraps to 1 after it
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct syslog::details::ThreadSeq {
+    uint32_t thread{0}; ///< thread number within client, from 1, 0 until first record
+    uint64_t seq{0}; ///< records sent by the thread
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::Sequencer final {
+private:
+    std::atomic<bool>     m_On; ///< records are numbered
+    std::atomic<uint64_t> m_Next; ///< records numbered so far
+    std::atomic<uint32_t> m_Threads; ///< threads numbered so far
+    InstanceId            m_Id; ///< instance ID, keys per thread counters
+public:
+    /**
+     * Ctor
+     */
+    Sequencer() : m_On{false}, m_Next{0}, m_Threads{0}, m_Id{} {}
+
+    /**
+     * Copy ctor
+     */
+    Sequencer(const Sequencer&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Sequencer& operator=(const Sequencer&) = delete;
+
+    /**
+     * Turn numbering on or off
+     */
+    void setOn(bool on) noexcept { m_On.store(on, std::memory_order_relaxed); }
+
+    /**
+     * Getter
+     */
+    bool isOn() const noexcept { return m_On.load(std::memory_order_relaxed); }
+
+    /**
+     * Number next record and render its elements
+     *
+     * [meta sequenceId="N"][cpp-syslog-seq@<enterprise number> thread="T" seq="M"], where N counts records of the
+     * client, T is the calling thread number and M counts records sent by the thread, so receiver tells loss from
+     * reordering
+     *
+     * @param[out] out elements
+     * @param[in] base SD-ID the enterprise number is taken from
+     *
+     * @warning Records sent by different threads take client numbers in any order relative to wire order
+     */
+    void render(PooledString& out, const std::string& base) {
+        auto id{toSequenceId(m_Next.fetch_add(1, std::memory_order_relaxed))};
+
+        auto& local{threadLocal<ThreadSeq, Sequencer>(m_Id.get())};
+        if (!local.thread)
+            local.thread = m_Threads.fetch_add(1, std::memory_order_relaxed) + 1;
+        ++local.seq;
+
+        out.clear();
+        out += '[';
+        out += SequenceMng::META_SD_ID;
+        out += " sequenceId=\"";
+        appendDec(out, id);
+        out += "\"][";
+        appendRelatedSDId(out, SequenceMng::THREAD_SD_NAME, base);
+        out += " thread=\"";
+        appendDec(out, local.thread);
+        out += "\" seq=\"";
+        appendDec(out, local.seq);
+        out += "\"]";
+    }
+
+    /**
+     * Get sequenceId of record
+     *
+     * @param[in] n number of records before it
+     *
+     * @return 1 to SequenceMng::MAX_SEQUENCE_ID, wrapped
+     *
+     * @link https://datatracker.ietf.org/doc/html/rfc5424#section-7.3.1
+     */
+    static uint32_t toSequenceId(uint64_t n) noexcept { 
+        return static_cast<uint32_t>(n % SequenceMng::MAX_SEQUENCE_ID) + 1; 
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_SEQUENCE_HPP
@@ -0,0 +1,291 @@
+/**
+ * @file snapshot.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_SNAPSHOT_HPP
+#define __CPP_SYSLOG_CLIENT_SNAPSHOT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "local.hpp"
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Immutable object published atomically (RCU style)
+     *
+     * @tparam T object type
+     */
+    template<class T>
+    class Snapshot;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class T>
+class syslog::details::Snapshot final {
+public:
+    /**
+     * Pins current object while alive
+     */
+    class Reader;
+private:
+    /**
+     * Replaced object
+     */
+    struct Retired {
+        const T*      ptr; ///< object
+        std::uint64_t epoch; ///< epoch it was replaced in
+    };
+
+    /**
+     * Reader state of one thread
+     */
+    struct Slot {
+        static constexpr std::size_t CACHE_LINE{64}; ///< keeps slots of different threads apart
+
+        alignas(CACHE_LINE) std::atomic<std::uint64_t> epoch; ///< epoch seen by the outermost reader, 0 if none
+        std::size_t                                    depth; ///< nested readers, owner thread only
+
+        Slot() : epoch{0}, depth{0} {}
+    };
+
+    using Slots = std::vector<std::shared_ptr<Slot>>; ///< slots list
+private:
+    std::atomic<const T*>      m_Cur; ///< current object
+    std::atomic<std::uint64_t> m_Epoch; ///< advanced by each update, starts from 1
+    InstanceId                 m_Id; ///< instance ID, keys per thread slots
+    mutable Slots              m_Slots; ///< slots of all threads, registered by readers
+    mutable std::mutex         m_SlotsMtx; ///< guards slots list
+    mutable std::mutex         m_WriteMtx; ///< serialises writers
+    std::vector<Retired>       m_Retired; ///< replaced objects waiting for grace period
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] init initial object
+     */
+    explicit Snapshot(T&& init) : m_Cur{new T{std::move(init)}}, m_Epoch{1}, m_Id{} {}
+
+    /**
+     * Copy ctor
+     */
+    Snapshot(const Snapshot&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    /**
+     * Dtor
+     */
+    ~Snapshot() {
+        delete m_Cur.load();
+        for (const auto& retired : m_Retired)
+            delete retired.ptr;
+    }
+
+    /**
+     * Pin and get current object
+     *
+     * @warning Lock-free except for the first call of each thread, never waits for writers. 
+     * Reader is kept by the thread which made it
+     */
+    Reader read() const { return Reader{*this}; }
+
+    /**
+     * Publish a modified copy of current object
+     *
+     * @param[in] f modifier called with the copy
+     *
+     * @warning Writers are serialised, readers aren't blocked
+     * @warning Replaced objects are freed by this or a later update once the threads that could see them have 
+     * released their readers, a thread holding a reader keeps every object replaced since it was made
+     */
+    template<class F>
+    void update(F&& f) {
+        std::lock_guard<std::mutex> lock{m_WriteMtx};
+
+        auto next{new T{*m_Cur.load()}};
+        try {
+            f(*next);
+            m_Retired.reserve(m_Retired.size() + 1);
+        }
+        catch (...) {
+            delete next;
+            throw;
+        }
+
+        auto prev{m_Cur.exchange(next)};
+        // readers announcing a later epoch see the new object
+        m_Retired.push_back(Retired{prev, m_Epoch.fetch_add(1)});
+        reclaim();
+    }
+
+    /**
+     * Getter
+     *
+     * @return Replaced objects not freed yet
+     */
+    std::size_t getRetired() const {
+        std::lock_guard<std::mutex> lock{m_WriteMtx};
+        return m_Retired.size();
+    }
+private:
+    /**
+     * Get calling thread slot, register it on first call
+     */
+    Slot& slot() const {
+        auto& local{threadLocal<std::shared_ptr<Slot>, Snapshot>(m_Id.get())};
+        if (!local) {
+            auto created{makePooled<Slot>()}; // its own cache line
+
+            std::lock_guard<std::mutex> lock{m_SlotsMtx};
+            m_Slots.push_back(created);
+            local = std::move(created);
+        }
+
+        return *local;
+    }
+
+    /**
+     * Free replaced objects no reader can see
+     *
+     * @warning Called by writer only. An object replaced in epoch E may be pinned by readers announced E or less
+     */
+    void reclaim() {
+        auto oldest{std::numeric_limits<std::uint64_t>::max()};
+        {
+            std::lock_guard<std::mutex> lock{m_SlotsMtx};
+            // slots of exited threads are idle and owned by the list only
+            m_Slots.erase(
+                std::remove_if(m_Slots.begin(), m_Slots.end(), [](const std::shared_ptr<Slot>& slot) { 
+                    return 1 == slot.use_count(); 
+                }),
+                m_Slots.end()
+            );
+
+            for (const auto& slot : m_Slots) {
+                auto epoch{slot->epoch.load()};
+                if (epoch && epoch < oldest)
+                    oldest = epoch;
+            }
+        }
+
+        auto kept{m_Retired.begin()};
+        for (auto it = m_Retired.begin(); it != m_Retired.end(); ++it) {
+            if (it->epoch < oldest)
+                delete it->ptr;
+            else
+                *kept++ = *it;
+        }
+        m_Retired.erase(kept, m_Retired.end());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class T>
+class syslog::details::Snapshot<T>::Reader final {
+private:
+    Slot*    m_Slot; ///< calling thread slot
+    const T* m_Ptr; ///< pinned object
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] owner snapshot
+     *
+     * @warning Announcing epoch is a store into the calling thread own cache line, ordered before reading 
+     * current object, so no shared line is written
+     */
+    explicit Reader(const Snapshot& owner) : m_Slot{&owner.slot()} {
+        // sequentially consistent store and load, so writer either sees the epoch or reader sees the new object
+        if (0 == m_Slot->depth++)
+            m_Slot->epoch.store(owner.m_Epoch.load(std::memory_order_acquire), std::memory_order_seq_cst);
+        m_Ptr = owner.m_Cur.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * Copy ctor
+     */
+    Reader(const Reader&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Reader& operator=(const Reader&) = delete;
+
+    /**
+     * Move ctor
+     */
+    Reader(Reader&& other) noexcept : m_Slot{other.m_Slot}, m_Ptr{other.m_Ptr} { other.m_Slot = nullptr; }
+
+    /**
+     * Move assignment operator
+     */
+    Reader& operator=(Reader&& other) noexcept {
+        if (this != &other) {
+            release();
+            m_Slot = other.m_Slot;
+            m_Ptr = other.m_Ptr;
+            other.m_Slot = nullptr;
+        }
+        return *this;
+    }
+
+    /**
+     * Dtor
+     */
+    ~Reader() { release(); }
+
+    const T& operator*() const noexcept { return *m_Ptr; }
+
+    const T* operator->() const noexcept { return m_Ptr; }
+private:
+    void release() noexcept {
+        if (m_Slot && 0 == --m_Slot->depth)
+            m_Slot->epoch.store(0, std::memory_order_release);
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_SNAPSHOT_HPP
@@ -0,0 +1,218 @@
+/**
+ * @file spsc_ring.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_SPSC_RING_HPP
+#define __CPP_SYSLOG_CLIENT_SPSC_RING_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <memory>
+
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Single producer single consumer ring of variable size records
+     */
+    class SpscRing;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::SpscRing final {
+private:
+    static constexpr std::size_t ALIGN{8}; ///< records alignment
+    static constexpr std::size_t HDR_SIZE{ALIGN}; ///< record header, keeps payload aligned
+    static constexpr uint32_t    PAD{0xFFFFFFFF}; ///< header of unused space at the end of ring
+    static constexpr std::size_t CACHE_LINE{64}; ///< keeps producer and consumer positions apart
+private:
+    char*                                       m_Data; ///< records, taken from message buffers pool
+    std::size_t                                 m_Mask; ///< capacity - 1
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_Head; ///< consumer position
+    std::size_t                                 m_CachedTail; ///< consumer copy of producer position
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_Tail; ///< producer position
+    std::size_t                                 m_CachedHead; ///< producer copy of consumer position
+    std::size_t                                 m_Reserved; ///< producer position after reserved record
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] capacity ring size in bytes, rounded up to power of 2
+     */
+    explicit SpscRing(
+        std::size_t capacity
+    ) :
+        m_Data{nullptr},
+        m_Mask{roundUp(capacity) - 1},
+        m_Head{0},
+        m_CachedTail{0},
+        m_Tail{0},
+        m_CachedHead{0},
+        m_Reserved{0}
+    {
+        m_Data = static_cast<char*>(BufPool::instance().allocate(m_Mask + 1));
+    }
+
+    /**
+     * Dtor
+     */
+    ~SpscRing() { BufPool::instance().deallocate(m_Data, m_Mask + 1); }
+
+    /**
+     * Copy ctor
+     */
+    SpscRing(const SpscRing&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * Get ring size in bytes
+     */
+    std::size_t capacity() const noexcept { return m_Mask + 1; }
+
+    /**
+     * Get number of bytes used by records
+     */
+    std::size_t size() const noexcept { 
+        return m_Tail.load(std::memory_order_acquire) - m_Head.load(std::memory_order_acquire); 
+    }
+
+    /**
+     * Reserve space for a record
+     *
+     * @param[in] size record size
+     *
+     * @return nullptr if ring is full
+     *
+     * @warning Producer only, record becomes visible by commit()
+     */
+    char* reserve(std::size_t size) noexcept {
+        auto total{align(HDR_SIZE + size)};
+        auto tail{m_Tail.load(std::memory_order_relaxed)};
+        auto pos{tail & m_Mask};
+        auto pad{(m_Mask + 1 - pos) < total ? m_Mask + 1 - pos : 0}; // record never wraps
+
+        if (total + pad > capacity())
+            return nullptr;
+
+        if (tail + pad + total - m_CachedHead > capacity()) {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail + pad + total - m_CachedHead > capacity())
+                return nullptr;
+        }
+
+        if (pad) {
+            writeHdr(pos, PAD);
+            tail += pad;
+            pos = 0;
+        }
+
+        writeHdr(pos, static_cast<uint32_t>(size));
+        m_Reserved = tail + total;
+
+        return m_Data + pos + HDR_SIZE;
+    }
+
+    /**
+     * Publish reserved record
+     *
+     * @warning Producer only
+     */
+    void commit() noexcept { m_Tail.store(m_Reserved, std::memory_order_release); }
+
+    /**
+     * Get the oldest record
+     *
+     * @param[out] size record size
+     *
+     * @return nullptr if ring is empty
+     *
+     * @warning Consumer only, record stays in ring until release()
+     */
+    const char* front(std::size_t& size) noexcept {
+        for (;;) {
+            auto head{m_Head.load(std::memory_order_relaxed)};
+            if (head == m_CachedTail) {
+                m_CachedTail = m_Tail.load(std::memory_order_acquire);
+                if (head == m_CachedTail)
+                    return nullptr;
+            }
+
+            auto pos{head & m_Mask};
+            auto hdr{readHdr(pos)};
+            if (PAD == hdr) {
+                m_Head.store(head + m_Mask + 1 - pos, std::memory_order_release);
+                continue;
+            }
+
+            size = hdr;
+            return m_Data + pos + HDR_SIZE;
+        }
+    }
+
+    /**
+     * Drop the oldest record
+     *
+     * @param[in] size record size returned by front()
+     *
+     * @warning Consumer only
+     */
+    void release(std::size_t size) noexcept {
+        m_Head.store(m_Head.load(std::memory_order_relaxed) + align(HDR_SIZE + size), std::memory_order_release);
+    }
+private:
+    static std::size_t align(std::size_t size) noexcept { return (size + ALIGN - 1) & ~(ALIGN - 1); }
+
+    static std::size_t roundUp(std::size_t size) noexcept {
+        std::size_t res{ALIGN * 2};
+        while (res < size)
+            res <<= 1;
+        return res;
+    }
+
+    void writeHdr(std::size_t pos, uint32_t hdr) noexcept { std::memcpy(m_Data + pos, &hdr, sizeof(hdr)); }
+
+    uint32_t readHdr(std::size_t pos) const noexcept {
+        uint32_t hdr;
+        std::memcpy(&hdr, m_Data + pos, sizeof(hdr));
+        return hdr;
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_SPSC_RING_HPP
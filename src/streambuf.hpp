@@ -32,14 +32,29 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <locale>
 
 #include "level.hpp"
 #include "facility.hpp"
+#include "msg_size.hpp"
+#include "sd.hpp"
 #include "client_int.hpp"
 #include "tmode.hpp"
 #include "fmt_int.hpp"
 #include "basic_fmt_impl.hpp"
-#include "make_tmpl.hpp"
+#include "hex.hpp"
+#include "config.hpp"
+#include "snapshot.hpp"
+#include "record.hpp"
+#include "local.hpp"
+#include "format.hpp"
+#include "deferred.hpp"
+#include "metrics.hpp"
+#include "telemetry.hpp"
+#include "sequence.hpp"
+#include "scan.hpp"
 
 /**
  * Lib space
@@ -51,90 +66,184 @@ namespace syslog {
 namespace details {
     /**
      * Stream buffer
+     *
+     * @tparam Mode thread policy, syslog::details::<TMode|st|mt|mt_prof|spin|lf>
      */
-    class streambuf;
+    template<class Mode>
+    class basic_streambuf;
+
+    /**
+     * Stream buffer choosing thread policy at runtime
+     */
+    using streambuf = basic_streambuf<TMode>;
 };};
 
 ////////////////////////////////////////////////////////////////////////////
 ///
 //
-class syslog::details::streambuf final : public std::streambuf {
+template<class Mode>
+class syslog::details::basic_streambuf final : public std::streambuf {
 private:
-    std::string                              m_Buf; ///< data to send
-    LogLvlMng::LogLvl                        m_Lvl; ///< log severity level
-    LogFacilityMng::LogFacility              m_Facility; ///< log facility
-    std::unique_ptr<details::IClient>        m_Clnt; ///< data sender
-    std::unique_ptr<details::TMode>          m_Mode; ///< <single|multi> thread
-    std::vector<std::shared_ptr<IFormatter>> m_Formatters; ///< formatter flags
+    std::mutex                                 m_TelemetryMtx; ///< guards m_Telemetry
+    std::unique_ptr<details::Telemetry>        m_Telemetry; ///< self-telemetry thread, created when enabled
+    std::atomic<details::Deferred*>            m_Deferred; ///< background renderer, created on first deferred message
+    PooledString                               m_Buf; ///< data to send, if threads share it
+    std::unique_ptr<details::IClient>          m_Clnt; ///< data sender
+    std::unique_ptr<Mode>                      m_Mode; ///< thread policy
+    std::unique_ptr<details::Snapshot<Config>> m_Config; ///< level, facility, formatters, etc.
+    std::unique_ptr<details::MsgCounters>      m_Metrics; ///< message counters and stage latencies
+    std::unique_ptr<details::Sequencer>        m_Sequencer; ///< record numbering
+    details::InstanceId                        m_Id; ///< instance ID, keys per thread records
+    bool                                       m_ClassicLoc; ///< imbued locale formats numbers as "C" one
+    bool                                       m_ProfLocks; ///< thread policy times lock sites, see enter()
 public:
     /**
      * Ctor
      */
-    streambuf(
+    basic_streambuf(
         std::unique_ptr<details::IClient>&& clnt,
-        std::unique_ptr<details::TMode>&& mode
+        std::unique_ptr<Mode>&& mode
     ) : 
-        m_Lvl{LogLvlMng::LogLvl::LL_DEBUG},
-        m_Facility{LogFacilityMng::LogFacility::LF_LOCAL7},
+        m_TelemetryMtx{},
+        m_Telemetry{},
+        m_Deferred{nullptr},
         m_Clnt{std::move(clnt)},
         m_Mode{std::move(mode)},
-        m_Formatters{std::make_shared<details::PIDFormatter>()} {
+        m_Config{std::make_unique<details::Snapshot<Config>>(defaultConfig())},
+        m_Metrics{std::make_unique<details::MsgCounters>()},
+        m_Sequencer{std::make_unique<details::Sequencer>()},
+        m_Id{},
+        m_ClassicLoc{std::locale{} == std::locale::classic()},
+        m_ProfLocks{m_Mode && m_Mode->profilesLocks()} {
     }
 
     /**
      * Copy ctor
      */
-    streambuf(const streambuf&) = delete;
+    basic_streambuf(const basic_streambuf&) = delete;
 
     /**
      * Copy assignment operator
      */
-    streambuf &operator=(const streambuf&) = delete;
+    basic_streambuf &operator=(const basic_streambuf&) = delete;
 
     /**
      * Move ctor
+     *
+     * @warning Deferred messages of the other buffer are sent before it's moved
+     * @warning Self-telemetry of the other buffer is stopped, enable it on the new one
      */
-    streambuf(
-        streambuf&& other
+    basic_streambuf(
+        basic_streambuf&& other
     ) noexcept :
+        m_TelemetryMtx{},
+        m_Telemetry{other.stopTelemetry()},
+        m_Deferred{other.stopDeferred()},
         m_Buf{std::move(other.m_Buf)},
-        m_Lvl{other.m_Lvl},
-        m_Facility{other.m_Facility},
         m_Clnt{std::move(other.m_Clnt)},
         m_Mode{std::move(other.m_Mode)},
-        m_Formatters{std::move(other.m_Formatters)} {
+        m_Config{std::move(other.m_Config)},
+        m_Metrics{std::move(other.m_Metrics)},
+        m_Sequencer{std::move(other.m_Sequencer)},
+        m_Id{std::move(other.m_Id)},
+        m_ClassicLoc{other.m_ClassicLoc},
+        m_ProfLocks{other.m_ProfLocks} {
     }
 
     /**
      * Move assignment operator
+     *
+     * @warning Deferred messages of both buffers are sent before the other one is moved
+     * @warning Self-telemetry of both buffers is stopped
      */
-    streambuf& operator=(streambuf&& other) noexcept {
+    basic_streambuf& operator=(basic_streambuf&& other) noexcept {
         // self-assignment check
         if (&other == this)
             return *this;
 
+        stopTelemetry();
+        other.stopTelemetry();
+        stopDeferred();
+        other.stopDeferred();
+
         m_Buf = std::move(other.m_Buf);
-        m_Lvl = other.m_Lvl;
-        m_Facility = other.m_Facility;
         m_Clnt = std::move(other.m_Clnt);
         m_Mode = std::move(other.m_Mode);
-        m_Formatters = std::move(other.m_Formatters);
+        m_Config = std::move(other.m_Config);
+        m_Metrics = std::move(other.m_Metrics);
+        m_Sequencer = std::move(other.m_Sequencer);
+        m_Id = std::move(other.m_Id);
+        m_ClassicLoc = other.m_ClassicLoc;
+        m_ProfLocks = other.m_ProfLocks;
 
         return *this;
     }
 
+    /**
+     * Dtor
+     *
+     * @warning Deferred messages are sent before the buffer is destroyed
+     */
+    ~basic_streambuf() { 
+        stopTelemetry();
+        stopDeferred(); 
+    }
+
     /**
      * Setter
      *
-     * @param[in] lvl log severity level
+     * @param[in] lvl default log severity level
      *
      * @warning By default, log severity level is syslog::LogLvlMng::LogLvl::LL_DEBUG
-     * @warning Lock zone
+     * @warning Publishes new configuration snapshot
      */
-    void setLvl(LogLvlMng::LogLvl lvl) noexcept { 
-        m_Mode->lock();
-        m_Lvl = lvl; 
-        m_Mode->unlock();
+    void setLvl(LogLvlMng::LogLvl lvl) { 
+        m_Config->update([&](Config& config) { config.lvl = lvl; });
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] lvl log severity level of the message being composed by calling thread
+     *
+     * @warning Applies to the next message only, then default one is used
+     * @warning Lock free, state is kept by each thread separately
+     */
+    void setRecordLvl(LogLvlMng::LogLvl lvl) noexcept { 
+        auto& rec{record()};
+        rec.hasLvl = true;
+        rec.lvl = lvl;
+    }
+
+    /**
+     * Add structured data parameter to the message being composed by calling thread
+     *
+     * @param[in] key SD-PARAM name
+     * @param[in] value SD-PARAM value
+     *
+     * @warning Applies to the next message only
+     * @warning Lock free, written right into calling thread own buffer with RFC 5424 escaping
+     */
+    template<class T>
+    void addRecordParam(const char* key, const T& value) {
+        details::appendSDParam(record().params, key, key ? std::char_traits<char>::length(key) : 0, value);
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] sdId SD-ID of the element grouping formatter flags and message parameters
+     *
+     * @warning By default, SD-ID is syslog::SDMng::DEFAULT_SD_ID
+     * @warning Publishes new configuration snapshot
+     */
+    void setSDId(const std::string& sdId) { 
+        std::string valid;
+        details::appendSDName(valid, sdId.data(), sdId.size(), SDMng::MAX_NAME_SIZE);
+        if (valid.empty())
+            valid = SDMng::DEFAULT_SD_ID;
+
+        m_Config->update([&](Config& config) { config.sdId = std::move(valid); });
     }
 
     /**
@@ -143,11 +252,50 @@ public:
      * @param[in] facility log facility
      *
      * @warning By default, log facility is syslog::LogFacilityMng::LogFacility::LF_LOCAL7
+     * @warning Publishes new configuration snapshot
+     */
+    void setFacility(LogFacilityMng::LogFacility facility) { 
+        m_Config->update([&](Config& config) { 
+            config.facility = facility; 
+            config.cachePri();
+        });
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] policy oversized messages policy
+     *
+     * @warning By default, oversized messages policy is syslog::MsgSizeMng::MsgSizePolicy::MSP_TRUNCATE
+     * @warning Publishes new configuration snapshot
+     */
+    void setMsgSizePolicy(MsgSizeMng::MsgSizePolicy policy) { 
+        m_Config->update([&](Config& config) { config.sizePolicy = policy; });
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] on replace control chars and malformed UTF-8 of messages, drop trailing line feeds
+     *
+     * @warning By default, messages are sent as written
+     * @warning Publishes new configuration snapshot
+     */
+    void setSanitize(bool on) { 
+        m_Config->update([&](Config& config) { config.sanitize = on; });
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] size max message size fitting one transport unit
+     *
+     * @warning By default, it depends on transport
      * @warning Lock zone
      */
-    void setFacility(LogFacilityMng::LogFacility facility) noexcept { 
+    void setMaxMsgSize(std::size_t size) noexcept { 
         m_Mode->lock();
-        m_Facility = facility; 
+        m_Clnt->setMaxMsgSize(size);
         m_Mode->unlock();
     }
 
@@ -182,68 +330,275 @@ public:
     /**
      * Setter
      *
-     * @param[in] formatter new formatter flag
+     * @param[in] on don't block the caller when the kernel queue is full
      *
+     * @warning By default, socket is blocking
      * @warning Lock zone
      */
-    void addFormatter(std::shared_ptr<IFormatter>&& formatter) noexcept {
+    void setNonBlocking(bool on) noexcept { 
         m_Mode->lock();
-        m_Formatters.emplace_back(std::move(formatter));
+        m_Clnt->setNonBlocking(on); 
         m_Mode->unlock(); 
     }
 
     /**
-     * Remove all formatter flags
-     * 
+     * Setter
+     *
+     * @param[in] size socket send buffer size (SO_SNDBUF) in bytes
+     *
+     * @warning By default, system wide value is used
      * @warning Lock zone
      */
-    void cleanFormatters() noexcept {
+    void setSndBuf(int32_t size) noexcept { 
         m_Mode->lock();
-        m_Formatters.clear();
+        m_Clnt->setSndBuf(size); 
         m_Mode->unlock(); 
     }
+
+    /**
+     * Setter
+     *
+     * @param[in] on retry refused data once from a background thread
+     *
+     * @warning By default, refused data is dropped
+     * @warning Lock zone
+     */
+    void setRetry(bool on) noexcept { 
+        m_Mode->lock();
+        m_Clnt->setRetry(on); 
+        m_Mode->unlock(); 
+    }
+
+    /**
+     * Getter
+     *
+     * @return Data sender counters snapshot
+     */
+    SendStats getStats() const noexcept { return m_Clnt->getStats(); }
+
+    /**
+     * Getter
+     *
+     * @return Metrics snapshot, counters of all threads summed up
+     *
+     * @warning Takes short locks of shard lists, writers are never blocked
+     */
+    Metrics getMetrics() const {
+        Metrics metrics{};
+        m_Clnt->collectMetrics(metrics);
+        m_Metrics->collect(metrics);
+
+        auto cur{m_Deferred.load(std::memory_order_acquire)};
+        if (cur)
+            metrics.deferredDropped = cur->getDropped();
+
+        return metrics;
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] on measure format, lock wait and send latencies
+     *
+     * @warning By default, latencies are not measured
+     */
+    void setLatencyMetrics(bool on) noexcept { m_Metrics->setTiming(on); }
+
+    /**
+     * Setter
+     *
+     * @param[in] period seconds between self-telemetry records, 0 stops them
+     *
+     * @warning By default, self-telemetry is off
+     * @warning Records are made from metrics snapshots by a background thread, producers are never stopped
+     */
+    void setTelemetryPeriod(uint32_t period) noexcept {
+        std::unique_ptr<details::Telemetry> created;
+        if (period) {
+            try {
+                created.reset(
+                    new details::Telemetry{
+                        period,
+                        [this]() { return getMetrics(); },
+                        [this](const PooledString& elem) { emitTelemetry(elem); }
+                    }
+                );
+            }
+            catch (...) {
+                // no thread, no telemetry
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{m_TelemetryMtx};
+            m_Telemetry.swap(created);
+        }
+        // previous thread is joined unlocked, sendTelemetry() can't reach it anymore
+    }
+
+    /**
+     * Send self-telemetry record now, without waiting for the period
+     *
+     * @return false if self-telemetry is off
+     */
+    bool sendTelemetry() noexcept {
+        std::lock_guard<std::mutex> lock{m_TelemetryMtx};
+        if (!m_Telemetry)
+            return false;
+
+        m_Telemetry->tick();
+        return true;
+    }
+
+    /**
+     * Setter
+     *
+     * @param[in] on number records with RFC 5424 meta sequenceId of the client and a sequence number of the sending thread
+     *
+     * @warning By default, records are not numbered
+     */
+    void setSequence(bool on) noexcept { m_Sequencer->setOn(on); }
+
+    /**
+     * Getter
+     *
+     * @return Lock wait and hold times per acquisition site, empty unless thread policy is syslog::details::mt_prof
+     */
+    LockProfile getLockProfile() const { return m_Mode->getLockProfile(); }
+
+    /**
+     * Setter
+     *
+     * @param[in] formatter new formatter flag
+     *
+     * @warning Publishes new configuration snapshot
+     */
+    void addFormatter(std::shared_ptr<IFormatter>&& formatter) {
+        m_Config->update([&](Config& config) { config.formatters.emplace_back(std::move(formatter)); });
+    }
+
+    /**
+     * Remove all formatter flags
+     * 
+     * @warning Publishes new configuration snapshot
+     */
+    void cleanFormatters() {
+        m_Config->update([](Config& config) { config.formatters.clear(); });
+    }
+    /**
+     * Format message and send it to syslog server, bypassing stream
+     *
+     * @param[in] lvl log severity level
+     * @param[in] fmt format string made by SYSLOG_FMT()
+     * @param[in] args arguments
+     *
+     * @warning Lock free, message is formatted in calling thread own buffer
+     */
+    template<class Fmt, class... Args>
+    void log(LogLvlMng::LogLvl lvl, Fmt fmt, const Args&... args) {
+        auto start{m_Metrics->now()};
+        auto& body{scratch()};
+        body.clear();
+        formatTo(body, fmt, args...);
+
+        emit(Record{lvl}, body, start);
+        enter(LockSiteMng::LS_ASSEMBLY); // stream message of calling thread may be in progress
+    }
+
+    /**
+     * Copy message format and raw arguments to be formatted and sent by a background thread
+     *
+     * @param[in] lvl log severity level
+     * @param[in] fmt format string made by SYSLOG_FMT()
+     * @param[in] args arguments
+     *
+     * @return false if calling thread ring is full and message was dropped
+     *
+     * @warning Lock free, background thread is started on first call
+     */
+    template<class Fmt, class... Args>
+    bool defer(LogLvlMng::LogLvl lvl, Fmt fmt, const Args&... args) {
+        return deferred().push(lvl, fmt, args...);
+    }
+
+    /**
+     * Append value as text to the message being composed, bypassing locale and num_put
+     *
+     * @param[in] val integer, floating point number, char or string
+     *
+     * @warning Output matches "C" locale with default format flags only, see isClassicLocale()
+     * @warning On each call, capturing a recursive mutex, released at once if message is still empty
+     */
+    template<class T>
+    void append(const T& val) {
+        lockRec();
+        appendArg(buf(), val);
+        if (buf().empty())
+            m_Mode->unlockRec(); // empty value, sync() releases lock of non-empty message only
+    }
+
+    /**
+     * Imbued locale formats numbers as "C" one?
+     */
+    bool isClassicLocale() const noexcept { return m_ClassicLoc; }
+
+    /**
+     * Wait until deferred messages pushed so far are sent
+     */
+    void drainDeferred() {
+        auto cur{m_Deferred.load(std::memory_order_acquire)};
+        if (cur)
+            cur->drain();
+    }
 protected:
     /**
      * Send data to syslog server
      * 
      * @warning Unlock recursive mutex
+     * @warning Configuration is read from snapshot, data sender must be thread-safe, so no locks are taken
      */
     int sync() override {
-        if (!m_Buf.empty()) {
-            m_Mode->lock();
-            auto ready{m_Clnt->isInitialised()};
-            m_Mode->unlock();
-
-            if (ready) {
-                m_Mode->lock();
-                // https://datatracker.ietf.org/doc/html/rfc5424#section-6.2.1
-                auto pri{"<" + std::to_string((m_Facility << 3) + m_Lvl) + ">"};
-                m_Mode->unlock();
-
-                std::string data{pri};
-                data += " ";
-
-                m_Mode->lock();
-                for (const auto& formatter : m_Formatters) {
-                    data += details::makeTmpl(formatter->key(), formatter->value());
-                    data += " ";
-                }
-                m_Mode->unlock();
-
-                data += m_Buf;
-
-                m_Mode->lock();
-                m_Clnt->send(std::move(data));
-                m_Mode->unlock();
-            }
+        auto& body{buf()};
+        auto& rec{record()};
+        if (!body.empty()) {
+            emit(rec, body);
 
-            m_Buf.erase();
+            body.erase();
             m_Mode->unlockRec();
         }
 
+        rec.reset();
         return 0;
     }
 
+    /**
+     * Append data in bulk
+     *
+     * @param[in] s data
+     * @param[in] n data size
+     *
+     * @warning On each call, capturing a recursive mutex
+     */
+    std::streamsize xsputn(
+        const char_type* s, 
+        std::streamsize n
+    ) override 
+    {
+        if (n <= 0)
+            return 0;
+
+        lockRec();
+        buf().append(s, static_cast<std::size_t>(n));
+        return n;
+    }
+
+    /**
+     * Remember whether new locale formats numbers as "C" one
+     *
+     * @param[in] loc locale
+     */
+    void imbue(const std::locale& loc) override { m_ClassicLoc = loc == std::locale::classic(); }
+
     /**
      * Increment data char-by-char and send it to syslog server by EOF
      *
@@ -259,12 +614,391 @@ protected:
             sync(); // its time to send data to syslog server
         }
         else {
-            m_Mode->lockRec();
-            m_Buf += static_cast<char>(ch);
+            lockRec();
+            buf() += static_cast<char>(ch);
         }
 
         return ch;
     }
+private:
+    /**
+     * Get initial configuration
+     */
+    static Config defaultConfig() {
+        Config config{
+            LogLvlMng::LogLvl::LL_DEBUG,
+            LogFacilityMng::LogFacility::LF_LOCAL7,
+            MsgSizeMng::MsgSizePolicy::MSP_TRUNCATE,
+            false,
+            {std::make_shared<details::PIDFormatter>()},
+            SDMng::DEFAULT_SD_ID,
+            {}
+        };
+        config.cachePri();
+
+        return config;
+    }
+
+    /**
+     * Capture recursive mutex guarding the message being composed
+     *
+     * @warning Wait is measured by the first insertion of a message only, when latencies are measured
+     */
+    void lockRec() {
+        if (!m_Metrics->isTiming()) {
+            m_Mode->lockRec();
+            return;
+        }
+
+        auto start{details::nowNs()};
+        m_Mode->lockRec();
+        if (buf().empty())
+            m_Metrics->local().lockWait.record(details::nowNs() - start);
+    }
+
+    /**
+     * Mark code section for lock profiling
+     *
+     * @param[in] site code section
+     *
+     * @warning Thread policy is called only if it profiles locks, so others pay a predictable branch, not a virtual call
+     */
+    void enter(LockSiteMng::LockSite site) noexcept {
+        if (m_ProfLocks)
+            m_Mode->enter(site);
+    }
+
+    /**
+     * Make message header and send it with message to syslog server
+     *
+     * @param[in] rec message state
+     * @param[in] body message
+     * @param[in] start timestamp of message rendering start, 0 if it's not measured by caller
+     * @param[in] elements structured data elements following the one of formatters, if any
+     */
+    void emit(const Record& rec, const PooledString& body, uint64_t start = 0, const PooledString* elements = nullptr) {
+        if (!m_Clnt->isInitialised())
+            return;
+
+        auto timing{m_Metrics->isTiming()};
+        if (timing && !start)
+            start = details::nowNs();
+
+        enter(LockSiteMng::LS_HEADER);
+
+        auto config{m_Config->read()};
+        auto maxSize{m_Clnt->getMaxMsgSize()};
+        auto lvl{rec.hasLvl ? rec.lvl : config->lvl};
+
+        auto& data{header()};
+        const auto& pri{config->pri[lvl & 7]};
+        data.assign(pri.data(), pri.size());
+        enter(LockSiteMng::LS_FORMATTERS);
+        appendSD(data, *config, rec.params);
+        if (elements)
+            appendElements(data, *elements);
+        if (m_Sequencer->isOn()) {
+            auto& seq{sequence()};
+            m_Sequencer->render(seq, config->sdId);
+            appendElements(data, seq);
+        }
+        enter(LockSiteMng::LS_SEND);
+
+        Segment text{body.data(), body.size()};
+        if (config->sanitize)
+            text = sanitize(text);
+
+        auto& shard{m_Metrics->local()};
+        uint64_t rendered{0};
+        if (timing) {
+            rendered = details::nowNs();
+            shard.format.record(rendered - start);
+        }
+
+        if (MsgSizeMng::MSP_NONE == config->sizePolicy || data.size() + text.size <= maxSize) {
+            Segment segs[] = {{data.data(), data.size()}, text};
+            m_Clnt->send(segs, 2);
+        }
+        else if (MsgSizeMng::MSP_SPLIT != config->sizePolicy || !sendSplit(data, *config, text, maxSize)) {
+            sendTruncated(data, text, maxSize);
+        }
+
+        shard.messages[lvl & 7].add();
+        if (timing)
+            shard.sending.record(details::nowNs() - rendered);
+    }
+
+    /**
+     * Get calling thread buffer for message headers
+     *
+     * @warning Message body is never copied into it, header and body are sent as separate segments
+     */
+    static PooledString& header() noexcept {
+        thread_local PooledString buf;
+        return buf;
+    }
+
+    /**
+     * Replace control chars and malformed UTF-8 of message
+     *
+     * @param[in] text message
+     *
+     * @return Message itself if it's clean, else its copy in a buffer of calling thread
+     */
+    static Segment sanitize(Segment text) {
+        while (text.size && ('\n' == text.data[text.size - 1] || '\r' == text.data[text.size - 1]))
+            --text.size; // std::endl
+
+        if (details::findDirty(text.data, text.size) == text.size)
+            return text;
+
+        thread_local PooledString clean;
+        clean.clear();
+        details::appendSanitized(clean, text.data, text.size);
+        return Segment{clean.data(), clean.size()};
+    }
+
+    /**
+     * Get calling thread buffer for sequence elements
+     */
+    static PooledString& sequence() noexcept {
+        thread_local PooledString buf;
+        return buf;
+    }
+
+    /**
+     * Append structured data element with formatter flags and message parameters
+     *
+     * @param[in,out] data message header
+     * @param[in] config configuration
+     * @param[in] params serialized SD-PARAMs of the message
+     *
+     * @warning Nothing is appended if there are no parameters
+     */
+    static void appendSD(PooledString& data, const Config& config, const PooledString& params) {
+        auto begin{data.size()};
+        data += '[';
+        data.append(config.sdId.data(), config.sdId.size());
+        auto empty{data.size()};
+
+        for (const auto& formatter : config.formatters) {
+            auto key{formatter->key()};
+            auto value{formatter->value()};
+            if (!key.empty() && !value.empty())
+                details::appendSDParam(data, key.data(), key.size(), value);
+        }
+        data += params;
+
+        if (empty == data.size()) {
+            data.resize(begin);
+            return;
+        }
+
+        data += "] ";
+    }
+
+    /**
+     * Append structured data elements right after the one of formatters
+     *
+     * @param[in,out] data message header
+     * @param[in] elements serialized SD-ELEMENTs
+     */
+    static void appendElements(PooledString& data, const PooledString& elements) {
+        if (elements.empty())
+            return;
+
+        auto size{data.size()};
+        if (size >= 2 && ']' == data[size - 2] && ' ' == data[size - 1])
+            data.pop_back(); // elements are not separated
+
+        data += elements;
+        data += ' ';
+    }
+
+    /**
+     * Send self-telemetry record
+     *
+     * @param[in] params telemetry element SD-PARAMs
+     *
+     * @warning Called by self-telemetry thread and sendTelemetry()
+     */
+    void emitTelemetry(const PooledString& params) {
+        PooledString elem;
+        elem += '[';
+        {
+            auto config{m_Config->read()};
+            details::appendRelatedSDId(elem, TelemetryMng::SD_NAME, config->sdId);
+        }
+        elem += params;
+        elem += ']';
+
+        auto& body{scratch()};
+        body.assign(TelemetryMng::MSG);
+        emit(Record{LogLvlMng::LL_INFO}, body, 0, &elem);
+    }
+
+    /**
+     * Stop self-telemetry thread
+     *
+     * @return nullptr
+     */
+    details::Telemetry* stopTelemetry() noexcept {
+        std::unique_ptr<details::Telemetry> stopped;
+        {
+            std::lock_guard<std::mutex> lock{m_TelemetryMtx};
+            m_Telemetry.swap(stopped);
+        }
+        return nullptr;
+    }
+
+    /**
+     * Get background renderer, start it if needed
+     */
+    details::Deferred& deferred() {
+        auto cur{m_Deferred.load(std::memory_order_acquire)};
+        if (cur)
+            return *cur;
+
+        std::unique_ptr<details::Deferred> created{
+            new details::Deferred{
+                [this](LogLvlMng::LogLvl lvl, const PooledString& body) { emit(Record{lvl}, body); }
+            }
+        };
+
+        if (!m_Deferred.compare_exchange_strong(cur, created.get(), std::memory_order_acq_rel))
+            return *cur; // another thread was first
+
+        return *created.release();
+    }
+
+    /**
+     * Send deferred messages and stop background renderer
+     *
+     * @return nullptr
+     */
+    details::Deferred* stopDeferred() noexcept {
+        delete m_Deferred.exchange(nullptr, std::memory_order_acq_rel);
+        return nullptr;
+    }
+
+    /**
+     * Get calling thread buffer for formatted messages
+     */
+    static PooledString& scratch() noexcept {
+        thread_local PooledString buf;
+        return buf;
+    }
+
+    /**
+     * Get message buffer of calling thread
+     */
+    PooledString& buf() noexcept {
+        auto local{m_Mode->localBuf()};
+        return local ? *local : m_Buf;
+    }
+
+    /**
+     * Get message state of calling thread
+     */
+    Record& record() noexcept { return threadLocal<Record>(m_Id.get()); }
+
+    /**
+     * Send as much of the message as fits max message size and the truncation marker
+     *
+     * @param[in] data message header
+     * @param[in] body message
+     * @param[in] maxSize max message size
+     */
+    void sendTruncated(const PooledString& data, const Segment& body, std::size_t maxSize) {
+        std::size_t markerSize{std::char_traits<char>::length(MsgSizeMng::TRUNCATION_MARKER)};
+
+        if (data.size() + markerSize >= maxSize) {
+            // even header doesn't fit
+            Segment seg{data.data(), details::utf8Cut(data.data(), data.size(), maxSize)};
+            m_Clnt->send(&seg, 1);
+            return;
+        }
+
+        auto room{maxSize - data.size() - markerSize};
+        Segment segs[] = {
+            {data.data(), data.size()},
+            {body.data, details::utf8Cut(body.data, body.size, room)},
+            {MsgSizeMng::TRUNCATION_MARKER, markerSize}
+        };
+        m_Clnt->send(segs, 3);
+    }
+
+    /**
+     * Send the message as continuation records sharing a correlation ID
+     *
+     * @param[in] header message header
+     * @param[in] config configuration, its SD-ID gives enterprise number of correlation element
+     * @param[in] body message
+     * @param[in] maxSize max message size
+     *
+     * @return false if even a tiny part of the message doesn't fit max message size
+     *
+     * @warning Each record carries [cid@<enterprise number> id="<hex>" part="<n>" total="<total>"] 
+     * after the other structured data elements
+     */
+    bool sendSplit(const PooledString& header, const Config& config, const Segment& body, std::size_t maxSize) {
+        static constexpr std::size_t MIN_PART_SIZE{4}; ///< longest UTF-8 sequence
+
+        auto id{details::int2hex(details::nextCorrelationId())};
+        auto& elem{continuation()};
+        auto mark = [&](std::size_t seq, std::size_t total) {
+            elem.assign(1, '[');
+            details::appendRelatedSDId(elem, MsgSizeMng::CORRELATION_KEY, config.sdId);
+            details::appendSDParam(elem, "id", 2, id);
+            details::appendSDParam(elem, "part", 4, seq);
+            details::appendSDParam(elem, "total", 5, total);
+            elem += "] ";
+            return Segment{elem.data(), elem.size()};
+        };
+
+        // correlation element follows the others with no space between
+        auto size{header.size()};
+        if (size >= 2 && ']' == header[size - 2] && ' ' == header[size - 1])
+            --size;
+
+        // chunks count can't exceed message size, so it bounds the sequence field
+        auto overhead{mark(body.size, body.size).size};
+
+        if (size + overhead + MIN_PART_SIZE > maxSize)
+            return false;
+
+        auto room{maxSize - size - overhead};
+        auto next = [&](std::size_t off) {
+            auto len{details::utf8Cut(body.data + off, body.size - off, room)};
+            return 0 == len ? room : len; // malformed UTF-8, cut anywhere
+        };
+
+        std::size_t total{0};
+        for (std::size_t off = 0; off < body.size; off += next(off))
+            ++total;
+
+        std::size_t seq{0};
+        for (std::size_t off = 0, len = 0; off < body.size; off += len) {
+            len = next(off);
+
+            Segment segs[] = {
+                {header.data(), size},
+                mark(++seq, total),
+                {body.data + off, len}
+            };
+            m_Clnt->send(segs, 3);
+        }
+
+        return true;
+    }
+
+    /**
+     * Get calling thread buffer for correlation elements of continuation records
+     */
+    static PooledString& continuation() noexcept {
+        thread_local PooledString buf;
+        return buf;
+    }
 };
 
 #endif // __CPP_SYSLOG_CLIENT_STREAMBUF_HPP
\ No newline at end of file
@@ -0,0 +1,231 @@
+/**
+ * @file telemetry.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_TELEMETRY_HPP
+#define __CPP_SYSLOG_CLIENT_TELEMETRY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+
+#include "metrics.hpp"
+#include "sd.hpp"
+#include "buf_pool.hpp"
+
+/**
+ * Lib space
+ */
+namespace syslog {
+    /**
+     * Class for manage self-telemetry records
+     */
+    class TelemetryMng;
+
+/**
+ * Details
+ */
+namespace details {
+    /**
+     * Background thread emitting client metrics as structured data records
+     */
+    class Telemetry;
+};};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::TelemetryMng final {
+public:
+    static constexpr const char *const SD_NAME{"cpp-syslog-stats"}; ///< name of telemetry element SD-ID, enterprise number is the one of SD-ID
+    static constexpr const char *const MSG{"client telemetry"}; ///< message of telemetry record
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::Telemetry final {
+public:
+    using Collect = std::function<Metrics()>; ///< takes metrics snapshot
+    using Sink = std::function<void(const PooledString&)>; ///< sends record made of telemetry element SD-PARAMs
+private:
+    uint32_t                m_Period; ///< seconds between records
+    Collect                 m_Collect; ///< metrics source
+    Sink                    m_Sink; ///< record sender
+    uint64_t                m_LastMsgs; ///< messages counted by previous record
+    uint64_t                m_LastTime; ///< time of previous record, ns
+    uint64_t                m_Records; ///< telemetry records sent so far
+    std::mutex              m_TickMtx; ///< serialises records of worker and tick() callers
+    std::mutex              m_Mtx; ///< guards stop flag
+    std::condition_variable m_Cond; ///< wakes worker up
+    bool                    m_Stop; ///< worker should exit
+    std::thread             m_Worker; ///< background thread
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] period seconds between records
+     * @param[in] collect metrics source, called under m_TickMtx by any thread calling tick()
+     * @param[in] sink record sender, called under m_TickMtx by any thread calling tick()
+     */
+    Telemetry(
+        uint32_t period,
+        Collect collect,
+        Sink sink
+    ) :
+        m_Period{period},
+        m_Collect{std::move(collect)},
+        m_Sink{std::move(sink)},
+        m_LastMsgs{0},
+        m_LastTime{nowNs()},
+        m_Records{0},
+        m_Stop{false},
+        m_Worker{&Telemetry::run, this} {
+    }
+
+    /**
+     * Copy ctor
+     */
+    Telemetry(const Telemetry&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    /**
+     * Dtor
+     *
+     * @warning Waits for the record being sent, if any
+     */
+    ~Telemetry() {
+        {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            m_Stop = true;
+        }
+        m_Cond.notify_one();
+        m_Worker.join();
+    }
+
+    /**
+     * Getter
+     *
+     * @return Seconds between records
+     */
+    uint32_t getPeriod() const noexcept { return m_Period; }
+
+    /**
+     * Make SD-PARAMs of telemetry element
+     *
+     * @param[in,out] out output
+     * @param[in] metrics metrics snapshot
+     * @param[in] rate messages per second since previous record, telemetry records excluded
+     * @param[in] records telemetry records counted by the snapshot
+     *
+     * @warning Sink wraps them into element, its SD-ID follows the configured one
+     */
+    static void render(PooledString& out, const Metrics& metrics, uint64_t rate, uint64_t records) {
+        param(out, "rate", rate);
+        param(out, "msgs", userMsgs(metrics, records));
+        param(out, "records", records);
+        param(out, "sent", metrics.send.sent);
+        param(out, "bytes", metrics.bytes);
+        param(out, "dropped", metrics.send.dropped + metrics.deferredDropped);
+        param(out, "again", metrics.send.again);
+        param(out, "errors", metrics.send.errors);
+        param(out, "qmax", metrics.queueHighWater);
+    }
+    /**
+     * Take metrics snapshot and send it now
+     *
+     * @warning Producers are never stopped, counters are read as they go
+     * @warning Called by the worker every period, other threads may call it too
+     */
+    void tick() noexcept {
+        try {
+            std::lock_guard<std::mutex> lock{m_TickMtx};
+            auto metrics{m_Collect()};
+            auto msgs{userMsgs(metrics, m_Records)};
+
+            auto now{nowNs()};
+            auto elapsed{now > m_LastTime ? now - m_LastTime : 1};
+            auto rate{static_cast<uint64_t>(static_cast<double>(msgs - m_LastMsgs) * 1e9 / static_cast<double>(elapsed) + 0.5)};
+            m_LastMsgs = msgs;
+            m_LastTime = now;
+
+            PooledString elem;
+            render(elem, metrics, rate, m_Records);
+            m_Sink(elem);
+            ++m_Records; // sink returned, so the record is counted by the next snapshot
+        }
+        catch (...) {
+            // record is lost, keep the worker alive
+        }
+    }
+private:
+    /**
+     * Count messages of the client, not telemetry records
+     *
+     * @param[in] metrics metrics snapshot
+     * @param[in] records telemetry records counted by the snapshot
+     */
+    static uint64_t userMsgs(const Metrics& metrics, uint64_t records) noexcept {
+        uint64_t msgs{0};
+        for (auto n : metrics.messages)
+            msgs += n;
+
+        return msgs > records ? msgs - records : 0;
+    }
+
+    /**
+     * Append SD-PARAM
+     *
+     * @param[in,out] out output
+     * @param[in] name SD-PARAM name
+     * @param[in] value SD-PARAM value
+     */
+    static void param(PooledString& out, const char* name, uint64_t value) {
+        appendSDParam(out, name, std::char_traits<char>::length(name), value);
+    }
+
+    /**
+     * Worker loop
+     */
+    void run() noexcept {
+        std::chrono::seconds::rep sec{m_Period};
+        std::unique_lock<std::mutex> lock{m_Mtx};
+        while (!m_Cond.wait_for(lock, std::chrono::seconds{sec}, [this]() { return m_Stop; })) {
+            lock.unlock();
+            tick();
+            lock.lock();
+        }
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_TELEMETRY_HPP
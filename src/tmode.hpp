@@ -29,6 +29,15 @@
 #define __CPP_SYSLOG_CLIENT_THREAD_MODE_HPP
 
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <array>
+
+#include "local.hpp"
+#include "buf_pool.hpp"
+#include "metrics.hpp"
+#include "lock_prof.hpp"
 
 /**
  * Lib space
@@ -52,6 +61,21 @@ namespace details {
      * Multi thread
      */
     class mt;
+
+    /**
+     * Multi thread recording lock wait and hold times per acquisition site
+     */
+    class mt_prof;
+
+    /**
+     * Multi thread on spinlocks
+     */
+    class spin;
+
+    /**
+     * Multi thread taking no locks on the message path: per thread buffers, one send call per message
+     */
+    class lf;
 };};
 
 ////////////////////////////////////////////////////////////////////////////
@@ -83,17 +107,47 @@ public:
      * Unlock recursive mutex
      */
     virtual void unlockRec() noexcept { }
+
+    /**
+     * Get calling thread own message buffer
+     *
+     * @return nullptr if threads share one message buffer guarded by recursive mutex
+     */
+    virtual PooledString* localBuf() noexcept { return nullptr; }
+
+    /**
+     * Mark code section entered by the thread holding recursive mutex
+     *
+     * @param[in] site code section
+     *
+     * @warning Called by data path, so policies not profiling locks must keep it empty
+     */
+    virtual void enter(LockSiteMng::LockSite /*site*/) noexcept { }
+
+    /**
+     * Getter
+     *
+     * @return true if policy times lock sites, so enter() is worth calling
+     */
+    virtual bool profilesLocks() const noexcept { return false; }
+
+    /**
+     * Getter
+     *
+     * @return Lock wait and hold times per acquisition site, empty if policy doesn't profile locks
+     */
+    virtual LockProfile getLockProfile() const { return LockProfile{}; }
 };
 
 ////////////////////////////////////////////////////////////////////////////
 ///
 //
-class syslog::details::st : public syslog::details::TMode { };
+class syslog::details::st final : public syslog::details::TMode { };
 
 ////////////////////////////////////////////////////////////////////////////
 ///
 //
-class syslog::details::mt : public syslog::details::TMode { 
+class syslog::details::mt final : public syslog::details::TMode { 
 private:
     std::mutex           m_Mtx; ///< mutex
     std::recursive_mutex m_RecMtx; ///< recursive mutex
@@ -117,10 +171,194 @@ public:
         auto copied{m_OwnershipDepth};
 
         m_OwnershipDepth = 0;
-        for (auto i = 0; i < copied; ++i)
+        for (std::size_t i = 0; i < copied; ++i)
             m_RecMtx.unlock(); 
     }
 };
 
-#endif // __CPP_SYSLOG_CLIENT_THREAD_MODE_HPP
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::mt_prof final : public syslog::details::TMode { 
+private:
+    using Hists = std::array<ShardHist, LockSiteMng::COUNT>;
+private:
+    std::mutex                   m_Mtx; ///< mutex
+    std::recursive_mutex         m_RecMtx; ///< recursive mutex
+    std::size_t                  m_OwnershipDepth; ///< for recursive mutex
+    std::atomic<std::thread::id> m_Owner; ///< thread holding recursive mutex
+    LockSiteMng::LockSite        m_Site; ///< code section of recursive mutex owner
+    uint64_t                     m_SiteSince; ///< when owner entered code section
+    uint64_t                     m_LockedSince; ///< when mutex was taken
+    Hists                        m_Wait; ///< wait per site, written under the lock waited for
+    Hists                        m_Hold; ///< hold per site, written under the lock held
+public:
+    /**
+     * Ctor
+     */
+    mt_prof() : 
+        m_OwnershipDepth{0}, 
+        m_Owner{std::thread::id{}}, 
+        m_Site{LockSiteMng::LS_ASSEMBLY}, 
+        m_SiteSince{0}, 
+        m_LockedSince{0} {
+    }
+
+    void lock() noexcept override { 
+        auto start{nowNs()};
+        m_Mtx.lock(); 
+        m_LockedSince = nowNs();
+        m_Wait[LockSiteMng::LS_CONFIG].record(m_LockedSince - start);
+    }
+
+    void unlock() noexcept override { 
+        m_Hold[LockSiteMng::LS_CONFIG].record(nowNs() - m_LockedSince);
+        m_Mtx.unlock(); 
+    }
+
+    /**
+     * Lock recursive mutex
+     *
+     * @warning Only the first acquisition of a message is timed, nested ones never wait
+     */
+    void lockRec() noexcept override { 
+        auto self{std::this_thread::get_id()};
+        if (m_Owner.load(std::memory_order_relaxed) == self) {
+            m_RecMtx.lock(); 
+            ++m_OwnershipDepth;
+            return;
+        }
+
+        auto start{nowNs()};
+        m_RecMtx.lock(); 
+        ++m_OwnershipDepth;
+        m_Owner.store(self, std::memory_order_relaxed);
+
+        m_SiteSince = nowNs();
+        m_Site = LockSiteMng::LS_ASSEMBLY;
+        m_Wait[LockSiteMng::LS_ASSEMBLY].record(m_SiteSince - start);
+    }
+
+    void unlockRec() noexcept override {
+        if (!m_OwnershipDepth)
+            return;
+
+        m_Hold[m_Site].record(nowNs() - m_SiteSince);
+        m_Owner.store(std::thread::id{}, std::memory_order_relaxed);
+
+        auto copied{m_OwnershipDepth};
+
+        m_OwnershipDepth = 0;
+        for (std::size_t i = 0; i < copied; ++i)
+            m_RecMtx.unlock(); 
+    }
+
+    /**
+     * Mark code section entered by the thread holding recursive mutex
+     *
+     * @param[in] site code section
+     *
+     * @warning Ignored for threads not holding recursive mutex, e.g. by format string API
+     */
+    void enter(LockSiteMng::LockSite site) noexcept override {
+        if (m_Owner.load(std::memory_order_relaxed) != std::this_thread::get_id())
+            return;
+
+        auto now{nowNs()};
+        m_Hold[m_Site].record(now - m_SiteSince);
+        m_Site = site;
+        m_SiteSince = now;
+    }
+
+    bool profilesLocks() const noexcept override { return true; }
+
+    /**
+     * Getter
+     *
+     * @return Lock wait and hold times per acquisition site
+     *
+     * @warning Histograms are read while writers go on, so the snapshot is not consistent as a whole
+     */
+    LockProfile getLockProfile() const override { 
+        LockProfile profile{};
+        for (std::size_t i = 0; i < LockSiteMng::COUNT; ++i) {
+            m_Wait[i].addTo(profile.wait[i]);
+            m_Hold[i].addTo(profile.hold[i]);
+        }
+
+        return profile;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::spin final : public syslog::details::TMode { 
+private:
+    std::atomic_flag             m_Flag; ///< spinlock
+    std::atomic_flag             m_RecFlag; ///< recursive spinlock
+    std::atomic<std::thread::id> m_Owner; ///< for recursive spinlock
+public:
+    /**
+     * Ctor
+     */
+    spin() : m_Flag ATOMIC_FLAG_INIT, m_RecFlag ATOMIC_FLAG_INIT, m_Owner{std::thread::id{}} {}
+
+    void lock() noexcept override { 
+        while (m_Flag.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+
+    void unlock() noexcept override { m_Flag.clear(std::memory_order_release); }
 
+    void lockRec() noexcept override { 
+        auto self{std::this_thread::get_id()};
+        if (m_Owner.load(std::memory_order_relaxed) == self)
+            return; // already owned by calling thread
+
+        while (m_RecFlag.test_and_set(std::memory_order_acquire))
+            std::this_thread::yield();
+        m_Owner.store(self, std::memory_order_relaxed);
+    }
+
+    void unlockRec() noexcept override {
+        if (m_Owner.load(std::memory_order_relaxed) != std::this_thread::get_id())
+            return;
+
+        m_Owner.store(std::thread::id{}, std::memory_order_relaxed);
+        m_RecFlag.clear(std::memory_order_release);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class syslog::details::lf final : public syslog::details::TMode { 
+private:
+    std::mutex m_Mtx; ///< serializes transport setters, never taken by the message path
+    InstanceId m_Id; ///< instance ID, keys per thread buffers
+public:
+    /**
+     * Ctor
+     */
+    lf() : m_Id{} {}
+
+    /**
+     * Lock mutex
+     *
+     * @warning Taken by transport setters only, messages are composed in per thread buffers without recursive
+     * mutex and sent by one thread-safe call, so senders never wait for each other
+     */
+    void lock() noexcept override { m_Mtx.lock(); }
+
+    void unlock() noexcept override { m_Mtx.unlock(); }
+
+    /**
+     * Get calling thread own message buffer
+     *
+     * @warning Buffer lives until calling thread exit or policy destruction
+     */
+    PooledString* localBuf() noexcept override { return &threadLocal<PooledString>(m_Id.get()); }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_THREAD_MODE_HPP
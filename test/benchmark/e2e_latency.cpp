@@ -0,0 +1,180 @@
+/**
+ * @file e2e_latency.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "syslog_client.hpp"
+#include "local_sink.hpp"
+#include "hdr_hist.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Receiver side of the harness: datagrams carry send timestamps, latencies are measured on arrival
+ */
+class E2E final {
+private:
+    static constexpr const char *const STAMP{"t="}; ///< timestamp key in message
+private:
+    HdrHist                    m_Hist; ///< latencies, written by receiving thread
+    uint64_t                   m_Bad; ///< records with no timestamp
+    std::unique_ptr<LocalSink> m_Sink; ///< receiver
+public:
+    /**
+     * Ctor
+     */
+    E2E() : 
+        m_Bad{0}, 
+        m_Sink{
+            new LocalSink{
+                LocalSink::P_UDP, 
+                false, 
+                [this](const char* data, std::size_t size, uint64_t now) { onRecord(data, size, now); }
+            }
+        } {
+    }
+
+    /**
+     * Getter
+     */
+    uint16_t getPort() const noexcept { return m_Sink->getPort(); }
+
+    /**
+     * Wait for in-flight datagrams and stop receiver
+     *
+     * @param[in] sent datagrams sent
+     *
+     * @return Datagrams lost
+     */
+    uint64_t stop(uint64_t sent) {
+        m_Sink->waitFor(sent, std::chrono::milliseconds{200});
+        auto received{m_Sink->getCount()};
+        m_Sink.reset(); // joins receiving thread, histogram may be read since now
+        return sent > received ? sent - received : 0;
+    }
+
+    /**
+     * Report percentiles into benchmark counters
+     *
+     * @param[in,out] state benchmark state
+     */
+    void report(benchmark::State& state) const {
+        state.counters["p50_ns"] = static_cast<double>(m_Hist.percentile(0.5));
+        state.counters["p99_ns"] = static_cast<double>(m_Hist.percentile(0.99));
+        state.counters["p999_ns"] = static_cast<double>(m_Hist.percentile(0.999));
+        state.counters["max_ns"] = static_cast<double>(m_Hist.getMax());
+    }
+private:
+    /**
+     * Measure latency of record
+     */
+    void onRecord(const char* data, std::size_t size, uint64_t now) {
+        std::string rec{data, size};
+        auto pos{rec.find(STAMP)};
+        if (std::string::npos == pos) {
+            ++m_Bad;
+            return;
+        }
+
+        auto sent{std::strtoull(rec.c_str() + pos + std::strlen(STAMP), nullptr, 10)};
+        m_Hist.record(now > sent ? now - sent : 0);
+    }
+};
+
+/**
+ * Latency from the start of a logging call to the datagram arrival at a loopback receiver
+ *
+ * @tparam Mode thread policy
+ * @tparam Deferred message is logged by defer(), so formatting and sending are done by a background thread
+ *
+ * @warning Producer threads share one client, thread count is the load. Deferred producers are paced at
+ * the rate given by the first argument (messages per second per thread), so the rings are not measured
+ * overloaded; the run is failed if they drop more than 1% of messages anyway
+ */
+template<class Mode, bool Deferred>
+static void BM_e2e(benchmark::State& state) {
+    static std::unique_ptr<E2E> e2e;
+    static std::unique_ptr<basic_ostream<Mode>> syslog;
+
+    if (0 == state.thread_index()) {
+        // other threads wait for the first iteration, so they see it set up
+        e2e.reset(new E2E);
+        syslog.reset(new basic_ostream<Mode>{std::make_unique<UDPClient>(), std::make_unique<Mode>()});
+        syslog->setPort(e2e->getPort());
+        syslog->setSndBuf(4 << 20);
+        syslog->cleanFormatters();
+    }
+
+    const uint64_t period{Deferred ? 1000000000ULL / static_cast<uint64_t>(state.range(0)) : 0};
+    uint64_t next{details::nowNs()};
+    for (auto _ : state) {
+        if (Deferred) {
+            next += period;
+            while (details::nowNs() < next)
+                ;
+        }
+
+        auto start{details::nowNs()};
+        if (Deferred)
+            syslog->defer(LogLvlMng::LL_INFO, SYSLOG_FMT("t={} request done"), start);
+        else
+            *syslog << "t=" << start << " request done" << std::flush;
+    }
+
+    if (0 == state.thread_index()) {
+        // other threads have left the loop too, each has made the same number of iterations
+        const auto sent{static_cast<uint64_t>(state.iterations()) * static_cast<uint64_t>(state.threads())};
+        uint64_t dropped{0};
+        if (Deferred) {
+            syslog->drainDeferred();
+            dropped = syslog->getMetrics().deferredDropped; // rings overflow, never reach the socket
+        }
+
+        state.counters["dropped"] = static_cast<double>(dropped);
+        state.counters["lost"] = static_cast<double>(e2e->stop(sent - dropped));
+        e2e->report(state);
+        syslog.reset();
+        e2e.reset();
+
+        if (dropped * 100 > sent)
+            state.SkipWithError("deferred rings overflow, lower the rate");
+    }
+}
+BENCHMARK_TEMPLATE(BM_e2e, details::st, false)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_e2e, details::mt, false)->ThreadRange(1, 4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_e2e, details::spin, false)->ThreadRange(1, 4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_e2e, details::lf, false)->ThreadRange(1, 4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_e2e, details::st, true)->Arg(10000)->Arg(100000)->ArgName("rate")->UseRealTime();
+BENCHMARK_TEMPLATE(BM_e2e, details::lf, true)->Arg(10000)->Arg(100000)->ArgName("rate")->ThreadRange(1, 4)->UseRealTime();
@@ -0,0 +1,243 @@
+/**
+ * @file hot_path.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <memory>
+
+#include "syslog_client.hpp"
+#include "hex.hpp"
+#include "make_tmpl.hpp"
+#include "basic_fmt_impl.hpp"
+#include "scan.hpp"
+#include "sd.hpp"
+#include "local_sink.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+static constexpr uint16_t DISCARD_PORT{9}; ///< nobody listens, so only the caller side is measured
+
+/**
+ * Data sender doing nothing, so only message assembly is measured
+ */
+class NullClient : public details::IClient {
+public:
+    void setAddr(const char*) noexcept override { }
+
+    void setPort(uint16_t) noexcept override { }
+
+    void setNonBlocking(bool) noexcept override { }
+
+    void setSndBuf(int32_t) noexcept override { }
+
+    void setRetry(bool) noexcept override { }
+
+    void setMaxMsgSize(std::size_t) noexcept override { }
+
+    std::size_t getMaxMsgSize() const noexcept override { return MsgSizeMng::DEFAULT_UDP_MSG_SIZE; }
+
+    int32_t getSock() const noexcept override { return 0; }
+
+    SendStats getStats() const noexcept override { return SendStats{0, 0, 0, 0, 0}; }
+
+    bool isInitialised() const noexcept override { return true; }
+
+    void send(std::string&& buf) const noexcept override { benchmark::DoNotOptimize(buf.data()); }
+
+    void send(const details::Segment* segs, std::size_t count) const noexcept override { 
+        benchmark::DoNotOptimize(segs[count - 1].data); 
+    }
+};
+
+/**
+ * Module name formatter, as users write them
+ */
+class ModuleFormatter : public IFormatter {
+public:
+    std::string key() const noexcept override { return "module"; }
+
+    std::string value() const noexcept override { return "main"; }
+};
+
+/**
+ * Message text of given size
+ *
+ * @param[in] size text size
+ */
+static std::string text(int64_t size) { return std::string(static_cast<std::size_t>(size), 'x'); }
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Process ID in hex, called by PID formatter for each message
+ */
+static void BM_int2hex(benchmark::State& state) {
+    int32_t val{0x1234};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(details::int2hex(val));
+}
+BENCHMARK(BM_int2hex);
+
+/**
+ * Legacy formatter template
+ */
+static void BM_makeTmpl(benchmark::State& state) {
+    std::string key{"module"};
+    std::string value{"main"};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(details::makeTmpl(key, value));
+}
+BENCHMARK(BM_makeTmpl);
+
+/**
+ * Scan of clean text for chars to escape and to sanitize, per instruction set
+ */
+static void BM_scan(benchmark::State& state) {
+    const auto& kernels{details::scanKernels(static_cast<int>(state.range(0)))};
+    auto msg{text(state.range(1))};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kernels.findSDSpecial(msg.data(), msg.size()));
+        benchmark::DoNotOptimize(kernels.findNonPrintable(msg.data(), msg.size()));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * msg.size() * 2));
+}
+BENCHMARK(BM_scan)->ArgsProduct({{ScanMng::SK_SCALAR, ScanMng::SK_SSE2, ScanMng::SK_AVX2}, {64, 1024}})->ArgNames({"isa", "size"});
+
+/**
+ * Escape of SD-PARAM value having one char to escape at its end
+ */
+static void BM_escapeSDValue(benchmark::State& state) {
+    auto value{text(state.range(0)) + '"'};
+    std::string out;
+    for (auto _ : state) {
+        out = value;
+        details::escapeSDValue(out, 0);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_escapeSDValue)->Arg(16)->Arg(256)->ArgName("size");
+
+/**
+ * Formatter key and value, as taken by message header build
+ *
+ * @tparam F formatter
+ */
+template<class F>
+static void BM_formatter(benchmark::State& state) {
+    std::shared_ptr<IFormatter> formatter{std::make_shared<F>()};
+    for (auto _ : state) {
+        auto key{formatter->key()};
+        auto value{formatter->value()};
+        benchmark::DoNotOptimize(key.data());
+        benchmark::DoNotOptimize(value.data());
+    }
+}
+BENCHMARK_TEMPLATE(BM_formatter, details::PIDFormatter);
+BENCHMARK_TEMPLATE(BM_formatter, ModuleFormatter);
+
+/**
+ * Stream message through sync() to a data sender doing nothing
+ *
+ * @tparam Mode thread policy
+ */
+template<class Mode>
+static void BM_sync_null(benchmark::State& state) {
+    basic_ostream<Mode> syslog{std::make_unique<NullClient>(), std::make_unique<Mode>()};
+    syslog.cleanFormatters();
+    if (state.range(1)) {
+        syslog.addFormatter(std::make_shared<details::PIDFormatter>());
+        syslog.addFormatter(std::make_shared<ModuleFormatter>());
+    }
+
+    auto msg{text(state.range(0))};
+    for (auto _ : state)
+        syslog << msg << std::flush;
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_TEMPLATE(BM_sync_null, details::st)->ArgsProduct({{16, 256, 1024}, {0, 2}})->ArgNames({"size", "fmts"});
+BENCHMARK_TEMPLATE(BM_sync_null, details::mt)->ArgsProduct({{16, 256, 1024}, {0, 2}})->ArgNames({"size", "fmts"});
+
+/**
+ * Single thread client sending by UDP
+ */
+static void BM_udp_st(benchmark::State& state) {
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(DISCARD_PORT);
+
+    auto msg{text(state.range(0))};
+    for (auto _ : state)
+        syslog << msg << std::flush;
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_udp_st)->Arg(16)->Arg(256)->Arg(1024)->ArgName("size");
+
+/**
+ * Multi threads client sending by UDP, shared by benchmark threads
+ */
+static void BM_udp_mt(benchmark::State& state) {
+    static auto& syslog{*new ostream{makeUDPClient_mt()}}; // shared by threads, lives until exit
+    syslog.setPort(DISCARD_PORT);
+
+    auto msg{text(state.range(0))};
+    for (auto _ : state)
+        syslog << msg << std::flush;
+
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_udp_mt)->Arg(16)->Arg(256)->Arg(1024)->ArgName("size")->ThreadRange(1, 8)->UseRealTime();
+
+/**
+ * Single thread client sending by UDP to a local receiver, so losses are seen
+ */
+static void BM_udp_sink_st(benchmark::State& state) {
+    LocalSink sink{LocalSink::P_UDP, false};
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(sink.getPort());
+
+    auto msg{text(state.range(0))};
+    for (auto _ : state)
+        syslog << msg << std::flush;
+
+    sink.waitFor(static_cast<uint64_t>(state.iterations()), std::chrono::milliseconds{100});
+    state.counters["lost"] = benchmark::Counter(
+        static_cast<double>(static_cast<uint64_t>(state.iterations()) - sink.getCount()), 
+        benchmark::Counter::kAvgIterations
+    );
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_udp_sink_st)->Arg(16)->Arg(256)->Arg(1024)->ArgName("size");
@@ -0,0 +1,148 @@
+/**
+ * @file latency.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "syslog_client.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+static constexpr uint16_t DISCARD_PORT{9}; ///< nobody listens, so only the caller side is measured
+
+/**
+ * Message is formatted by iostreams and sent by calling thread
+ */
+static void BM_stream_st(benchmark::State& state) {
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(DISCARD_PORT);
+
+    int64_t i{0};
+    for (auto _ : state)
+        syslog << LogLvlMng::LL_INFO << "request " << ++i << " took " << 0.25 << " ms" << std::flush;
+}
+BENCHMARK(BM_stream_st);
+
+/**
+ * Numbers only, so conversion dominates
+ */
+static void BM_stream_num_st(benchmark::State& state) {
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(DISCARD_PORT);
+
+    int64_t i{0};
+    for (auto _ : state) {
+        ++i;
+        syslog << i << ' ' << -i << ' ' << static_cast<uint32_t>(i) << ' ' << 1.0 / static_cast<double>(i) << std::flush;
+    }
+}
+BENCHMARK(BM_stream_num_st);
+
+/**
+ * Message composed under mutexes of thread policy
+ *
+ * @tparam Mode thread policy, details::mt_prof shows the cost of lock profiling
+ */
+template<class Mode>
+static void BM_stream_mode(benchmark::State& state) {
+    auto syslog{makeUDPClient<Mode>()};
+    syslog.setPort(DISCARD_PORT);
+
+    int64_t i{0};
+    for (auto _ : state)
+        syslog << LogLvlMng::LL_INFO << "request " << ++i << " took " << 0.25 << " ms" << std::flush;
+}
+BENCHMARK_TEMPLATE(BM_stream_mode, details::mt);
+BENCHMARK_TEMPLATE(BM_stream_mode, details::mt_prof);
+
+/**
+ * Message is formatted by format string API and sent by calling thread
+ */
+static void BM_log_st(benchmark::State& state) {
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(DISCARD_PORT);
+
+    int64_t i{0};
+    for (auto _ : state)
+        syslog.log(LogLvlMng::LL_INFO, SYSLOG_FMT("request {} took {} ms"), ++i, 0.25);
+}
+BENCHMARK(BM_log_st);
+
+static constexpr int64_t DRAIN_EVERY{512}; ///< keeps the ring from filling up, so drops are not measured
+static constexpr int64_t DEFER_ITERATIONS{1 << 16}; ///< background sending bounds the rate, so time is not a good limit
+
+/**
+ * Only format descriptor and raw arguments are copied by calling thread
+ */
+static void BM_defer_st(benchmark::State& state) {
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(DISCARD_PORT);
+
+    int64_t i{0};
+    int64_t dropped{0};
+    for (auto _ : state) {
+        if (!syslog.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("request {} took {} ms"), ++i, 0.25))
+            ++dropped;
+
+        if (0 == i % DRAIN_EVERY) {
+            state.PauseTiming();
+            syslog.drainDeferred();
+            state.ResumeTiming();
+        }
+    }
+
+    state.counters["dropped"] = benchmark::Counter(static_cast<double>(dropped), benchmark::Counter::kAvgIterations);
+    syslog.drainDeferred();
+}
+BENCHMARK(BM_defer_st)->Iterations(DEFER_ITERATIONS);
+
+/**
+ * Deferred message with string argument
+ */
+static void BM_defer_str_st(benchmark::State& state) {
+    auto syslog{makeUDPClient_st()};
+    syslog.setPort(DISCARD_PORT);
+
+    std::string user{"user@example.com"};
+    int64_t i{0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(syslog.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("login of {}"), user));
+
+        if (0 == ++i % DRAIN_EVERY) {
+            state.PauseTiming();
+            syslog.drainDeferred();
+            state.ResumeTiming();
+        }
+    }
+
+    syslog.drainDeferred();
+}
+BENCHMARK(BM_defer_str_st)->Iterations(DEFER_ITERATIONS);
@@ -0,0 +1,181 @@
+/**
+ * @file receiver.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+#include "syslog_client.hpp"
+#include "syslog_receiver.hpp"
+#include "local_sink.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Records made by syslog::ostream, as a receiver gets them
+ */
+static const std::vector<std::string>& clientRecords() {
+    static const std::vector<std::string> records{[]() {
+        static constexpr uint64_t COUNT{256};
+        LocalSink sink;
+        auto syslog{makeUDPClient<details::st>()};
+        syslog.setPort(sink.getPort());
+        syslog.setSequence(true);
+        for (uint64_t i = 0; i < COUNT; ++i)
+            syslog << LogLvlMng::LL_INFO << kv("req", i) << "request " << i << " done in " << 2.5 * i << " ms" << std::flush;
+
+        sink.waitFor(COUNT, std::chrono::seconds{2});
+        std::vector<std::string> data;
+        for (auto& rec : sink.take())
+            data.push_back(std::move(rec.data));
+        return data;
+    }()};
+
+    return records;
+}
+
+/**
+ * Parse record and touch its fields
+ */
+static void consume(const char* data, std::size_t size) {
+    ParsedMsg msg;
+    benchmark::DoNotOptimize(parseMsg(data, size, msg));
+    benchmark::DoNotOptimize(msg.msg.data);
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+static void BM_parse_client(benchmark::State& state) {
+    const auto& records{clientRecords()};
+    std::size_t bytes{0};
+    for (auto _ : state) {
+        for (const auto& rec : records)
+            consume(rec.data(), rec.size());
+    }
+    for (const auto& rec : records)
+        bytes += rec.size();
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * records.size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+}
+BENCHMARK(BM_parse_client);
+
+static void BM_parse_rfc(benchmark::State& state) {
+    static const std::string RECORDS[]{
+        "<34>Oct 11 22:14:15 mymachine su[230]: 'su root' failed for lonvick on /dev/pts/8",
+        "<165>1 2003-10-11T22:14:15.003Z mymachine.example.com evntslog - ID47 "
+        "[exampleSDID@32473 iut=\"3\" eventSource=\"Application\" eventID=\"1011\"] An application event log entry"
+    };
+    const auto& rec{RECORDS[state.range(0)]};
+    for (auto _ : state)
+        consume(rec.data(), rec.size());
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * rec.size()));
+}
+BENCHMARK(BM_parse_rfc)->Arg(0)->Arg(1)->ArgName("rfc5424");
+
+/**
+ * Receive and parse datagrams sent by syslog::ostream in another thread
+ *
+ * @warning Producer and receiver compete for cores, records/s is what the receiver keeps up with
+ */
+static void BM_udp_receive(benchmark::State& state) {
+    UDPReceiver recv{ReceiverMng::DEFAULT_ADDR, 0, static_cast<std::size_t>(state.range(0))};
+    recv.setRcvBuf(8 << 20);
+
+    std::atomic<bool> stop{false};
+    std::thread producer{[&]() {
+        auto syslog{makeUDPClient<details::st>()};
+        syslog.setPort(recv.getPort());
+        syslog.setSndBuf(8 << 20);
+        uint64_t i{0};
+        while (!stop.load(std::memory_order_relaxed))
+            syslog << "request " << ++i << " done" << std::flush;
+    }};
+
+    for (auto _ : state)
+        recv.poll(10, consume);
+
+    stop = true;
+    producer.join();
+
+    state.SetItemsProcessed(static_cast<int64_t>(recv.getStats().records));
+    state.SetBytesProcessed(static_cast<int64_t>(recv.getStats().bytes));
+    state.counters["per_call"] = static_cast<double>(recv.getStats().records) / static_cast<double>(recv.getStats().calls);
+}
+BENCHMARK(BM_udp_receive)->Arg(1)->Arg(64)->ArgName("batch")->UseRealTime();
+
+/**
+ * Receive, unframe and parse octet counted records of syslog::ostream written by another thread
+ */
+static void BM_tcp_receive(benchmark::State& state) {
+    TCPReceiver recv;
+
+    std::string stream;
+    for (const auto& rec : clientRecords())
+        stream += std::to_string(rec.size()) + " " + rec;
+
+    std::atomic<bool> stop{false};
+    std::thread producer{[&]() {
+        auto sock{socket(AF_INET, SOCK_STREAM, 0)};
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(recv.getPort());
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (!connect(sock, (sockaddr*)&addr, sizeof(addr))) {
+            while (!stop.load(std::memory_order_relaxed) && write(sock, stream.data(), stream.size()) > 0) {}
+        }
+        close(sock);
+    }};
+
+    for (auto _ : state)
+        recv.poll(10, consume);
+
+    stop = true;
+    while (recv.getConnCount() || recv.poll(0, consume)) 
+        recv.poll(10, consume); // unblocks writer
+    producer.join();
+
+    state.SetItemsProcessed(static_cast<int64_t>(recv.getStats().records));
+    state.SetBytesProcessed(static_cast<int64_t>(recv.getStats().bytes));
+}
+BENCHMARK(BM_tcp_receive)->UseRealTime();
@@ -0,0 +1,157 @@
+/**
+ * @file hdr_hist.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_TEST_HDR_HIST_HPP
+#define __CPP_SYSLOG_CLIENT_TEST_HDR_HIST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Log-linear latency histogram, each power of two is split into linear sub-buckets as HDR histograms do
+ */
+class HdrHist;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class HdrHist final {
+private:
+    static constexpr int         SUB_BITS{6}; ///< 32 linear sub-buckets per power of two, ~3% error
+    static constexpr uint64_t    SUB{uint64_t{1} << SUB_BITS}; ///< values below it have exact buckets
+    static constexpr std::size_t BUCKETS{SUB + (64 - SUB_BITS) * (SUB / 2)}; ///< covers uint64_t
+private:
+    std::vector<uint64_t> m_Counts; ///< samples per bucket
+    uint64_t              m_Total; ///< number of samples
+    uint64_t              m_Max; ///< max sample
+public:
+    /**
+     * Ctor
+     */
+    HdrHist() : m_Counts(BUCKETS, 0), m_Total{0}, m_Max{0} {}
+
+    /**
+     * Add sample
+     *
+     * @param[in] val value, e.g. latency in ns
+     */
+    void record(uint64_t val) noexcept {
+        ++m_Counts[indexOf(val)];
+        ++m_Total;
+        if (val > m_Max)
+            m_Max = val;
+    }
+
+    /**
+     * Add samples of other histogram
+     *
+     * @param[in] other histogram
+     */
+    void add(const HdrHist& other) noexcept {
+        for (std::size_t i = 0; i < BUCKETS; ++i)
+            m_Counts[i] += other.m_Counts[i];
+        m_Total += other.m_Total;
+        if (other.m_Max > m_Max)
+            m_Max = other.m_Max;
+    }
+
+    /**
+     * Getter
+     *
+     * @return Number of samples
+     */
+    uint64_t getCount() const noexcept { return m_Total; }
+
+    /**
+     * Getter
+     *
+     * @return Max sample
+     */
+    uint64_t getMax() const noexcept { return m_Max; }
+
+    /**
+     * Get value at quantile
+     *
+     * @param[in] q quantile, 0..1, e.g. 0.999
+     *
+     * @return Upper bound of the bucket holding the quantile, 0 if there are no samples
+     */
+    uint64_t percentile(double q) const noexcept {
+        if (!m_Total)
+            return 0;
+
+        auto rank{static_cast<uint64_t>(q * static_cast<double>(m_Total))};
+        if (rank >= m_Total)
+            rank = m_Total - 1;
+
+        uint64_t seen{0};
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += m_Counts[i];
+            if (seen > rank) {
+                auto upper{upperOf(i)};
+                return upper < m_Max ? upper : m_Max;
+            }
+        }
+
+        return m_Max;
+    }
+
+    /**
+     * Get bucket of value
+     *
+     * @param[in] val value
+     */
+    static std::size_t indexOf(uint64_t val) noexcept {
+        if (val < SUB)
+            return static_cast<std::size_t>(val);
+
+        int msb{0};
+        for (auto v = val; v >>= 1;)
+            ++msb;
+
+        auto shift{msb - SUB_BITS + 1}; // val >> shift is in [SUB / 2, SUB)
+        return static_cast<std::size_t>(SUB + (shift - 1) * (SUB / 2) + ((val >> shift) - SUB / 2));
+    }
+
+    /**
+     * Get max value of bucket
+     *
+     * @param[in] idx bucket
+     */
+    static uint64_t upperOf(std::size_t idx) noexcept {
+        if (idx < SUB)
+            return idx;
+
+        auto rel{idx - SUB};
+        auto shift{static_cast<int>(rel / (SUB / 2)) + 1};
+        auto sub{rel % (SUB / 2) + SUB / 2};
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_TEST_HDR_HIST_HPP
@@ -0,0 +1,391 @@
+/**
+ * @file local_sink.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_TEST_LOCAL_SINK_HPP
+#define __CPP_SYSLOG_CLIENT_TEST_LOCAL_SINK_HPP
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+
+#include "metrics.hpp"
+
+/**
+ * Record taken by LocalSink
+ */
+struct SinkRecord;
+
+/**
+ * Fields of a record made by the client: "<PRI> [SD-ELEMENTs ]MSG"
+ */
+struct SinkFields;
+
+/**
+ * Receiver bound to an ephemeral loopback port, standing in for a syslog server in tests and benchmarks
+ */
+class LocalSink;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct SinkRecord {
+    std::string data; ///< record as received, framing stripped
+    uint64_t    recvNs; ///< receive time, syslog::details::nowNs() clock
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct SinkFields {
+    int         pri; ///< priority value
+    std::string sd; ///< structured data elements, empty if there are none
+    std::string msg; ///< message
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class LocalSink final {
+public:
+    /**
+     * Transport
+     */
+    enum Proto {
+        P_UDP, ///< one record per datagram
+        P_TCP ///< octet counting ("LEN SP MSG") or LF terminated records, RFC 6587
+    };
+
+    using Handler = std::function<void(const char*, std::size_t, uint64_t)>; ///< record, size and receive time, called by receiving thread
+private:
+    static constexpr int         POLL_TIMEOUT_MS{20}; ///< stop flag check period
+    static constexpr std::size_t MAX_RECORD_SIZE{65536}; ///< receive buffer
+private:
+    Proto                    m_Proto; ///< transport
+    bool                     m_Keep; ///< keep records for take()
+    int                      m_Sock; ///< bound socket
+    uint16_t                 m_Port; ///< bound port
+    Handler                  m_Handler; ///< called for each record
+    std::atomic<uint64_t>    m_Count; ///< records received
+    std::atomic<uint64_t>    m_Bytes; ///< bytes of records received
+    std::vector<SinkRecord>  m_Records; ///< kept records
+    std::mutex               m_Mtx; ///< guards kept records
+    std::condition_variable  m_Cond; ///< wakes waitFor() up
+    std::atomic<bool>        m_Stop; ///< worker should exit
+    std::thread              m_Worker; ///< background thread
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] proto transport
+     * @param[in] keep keep records for take(), turn off for long runs
+     * @param[in] handler called for each record by the receiving thread, e.g. parser or checker
+     */
+    explicit LocalSink(
+        Proto proto = P_UDP, 
+        bool keep = true, 
+        Handler handler = nullptr
+    ) :
+        m_Proto{proto},
+        m_Keep{keep},
+        m_Sock{socket(AF_INET, P_UDP == proto ? SOCK_DGRAM : SOCK_STREAM, 0)},
+        m_Port{0},
+        m_Handler{std::move(handler)},
+        m_Count{0},
+        m_Bytes{0},
+        m_Stop{false}
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+
+        socklen_t len{sizeof(addr)};
+        if (m_Sock < 0 || 
+            bind(m_Sock, (sockaddr*)&addr, sizeof(addr)) < 0 || 
+            getsockname(m_Sock, (sockaddr*)&addr, &len) < 0 ||
+            (P_TCP == proto && listen(m_Sock, SOMAXCONN) < 0))
+        {
+            if (m_Sock >= 0)
+                close(m_Sock);
+            throw std::runtime_error{"local sink socket"};
+        }
+
+        int size{8 << 20};
+        setsockopt(m_Sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size)); // fewer losses under bursts
+
+        m_Port = ntohs(addr.sin_port);
+        m_Worker = std::thread{&LocalSink::run, this};
+    }
+
+    /**
+     * Copy ctor
+     */
+    LocalSink(const LocalSink&) = delete;
+
+    /**
+     * Copy assignment operator
+     */
+    LocalSink& operator=(const LocalSink&) = delete;
+
+    /**
+     * Dtor
+     */
+    ~LocalSink() {
+        m_Stop.store(true);
+        m_Worker.join();
+        close(m_Sock);
+    }
+
+    /**
+     * Getter
+     *
+     * @return Bound port on 127.0.0.1
+     */
+    uint16_t getPort() const noexcept { return m_Port; }
+
+    /**
+     * Getter
+     *
+     * @return Records received
+     */
+    uint64_t getCount() const noexcept { return m_Count.load(); }
+
+    /**
+     * Getter
+     *
+     * @return Bytes of records received, framing excluded
+     */
+    uint64_t getBytes() const noexcept { return m_Bytes.load(); }
+
+    /**
+     * Wait until records are received
+     *
+     * @param[in] count number of records, in total
+     * @param[in] timeout max wait
+     *
+     * @return false on timeout
+     */
+    bool waitFor(uint64_t count, std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock{m_Mtx};
+        return m_Cond.wait_for(lock, timeout, [&]() { return m_Count.load() >= count; });
+    }
+
+    /**
+     * Take kept records
+     */
+    std::vector<SinkRecord> take() {
+        std::lock_guard<std::mutex> lock{m_Mtx};
+        std::vector<SinkRecord> records;
+        records.swap(m_Records);
+        return records;
+    }
+
+    /**
+     * Split record made by the client into fields
+     *
+     * @param[in] data record
+     * @param[in] size record size
+     * @param[out] fields fields
+     *
+     * @return false if record is malformed
+     */
+    static bool parse(const char* data, std::size_t size, SinkFields& fields) {
+        std::string rec{data, size};
+        if (rec.size() < 3 || '<' != rec[0])
+            return false;
+
+        auto close{rec.find('>')};
+        if (std::string::npos == close || close < 2 || close > 4)
+            return false;
+
+        fields.pri = std::atoi(rec.c_str() + 1);
+        auto pos{close + 1};
+        if (pos < rec.size() && ' ' == rec[pos])
+            ++pos;
+
+        fields.sd.clear();
+        while (pos < rec.size() && '[' == rec[pos]) {
+            auto end{elementEnd(rec, pos)};
+            if (std::string::npos == end)
+                return false;
+
+            fields.sd.append(rec, pos, end + 1 - pos);
+            pos = end + 1;
+        }
+        if (!fields.sd.empty() && pos < rec.size() && ' ' == rec[pos])
+            ++pos;
+
+        fields.msg.assign(rec, pos, std::string::npos);
+        return true;
+    }
+private:
+    /**
+     * Find closing bracket of SD-ELEMENT, skipping escaped chars and quoted values
+     *
+     * @param[in] rec record
+     * @param[in] pos opening bracket
+     */
+    static std::size_t elementEnd(const std::string& rec, std::size_t pos) {
+        auto quoted{false};
+        for (auto i = pos + 1; i < rec.size(); ++i) {
+            if ('\\' == rec[i] && quoted)
+                ++i;
+            else if ('"' == rec[i])
+                quoted = !quoted;
+            else if (']' == rec[i] && !quoted)
+                return i;
+        }
+
+        return std::string::npos;
+    }
+
+    /**
+     * Account record
+     *
+     * @param[in] data record
+     * @param[in] size record size
+     */
+    void onRecord(const char* data, std::size_t size) {
+        auto now{syslog::details::nowNs()};
+        if (m_Handler)
+            m_Handler(data, size, now);
+
+        {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            if (m_Keep)
+                m_Records.push_back(SinkRecord{std::string{data, size}, now});
+
+            m_Bytes += size;
+            ++m_Count;
+        }
+        m_Cond.notify_all();
+    }
+
+    /**
+     * Worker loop
+     */
+    void run() {
+        std::vector<char> buf(MAX_RECORD_SIZE);
+        std::vector<pollfd> fds{pollfd{m_Sock, POLLIN, 0}};
+        std::vector<std::string> pending{std::string{}}; // unframed TCP data per connection
+
+        while (!m_Stop.load()) {
+            if (poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) <= 0)
+                continue;
+
+            if (P_UDP == m_Proto) {
+                auto n{recv(m_Sock, buf.data(), buf.size(), MSG_DONTWAIT)};
+                while (n >= 0) {
+                    onRecord(buf.data(), static_cast<std::size_t>(n));
+                    n = recv(m_Sock, buf.data(), buf.size(), MSG_DONTWAIT);
+                }
+                continue;
+            }
+
+            if (fds[0].revents & POLLIN) {
+                auto conn{accept(m_Sock, nullptr, nullptr)};
+                if (conn >= 0) {
+                    fds.push_back(pollfd{conn, POLLIN, 0});
+                    pending.emplace_back();
+                }
+            }
+
+            for (std::size_t i = 1; i < fds.size();) {
+                if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                    ++i;
+                    continue;
+                }
+
+                auto n{recv(fds[i].fd, buf.data(), buf.size(), 0)};
+                if (n <= 0) {
+                    close(fds[i].fd);
+                    fds.erase(fds.begin() + i);
+                    pending.erase(pending.begin() + i);
+                    continue;
+                }
+
+                pending[i].append(buf.data(), static_cast<std::size_t>(n));
+                unframe(pending[i]);
+                ++i;
+            }
+        }
+
+        for (std::size_t i = 1; i < fds.size(); ++i)
+            close(fds[i].fd);
+    }
+
+    /**
+     * Take complete TCP records out of connection data
+     *
+     * @param[in,out] data received and not yet framed data
+     */
+    void unframe(std::string& data) {
+        std::size_t pos{0};
+        while (pos < data.size()) {
+            if (data[pos] >= '1' && data[pos] <= '9') {
+                // octet counting
+                auto space{data.find(' ', pos)};
+                if (std::string::npos == space)
+                    break;
+
+                auto len{static_cast<std::size_t>(std::strtoull(data.c_str() + pos, nullptr, 10))};
+                if (data.size() - space - 1 < len)
+                    break;
+
+                onRecord(data.data() + space + 1, len);
+                pos = space + 1 + len;
+            }
+            else {
+                // non-transparent framing
+                auto lf{data.find('\n', pos)};
+                if (std::string::npos == lf)
+                    break;
+
+                onRecord(data.data() + pos, lf - pos);
+                pos = lf + 1;
+            }
+        }
+
+        data.erase(0, pos);
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_TEST_LOCAL_SINK_HPP
@@ -0,0 +1,235 @@
+/**
+ * @file seq_check.hpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __CPP_SYSLOG_CLIENT_TEST_SEQ_CHECK_HPP
+#define __CPP_SYSLOG_CLIENT_TEST_SEQ_CHECK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "sequence.hpp"
+
+/**
+ * Loss and ordering of a numbered stream
+ */
+struct SeqStats;
+
+/**
+ * Tracks numbers of one stream as they arrive
+ */
+class SeqTrack;
+
+/**
+ * Checks sequence numbers of records, see syslog::basic_ostream::setSequence()
+ */
+class SeqChecker;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+struct SeqStats {
+    uint64_t received{0}; ///< distinct numbers arrived
+    uint64_t missing{0}; ///< numbers below the highest one that have not arrived (yet)
+    uint64_t reordered{0}; ///< numbers arrived after a higher one
+    uint64_t dups{0}; ///< numbers arrived again
+
+    /**
+     * Sum up
+     */
+    SeqStats& operator+=(const SeqStats& other) noexcept {
+        received += other.received;
+        missing += other.missing;
+        reordered += other.reordered;
+        dups += other.dups;
+        return *this;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class SeqTrack final {
+private:
+    std::vector<bool> m_Seen; ///< arrived numbers
+    uint64_t          m_Highest; ///< highest arrived number
+    SeqStats          m_Stats; ///< totals
+public:
+    /**
+     * Ctor
+     */
+    SeqTrack() : m_Highest{0} {}
+
+    /**
+     * Add arrived number
+     *
+     * @param[in] n number, from 1
+     *
+     * @warning Numbers are not expected to wrap
+     */
+    void add(uint64_t n) {
+        if (n >= m_Seen.size())
+            m_Seen.resize(std::max<std::size_t>(n + 1, m_Seen.size() * 2));
+        if (m_Seen[n]) {
+            ++m_Stats.dups;
+            return;
+        }
+
+        m_Seen[n] = true;
+        ++m_Stats.received;
+        if (n > m_Highest) {
+            m_Stats.missing += n - m_Highest - 1;
+            m_Highest = n;
+        }
+        else {
+            // late arrival fills a gap
+            --m_Stats.missing;
+            ++m_Stats.reordered;
+        }
+    }
+
+    /**
+     * Getter
+     *
+     * @warning Loss at the tail of the stream is not seen, compare getHighest() with the number of records sent
+     */
+    const SeqStats& getStats() const noexcept { return m_Stats; }
+
+    /**
+     * Getter
+     */
+    uint64_t getHighest() const noexcept { return m_Highest; }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class SeqChecker final {
+private:
+    SeqTrack                     m_Client; ///< meta sequenceId
+    std::map<uint32_t, SeqTrack> m_Threads; ///< per thread counters by thread number
+    uint64_t                     m_Unnumbered; ///< records with no or malformed sequence elements
+public:
+    /**
+     * Ctor
+     */
+    SeqChecker() : m_Unnumbered{0} {}
+
+    /**
+     * Check record, e.g. from LocalSink handler
+     *
+     * @param[in] data record
+     * @param[in] size record size
+     */
+    void onRecord(const char* data, std::size_t size) {
+        static const std::string threadElem{std::string{'['} + syslog::SequenceMng::THREAD_SD_NAME + '@'}; // any enterprise number
+
+        uint64_t id{0};
+        uint64_t thread{0};
+        uint64_t seq{0};
+        if (!param(data, size, "[meta ", "sequenceId=\"", id) || 
+            !param(data, size, threadElem.c_str(), "thread=\"", thread) ||
+            !param(data, size, threadElem.c_str(), "seq=\"", seq) ||
+            !id || !thread || !seq) {
+            ++m_Unnumbered;
+            return;
+        }
+
+        m_Client.add(id);
+        m_Threads[static_cast<uint32_t>(thread)].add(seq);
+    }
+
+    /**
+     * Getter
+     *
+     * @return Totals of client sequenceId
+     *
+     * @warning Threads take numbers before they send, so with many of them client numbers are reordered even on a
+     * lossless ordered transport, per thread counters show the transport reordering
+     */
+    const SeqStats& getClient() const noexcept { return m_Client.getStats(); }
+
+    /**
+     * Getter
+     *
+     * @return Totals of per thread counters summed up
+     */
+    SeqStats getThreads() const noexcept {
+        SeqStats stats;
+        for (const auto& track : m_Threads)
+            stats += track.second.getStats();
+        return stats;
+    }
+
+    /**
+     * Getter
+     */
+    std::size_t getThreadCount() const noexcept { return m_Threads.size(); }
+
+    /**
+     * Getter
+     */
+    uint64_t getUnnumbered() const noexcept { return m_Unnumbered; }
+private:
+    /**
+     * Find decimal param value in element
+     *
+     * @param[in] data record
+     * @param[in] size record size
+     * @param[in] elem start of the element
+     * @param[in] key param name with ="
+     * @param[out] val value
+     *
+     * @return false if there is no such param
+     */
+    static bool param(const char* data, std::size_t size, const char* elem, const char* key, uint64_t& val) {
+        const char* end{data + size};
+        const char* pos{std::search(data, end, elem, elem + std::strlen(elem))};
+        if (end == pos)
+            return false;
+
+        const char* close{std::find(pos, end, ']')};
+        pos = std::search(pos, close, key, key + std::strlen(key));
+        if (close == pos)
+            return false;
+
+        val = 0;
+        pos += std::strlen(key);
+        if (close == pos || *pos < '0' || *pos > '9')
+            return false;
+        for (; pos != close && *pos >= '0' && *pos <= '9'; ++pos)
+            val = val * 10 + static_cast<uint64_t>(*pos - '0');
+        return pos != close && '"' == *pos;
+    }
+};
+
+#endif // __CPP_SYSLOG_CLIENT_TEST_SEQ_CHECK_HPP
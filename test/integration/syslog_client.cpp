@@ -112,6 +112,57 @@ TEST_F(TestSyslogClient, sendInfoMsgOverUDP_mt) {
     ASSERT_TRUE(std::string::npos != tail(log).find("Info test message (mt)"));
 }
 
+TEST_F(TestSyslogClient, sendInfoMsgOverUDP_spin) {
+    auto syslog{makeUDPClient<details::spin>()};
+
+    syslog << LogLvlMng::LL_INFO << "Info test message (spin)" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ifstream log{logPath};
+    ASSERT_TRUE(std::string::npos != tail(log).find("Info test message (spin)"));
+}
+
+TEST_F(TestSyslogClient, sendInfoMsgOverUDP_lf) {
+    auto syslog{makeUDPClient<details::lf>()};
+
+    syslog << LogLvlMng::LL_INFO << "Info test message (lf)" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ifstream log{logPath};
+    ASSERT_TRUE(std::string::npos != tail(log).find("Info test message (lf)"));
+}
+
+TEST_F(TestSyslogClient, logFormattedMsgOverUDP_st) {
+    auto syslog{makeUDPClient_st()};
+
+    syslog.log(LogLvlMng::LL_INFO, SYSLOG_FMT("Formatted test message {} (st)"), 42);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ifstream log{logPath};
+    ASSERT_TRUE(std::string::npos != tail(log).find("Formatted test message 42 (st)"));
+}
+
+TEST_F(TestSyslogClient, logFormattedMsgOverUDP_mt) {
+    auto syslog{makeUDPClient_mt()};
+
+    syslog.log(LogLvlMng::LL_INFO, SYSLOG_FMT("Formatted test message {} (mt)"), 42);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ifstream log{logPath};
+    ASSERT_TRUE(std::string::npos != tail(log).find("Formatted test message 42 (mt)"));
+}
+
+TEST_F(TestSyslogClient, deferFormattedMsgOverUDP_st) {
+    auto syslog{makeUDPClient_st()};
+
+    ASSERT_TRUE(syslog.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("Deferred test message {} (st)"), 42));
+    syslog.drainDeferred();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ifstream log{logPath};
+    ASSERT_TRUE(std::string::npos != tail(log).find("Deferred test message 42 (st)"));
+}
+
 TEST_F(TestSyslogClient, sendNoticeMsgOverUDPSyslogFacility_st) {
     auto syslog{makeUDPClient_st()};
     syslog.setFacility(LogFacilityMng::LF_SYSLOG);
@@ -240,7 +291,7 @@ TEST_F(TestSyslogClient, eachThreadHasHisOwnSyslogClientInst_mt) {
 
 TEST_F(TestSyslogClient, sendMsgsByLogLvlWasSettedInMainThread_mt) {
     auto syslog{makeUDPClient_mt()};
-    syslog << LogLvlMng::LL_WARNING;
+    syslog.setLvl(LogLvlMng::LL_WARNING);
 
     auto sendMsg = [&]() {
         for (auto i = 0; i < 64; ++i) {
@@ -262,6 +313,22 @@ TEST_F(TestSyslogClient, sendMsgsByLogLvlWasSettedInMainThread_mt) {
         thread.join();
 }
 
+TEST_F(TestSyslogClient, sendMsgsWithOwnLogLvl_lf) {
+    auto syslog{makeUDPClient<details::lf>()};
+
+    auto sendMsg = [&](std::size_t id) {
+        for (auto i = 0; i < 64; ++i)
+            syslog << (0 == (id & 1) ? LogLvlMng::LL_ERR : LogLvlMng::LL_INFO) << "Test message from thread: " << id << std::endl;
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 16; i++)
+        threads.push_back(std::thread{sendMsg, i});
+
+    for (auto& thread : threads) 
+        thread.join();
+}
+
 TEST_F(TestSyslogClient, sendMsgsByCallingSetters_mt) {
     auto syslog{makeUDPClient_mt()};
 
@@ -398,7 +465,7 @@ TEST_F(TestSyslogClient, sendMsgWithDefaultFormattersOverUDP_st) {
     auto line{tail(log)};
 
     ASSERT_TRUE(std::string::npos != line.find("Test message with default formatter flags (st)"));
-    ASSERT_TRUE(std::string::npos != line.find("[pid"));
+    ASSERT_TRUE(std::string::npos != line.find("pid=\""));
     ASSERT_TRUE(std::string::npos != line.find("]"));
 }
 
@@ -412,7 +479,7 @@ TEST_F(TestSyslogClient, sendMsgWithDefaultFormattersOverUDP_mt) {
     auto line{tail(log)};
 
     ASSERT_TRUE(std::string::npos != line.find("Test message with default formatter flags (mt)"));
-    ASSERT_TRUE(std::string::npos != line.find("[pid"));
+    ASSERT_TRUE(std::string::npos != line.find("pid=\""));
     ASSERT_TRUE(std::string::npos != line.find("]"));
 }
 
@@ -427,11 +494,25 @@ TEST_F(TestSyslogClient, sendMsgWithNewFormatterOverUDP_st) {
     auto line{tail(log)};
 
     ASSERT_TRUE(std::string::npos != line.find("Test message with new formatter flag (st)"));
-    ASSERT_TRUE(std::string::npos != line.find("[pid"));
-    ASSERT_TRUE(std::string::npos != line.find("[module"));
+    ASSERT_TRUE(std::string::npos != line.find("pid=\""));
+    ASSERT_TRUE(std::string::npos != line.find("module=\""));
     ASSERT_TRUE(std::string::npos != line.find("]"));
 }
 
+TEST_F(TestSyslogClient, sendMsgWithParamsOverUDP_st) {
+    auto syslog{makeUDPClient_st()};
+
+    syslog << LogLvlMng::LL_INFO << kv("req_id", 42) << "Test message with params (st)" << std::endl;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::ifstream log{logPath};
+    auto line{tail(log)};
+
+    ASSERT_TRUE(std::string::npos != line.find("Test message with params (st)"));
+    ASSERT_TRUE(std::string::npos != line.find("pid=\""));
+    ASSERT_TRUE(std::string::npos != line.find("req_id=\"42\"]"));
+}
+
 TEST_F(TestSyslogClient, sendMsgWithNewFormatterOverUDP_mt) {
     auto syslog{makeUDPClient_st()};
     syslog.addFormatter(std::make_shared<ModuleNameFormatter>("test"));
@@ -443,8 +524,8 @@ TEST_F(TestSyslogClient, sendMsgWithNewFormatterOverUDP_mt) {
     auto line{tail(log)};
 
     ASSERT_TRUE(std::string::npos != line.find("Test message with new formatter flag (mt)"));
-    ASSERT_TRUE(std::string::npos != line.find("[pid"));
-    ASSERT_TRUE(std::string::npos != line.find("[module"));
+    ASSERT_TRUE(std::string::npos != line.find("pid=\""));
+    ASSERT_TRUE(std::string::npos != line.find("module=\""));
     ASSERT_TRUE(std::string::npos != line.find("]"));
 
     system("cat /var/log/syslog");
@@ -0,0 +1,312 @@
+/**
+ * @file soak.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "syslog_client.hpp"
+#include "local_sink.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Run options
+ */
+struct SoakArgs {
+    uint32_t seconds{10}; ///< duration of each run
+    uint32_t threads{8}; ///< producer threads sharing one client
+};
+
+/**
+ * Totals of one run
+ */
+struct SoakResult {
+    uint64_t              sent{0}; ///< messages logged
+    uint64_t              dropped{0}; ///< lost by the client itself, deferred rings overflow
+    uint64_t              received{0}; ///< messages arrived intact
+    uint64_t              corrupt{0}; ///< malformed, mixed or truncated messages
+    uint64_t              dups{0}; ///< messages arrived twice
+    uint64_t              rcvbuf{0}; ///< datagrams the kernel dropped because receiver socket buffer was full
+    std::vector<uint64_t> perThread; ///< messages logged by each producer
+    double                seconds{0}; ///< actual duration
+};
+
+/**
+ * Get datagrams dropped by the kernel because a receiver socket buffer was full, system wide
+ *
+ * @return 0 if counters aren't available (not Linux)
+ */
+uint64_t udpRcvbufErrors() {
+    std::ifstream snmp{"/proc/net/snmp"};
+    std::string names;
+    std::string line;
+    while (std::getline(snmp, line)) {
+        if (0 != line.compare(0, 4, "Udp:"))
+            continue;
+        if (names.empty()) {
+            names = line;
+            continue;
+        }
+
+        std::istringstream keys{names};
+        std::istringstream vals{line};
+        std::string key;
+        std::string val;
+        while (keys >> key && vals >> val) {
+            if ("RcvbufErrors" == key)
+                return std::strtoull(val.c_str(), nullptr, 10);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Checks messages on the receiving side
+ *
+ * Message of producer P number N is "p=P n=N " followed by 1 + N % CHUNKS chunks of CHUNK chars 'a' + P % 26, each
+ * chunk inserted separately, so a record mixed with output of another thread is caught.
+ */
+class SoakChecker final {
+public:
+    static constexpr uint32_t CHUNK{16}; ///< chars per insertion
+    static constexpr uint32_t CHUNKS{8}; ///< max insertions per message
+private:
+    std::vector<std::vector<bool>> m_Seen; ///< arrived message numbers of each producer
+    SinkFields                     m_Fields; ///< parsed record
+    uint64_t                       m_Received; ///< intact messages
+    uint64_t                       m_Corrupt; ///< broken messages
+    uint64_t                       m_Dups; ///< duplicates
+public:
+    /**
+     * Ctor
+     *
+     * @param[in] producers number of producer threads
+     */
+    explicit SoakChecker(uint32_t producers) : m_Seen(producers), m_Received{0}, m_Corrupt{0}, m_Dups{0} { }
+
+    /**
+     * Chunk of producer
+     */
+    static std::string chunk(uint32_t producer) { return std::string(CHUNK, static_cast<char>('a' + producer % 26)); }
+
+    /**
+     * Check record, called by receiving thread
+     */
+    void onRecord(const char* data, std::size_t size) {
+        unsigned long producer{0};
+        unsigned long long num{0};
+        int pos{0};
+        if (!LocalSink::parse(data, size, m_Fields) || 
+            2 != std::sscanf(m_Fields.msg.c_str(), "p=%lu n=%llu %n", &producer, &num, &pos) || 
+            producer >= m_Seen.size()) {
+            ++m_Corrupt;
+            return;
+        }
+
+        const char* body{m_Fields.msg.c_str() + pos};
+        const std::size_t len{m_Fields.msg.size() - pos};
+        const char c{static_cast<char>('a' + producer % 26)};
+        if (len != CHUNK * (1 + num % CHUNKS) || std::any_of(body, body + len, [c](char ch) { return ch != c; })) {
+            ++m_Corrupt;
+            return;
+        }
+
+        auto& seen{m_Seen[producer]};
+        if (seen.size() <= num)
+            seen.resize(std::max<std::size_t>(num + 1, seen.size() * 2));
+        if (seen[num]) {
+            ++m_Dups;
+            return;
+        }
+        seen[num] = true;
+        ++m_Received;
+    }
+
+    /**
+     * Fill result in, receiving thread must be stopped
+     */
+    void fill(SoakResult& res) const noexcept {
+        res.received = m_Received;
+        res.corrupt = m_Corrupt;
+        res.dups = m_Dups;
+    }
+};
+
+/**
+ * Run producers against a loopback receiver
+ *
+ * @tparam Mode thread policy
+ *
+ * @param[in] args options
+ * @param[in] deferred log by defer() instead of iostream
+ *
+ * @return Totals
+ */
+template<class Mode>
+SoakResult soak(const SoakArgs& args, bool deferred) {
+    SoakResult res;
+    res.perThread.resize(args.threads);
+
+    SoakChecker checker{args.threads};
+    std::unique_ptr<LocalSink> sink{
+        new LocalSink{
+            LocalSink::P_UDP, 
+            false, 
+            [&checker](const char* data, std::size_t size, uint64_t) { checker.onRecord(data, size); }
+        }
+    };
+
+    auto syslog{makeUDPClient<Mode>()};
+    syslog.setPort(sink->getPort());
+    syslog.cleanFormatters();
+
+    auto rcvbuf{udpRcvbufErrors()};
+    std::atomic<bool> stop{false};
+    auto produce = [&](uint32_t producer) {
+        const auto chunk{SoakChecker::chunk(producer)};
+        uint64_t num{0};
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (deferred) {
+                std::string body;
+                for (uint32_t i = 0; i <= num % SoakChecker::CHUNKS; ++i)
+                    body += chunk;
+                syslog.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("p={} n={} {}"), producer, num, body);
+            }
+            else {
+                syslog << "p=" << producer << " n=" << num << ' ';
+                for (uint32_t i = 0; i <= num % SoakChecker::CHUNKS; ++i)
+                    syslog << chunk;
+                syslog << std::flush;
+            }
+            ++num;
+        }
+        res.perThread[producer] = num;
+    };
+
+    auto start{std::chrono::steady_clock::now()};
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < args.threads; ++i)
+        threads.push_back(std::thread{produce, i});
+
+    std::this_thread::sleep_for(std::chrono::seconds{args.seconds});
+    stop = true;
+    for (auto& thread : threads) 
+        thread.join();
+
+    if (deferred) {
+        syslog.drainDeferred();
+        res.dropped = syslog.getMetrics().deferredDropped;
+    }
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto num : res.perThread)
+        res.sent += num;
+    sink->waitFor(res.sent - res.dropped, std::chrono::seconds{1});
+    sink.reset(); // joins receiving thread
+    res.rcvbuf = udpRcvbufErrors() - rcvbuf;
+    checker.fill(res);
+    return res;
+}
+
+/**
+ * Print run totals
+ *
+ * @return false if messages were corrupted, mixed or duplicated
+ */
+bool report(const char* name, const SoakResult& res) {
+    auto minmax{std::minmax_element(res.perThread.begin(), res.perThread.end())};
+    double sum{0};
+    double sumSq{0};
+    for (auto num : res.perThread) {
+        sum += static_cast<double>(num);
+        sumSq += static_cast<double>(num) * static_cast<double>(num);
+    }
+    // Jain's index: 1 when every producer got the same share, 1/threads when one took it all
+    const double jain{sumSq > 0 ? sum * sum / (res.perThread.size() * sumSq) : 0};
+    const double fair{*minmax.second > 0 ? static_cast<double>(*minmax.first) / static_cast<double>(*minmax.second) : 0};
+    const uint64_t lost{res.sent - res.dropped > res.received ? res.sent - res.dropped - res.received : 0};
+
+    std::printf(
+        "%-9s %12llu %12llu %8.3f%% %8.3f%% %8.3f%% %12.0f %12.0f %6.3f %7.3f %8llu %6llu\n",
+        name,
+        static_cast<unsigned long long>(res.sent),
+        static_cast<unsigned long long>(res.received),
+        res.sent ? 100.0 * static_cast<double>(res.dropped) / static_cast<double>(res.sent) : 0.0,
+        res.sent ? 100.0 * static_cast<double>(lost) / static_cast<double>(res.sent) : 0.0,
+        res.sent ? 100.0 * static_cast<double>(res.rcvbuf) / static_cast<double>(res.sent) : 0.0,
+        static_cast<double>(res.sent) / res.seconds,
+        static_cast<double>(res.received) / res.seconds,
+        jain,
+        fair,
+        static_cast<unsigned long long>(res.corrupt),
+        static_cast<unsigned long long>(res.dups)
+    );
+    std::fflush(stdout);
+    return 0 == res.corrupt && 0 == res.dups;
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+int main(int argc, char** argv) {
+    SoakArgs args;
+    if (argc > 1)
+        args.seconds = static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10));
+    if (argc > 2)
+        args.threads = std::max<uint32_t>(1, static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)));
+
+    std::printf("udp, %u producers, %u s per run\n", args.threads, args.seconds);
+    // UDP has no flow control: producers not serialized by a lock outrun one receiving thread, 
+    // "rcvbuf" is the part of "lost" the kernel dropped at the full receiver socket
+    std::printf(
+        "%-9s %12s %12s %9s %9s %9s %12s %12s %6s %7s %8s %6s\n", 
+        "mode", "sent", "received", "dropped", "lost", "rcvbuf", "sent/s", "recv/s", "jain", "min/max", "corrupt", "dups"
+    );
+
+    bool ok{true};
+    ok &= report("mt", soak<details::mt>(args, false));
+    ok &= report("spin", soak<details::spin>(args, false));
+    ok &= report("lf", soak<details::lf>(args, false));
+    ok &= report("mt_prof", soak<details::mt_prof>(args, false));
+    ok &= report("lf defer", soak<details::lf>(args, true));
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
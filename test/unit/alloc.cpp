@@ -0,0 +1,276 @@
+/**
+ * @file alloc.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <memory>
+#include <chrono>
+
+#include "client_impl.hpp"
+#include "ostream.hpp"
+#include "local_sink.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+
+/**
+ * Global allocations, counted while g_Counting is set, on any thread
+ */
+static std::atomic<bool> g_Counting{false};
+static std::atomic<uint64_t> g_Allocs{0};
+
+/**
+ * The only allocation function behind all replaced forms of operator new
+ */
+static void* countedAlloc(std::size_t size) noexcept {
+    if (g_Counting.load(std::memory_order_relaxed))
+        g_Allocs.fetch_add(1, std::memory_order_relaxed);
+
+    return std::malloc(size ? size : 1);
+}
+
+/**
+ * The only deallocation function behind all replaced forms of operator delete
+ *
+ * @warning Kept out of line, else GCC sees free() of a pointer returned by operator new where delete is inlined
+ */
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static void countedFree(void* ptr) noexcept { std::free(ptr); }
+
+void* operator new(std::size_t size) {
+    if (void* ptr = countedAlloc(size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+    if (void* ptr = countedAlloc(size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { countedFree(ptr); }
+
+void operator delete[](void* ptr, std::size_t) noexcept { countedFree(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+/**
+ * Client with thread policy chosen at compile time
+ */
+template<class Mode>
+basic_ostream<Mode> makeOs() { return basic_ostream<Mode>{std::make_unique<UDPClient>(), std::make_unique<Mode>()}; }
+
+/**
+ * Client with thread policy chosen at runtime, as makeUDPClient_mt() makes it
+ */
+template<>
+basic_ostream<TMode> makeOs<TMode>() { return basic_ostream<TMode>{std::make_unique<UDPClient>(), std::make_unique<mt>()}; }
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class Mode>
+class TestAlloc : public ::testing::Test {
+protected:
+    static constexpr uint64_t ALLOCS_PER_MSG{0}; ///< guaranteed heap allocations per message once warmed up
+    static constexpr uint64_t MSGS{1000}; ///< messages per run, as many to warm up
+    static constexpr int WAIT_MS{2000}; ///< loopback is fast, it's just a guard
+protected:
+    LocalSink           m_Sink{LocalSink::P_UDP, false};
+    basic_ostream<Mode> m_Os{makeOs<Mode>()};
+protected:
+    void SetUp() { 
+        m_Os.setPort(m_Sink.getPort());
+        m_Os.setSndBuf(1 << 20);
+    }
+
+    void TearDown() { }
+
+    /**
+     * Log MSGS messages to warm caches, pools and thread locals up, then as many more counting allocations
+     *
+     * @param[in] logOne logs message number i
+     *
+     * @return Allocations per message in steady state, rounded up
+     */
+    template<class F>
+    uint64_t allocsPerMsg(F&& logOne) {
+        for (uint64_t i = 0; i < MSGS; ++i)
+            logOne(i);
+        // receiving thread allocates its buffers at start, let it reach its loop
+        m_Sink.waitFor(1, std::chrono::milliseconds{WAIT_MS});
+
+        g_Allocs = 0;
+        g_Counting = true;
+        for (uint64_t i = 0; i < MSGS; ++i)
+            logOne(i);
+        g_Counting = false;
+
+        return (g_Allocs.load() + MSGS - 1) / MSGS;
+    }
+
+    /**
+     * Expected allocations per message
+     */
+    static uint64_t expected() noexcept { return ALLOCS_PER_MSG; }
+};
+
+using Modes = ::testing::Types<TMode, st, mt, spin, lf, mt_prof>;
+TYPED_TEST_SUITE(TestAlloc, Modes);
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, stream) {
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << "message " << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, streamNoFormatters) {
+    this->m_Os.cleanFormatters();
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << "message " << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, streamLvl) {
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { 
+        this->m_Os << LogLvlMng::LL_WARNING << "message " << i << " of " << 2.5 << std::flush; 
+    }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, log) {
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { 
+        this->m_Os.log(LogLvlMng::LL_INFO, SYSLOG_FMT("message {} of {}"), i, "run"); 
+    }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, recordParams) {
+    this->m_Os.setSDId("alloc@32473");
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { 
+        this->m_Os.addRecordParam("seq", i);
+        this->m_Os.addRecordParam("user", "root");
+        this->m_Os << "message" << std::flush; 
+    }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, defer) {
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { 
+        this->m_Os.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("message {}"), i); 
+        if (0 == (i + 1) % 64)
+            this->m_Os.drainDeferred(); // rendering thread is counted too
+    }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, latencyMetrics) {
+    this->m_Os.setLatencyMetrics(true);
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << "message " << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, nonBlockingRetry) {
+    this->m_Os.setNonBlocking(true);
+    this->m_Os.setRetry(true);
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << "message " << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, truncate) {
+    static const std::string big(512, 'x');
+    this->m_Os.setMaxMsgSize(128);
+    this->m_Os.setMsgSizePolicy(MsgSizeMng::MSP_TRUNCATE);
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << big << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, split) {
+    static const std::string big(512, 'x');
+    this->m_Os.setMaxMsgSize(128);
+    this->m_Os.setMsgSizePolicy(MsgSizeMng::MSP_SPLIT);
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << big << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, sequence) {
+    this->m_Os.setSequence(true);
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << "message " << i << std::flush; }));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestAlloc, sanitize) {
+    this->m_Os.setSanitize(true);
+    ASSERT_EQ(this->expected(), this->allocsPerMsg([this](uint64_t i) { this->m_Os << "tab\tand \xFF " << i << std::endl; }));
+}
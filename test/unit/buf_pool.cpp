@@ -0,0 +1,143 @@
+/**
+ * @file buf_pool.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "buf_pool.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestBufPool : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestBufPool, classOf) {
+    std::size_t classes{BufPool::CLASSES};
+
+    ASSERT_EQ(0u, BufPool::classOf(1));
+    ASSERT_EQ(0u, BufPool::classOf(64));
+    ASSERT_EQ(1u, BufPool::classOf(65));
+    ASSERT_EQ(classes - 1, BufPool::classOf(64 * 1024));
+    ASSERT_EQ(classes, BufPool::classOf(64 * 1024 + 1));
+}
+
+TEST_F(TestBufPool, blockIsReused) {
+    auto& pool{BufPool::instance()};
+
+    auto first{pool.allocate(100)};
+    pool.deallocate(first, 100);
+    auto second{pool.allocate(128)};
+    pool.deallocate(second, 128);
+
+    ASSERT_EQ(first, second);
+}
+
+TEST_F(TestBufPool, steadyStateTakesNothingFromHeap) {
+    auto& pool{BufPool::instance()};
+
+    auto run = [&]() {
+        PooledString buf;
+        for (auto i = 0; i < 1000; ++i) {
+            buf.assign(static_cast<std::size_t>(i), 'x');
+            PooledString copy{buf};
+        }
+    };
+
+    run(); // warm up
+    auto before{pool.getStats()};
+    run();
+    auto after{pool.getStats()};
+
+    ASSERT_EQ(before.misses, after.misses);
+    ASSERT_EQ(before.oversize, after.oversize);
+}
+
+TEST_F(TestBufPool, oversize) {
+    auto& pool{BufPool::instance()};
+    auto before{pool.getStats().oversize};
+
+    auto ptr{pool.allocate(1024 * 1024)};
+    pool.deallocate(ptr, 1024 * 1024);
+
+    ASSERT_EQ(before + 1, pool.getStats().oversize);
+}
+
+TEST_F(TestBufPool, releasedByOtherThread) {
+    static constexpr std::size_t N{4096};
+    std::vector<void*> ptrs;
+
+    for (std::size_t i = 0; i < N; ++i) {
+        ptrs.push_back(BufPool::instance().allocate(200));
+        *static_cast<char*>(ptrs.back()) = 'x';
+    }
+
+    auto release = [&](std::size_t from) {
+        for (auto i = from; i < N; i += 2)
+            BufPool::instance().deallocate(ptrs[i], 200);
+    };
+
+    std::thread t1{release, 0};
+    std::thread t2{release, 1};
+    t1.join();
+    t2.join();
+
+    // blocks cached by exited threads went to global free list
+    auto before{BufPool::instance().getStats().misses};
+    auto ptr{BufPool::instance().allocate(200)};
+    BufPool::instance().deallocate(ptr, 200);
+
+    ASSERT_EQ(before, BufPool::instance().getStats().misses);
+}
+
+TEST_F(TestBufPool, concurrentAllocations) {
+    auto churn = [](char ch) {
+        for (auto i = 0; i < 10000; ++i) {
+            PooledString buf(static_cast<std::size_t>(i % 500 + 1), ch);
+            if (buf.back() != ch || buf.front() != ch)
+                std::abort();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 4; ++i)
+        threads.push_back(std::thread{churn, static_cast<char>('a' + i)});
+
+    for (auto& thread : threads)
+        thread.join();
+}
@@ -0,0 +1,162 @@
+/**
+ * @file conv.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <clocale>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "conv.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestConv : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    template<class T>
+    std::string conv(T val) {
+        std::string res;
+        appendArg(res, val);
+        return res;
+    }
+
+    template<class T>
+    std::string stream(T val) {
+        std::ostringstream ss;
+        ss << val;
+        return ss.str();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestConv, integers) {
+    ASSERT_EQ("0", conv(0));
+    ASSERT_EQ("7", conv(7));
+    ASSERT_EQ("10", conv(10));
+    ASSERT_EQ("-10", conv(-10));
+    ASSERT_EQ("100", conv(100u));
+    ASSERT_EQ("12345", conv(12345L));
+    ASSERT_EQ(stream(std::numeric_limits<int64_t>::min()), conv(std::numeric_limits<int64_t>::min()));
+    ASSERT_EQ(stream(std::numeric_limits<int64_t>::max()), conv(std::numeric_limits<int64_t>::max()));
+    ASSERT_EQ(stream(std::numeric_limits<uint64_t>::max()), conv(std::numeric_limits<uint64_t>::max()));
+    ASSERT_EQ(stream(std::numeric_limits<int16_t>::min()), conv(std::numeric_limits<int16_t>::min()));
+}
+
+TEST_F(TestConv, floatingPoint) {
+    for (auto val : {0.0, 1.0, -1.5, 3.14159265, 1e-7, 123456789.0, 1e300, -0.000123})
+        ASSERT_EQ(stream(val), conv(val));
+
+    ASSERT_EQ(stream(2.5f), conv(2.5f));
+
+    // exact ties are rounded half to even, carry may move exponent
+    for (auto val : {123456.5, 123457.5, 1234565.0, 999999.5, 9.999995e-5, 1e22, 5e-324, -0.0})
+        ASSERT_EQ(stream(val), conv(val));
+
+    ASSERT_EQ(stream(std::numeric_limits<long double>::max()), conv(std::numeric_limits<long double>::max()));
+    ASSERT_EQ(stream(std::numeric_limits<long double>::denorm_min()), conv(std::numeric_limits<long double>::denorm_min()));
+    ASSERT_EQ("inf", conv(std::numeric_limits<double>::infinity()));
+    ASSERT_EQ("-inf", conv(-std::numeric_limits<double>::infinity()));
+    ASSERT_EQ("nan", conv(std::numeric_limits<double>::quiet_NaN()));
+}
+
+TEST_F(TestConv, fastDigitsMatchExact) {
+    std::mt19937_64 rnd{42};
+    std::size_t fast{0};
+    for (auto i = 0; i < 100000; ++i) {
+        auto bits{rnd()};
+        double val;
+        std::memcpy(&val, &bits, sizeof(val));
+        val = std::fabs(val);
+        if (!std::isfinite(val) || 0 == val)
+            continue;
+
+        int exp;
+        auto mant{static_cast<uint64_t>(std::ldexp(std::frexp(val, &exp), 64))};
+        char digits[6];
+        int dexp;
+        if (!fastDigits(mant, exp - 64, digits, 6, dexp))
+            continue;
+        ++fast;
+
+        char exact[6];
+        int exactDexp;
+        exactDigits(val, exact, 6, exactDexp);
+        ASSERT_EQ(std::string(exact, 6), std::string(digits, 6)) << val;
+        ASSERT_EQ(exactDexp, dexp) << val;
+    }
+
+    ASSERT_LT(99000u, fast); // values next to ties only take the exact path
+
+    // exact tie can't be rounded by approximation
+    int exp;
+    auto mant{static_cast<uint64_t>(std::ldexp(std::frexp(123456.5, &exp), 64))};
+    char digits[6];
+    int dexp;
+    ASSERT_FALSE(fastDigits(mant, exp - 64, digits, 6, dexp));
+}
+
+TEST_F(TestConv, floatingPointIgnoresLocale) {
+    std::string prev{std::setlocale(LC_NUMERIC, nullptr)};
+
+    const char* names[]{"de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "ru_RU.UTF-8"};
+    const char* found{nullptr};
+    for (auto name : names) {
+        if (std::setlocale(LC_NUMERIC, name)) {
+            found = name;
+            break;
+        }
+    }
+    if (!found)
+        GTEST_SKIP() << "no locale with decimal comma";
+
+    auto res{conv(-1.5) + ' ' + conv(0.25) + ' ' + conv(1e20) + ' ' + conv(123456789.0)};
+    std::setlocale(LC_NUMERIC, prev.c_str());
+
+    ASSERT_EQ("-1.5 0.25 1e+20 1.23457e+08", res);
+}
+
+TEST_F(TestConv, others) {
+    ASSERT_EQ("1", conv(true));
+    ASSERT_EQ("0", conv(false));
+    ASSERT_EQ("x", conv('x'));
+    ASSERT_EQ("text", conv("text"));
+    ASSERT_EQ("text", conv(std::string{"text"}));
+    ASSERT_EQ("", conv(static_cast<const char*>(nullptr)));
+}
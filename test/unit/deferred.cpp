@@ -0,0 +1,196 @@
+/**
+ * @file deferred.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <chrono>
+
+#include "deferred.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestDeferred : public ::testing::Test {
+protected:
+    /**
+     * Collects rendered messages
+     */
+    struct Sent {
+        std::mutex                                               mtx;
+        std::vector<std::pair<LogLvlMng::LogLvl, std::string>>   msgs;
+
+        Deferred::Sink sink() {
+            return [this](LogLvlMng::LogLvl lvl, const PooledString& body) {
+                std::lock_guard<std::mutex> lock{mtx};
+                msgs.emplace_back(lvl, std::string{body.data(), body.size()});
+            };
+        }
+    };
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestDeferred, render) {
+    Sent sent;
+    {
+        Deferred deferred{sent.sink()};
+        std::string user{"max"};
+        char name[] = "buf";
+
+        ASSERT_TRUE(deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("user {} took {} ms"), user, 42));
+        ASSERT_TRUE(deferred.push(LogLvlMng::LL_ERR, SYSLOG_FMT("{} {} {} {} {{}}"), "lit", name, 'c', -1.5));
+        ASSERT_TRUE(deferred.push(LogLvlMng::LL_DEBUG, SYSLOG_FMT("no args")));
+        deferred.drain();
+    }
+
+    ASSERT_EQ(3, sent.msgs.size());
+    ASSERT_EQ(LogLvlMng::LL_INFO, sent.msgs[0].first);
+    ASSERT_EQ("user max took 42 ms", sent.msgs[0].second);
+    ASSERT_EQ(LogLvlMng::LL_ERR, sent.msgs[1].first);
+    ASSERT_EQ("lit buf c -1.5 {}", sent.msgs[1].second);
+    ASSERT_EQ("no args", sent.msgs[2].second);
+}
+
+TEST_F(TestDeferred, sentOnDestroy) {
+    Sent sent;
+    {
+        Deferred deferred{sent.sink()};
+        for (auto i = 0; i < 100; ++i)
+            deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), i);
+    }
+
+    ASSERT_EQ(100, sent.msgs.size());
+    ASSERT_EQ("99", sent.msgs.back().second);
+}
+
+TEST_F(TestDeferred, droppedIfRingIsFull) {
+    Sent sent;
+    Deferred deferred{sent.sink(), 64};
+
+    std::string big(100, 'a'); // never fits 64 bytes ring
+    ASSERT_FALSE(deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), big));
+    ASSERT_EQ(1, deferred.getDropped());
+}
+
+TEST_F(TestDeferred, ringFreedWithInstance) {
+    Sent sent;
+    auto run = [&]() {
+        Deferred deferred{sent.sink()};
+        deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), 1);
+        deferred.drain();
+    };
+
+    run();
+    auto misses{BufPool::instance().getStats().misses};
+
+    // ring of each destroyed instance is pruned from thread storage, so the next one reuses its block
+    for (auto i = 0; i < 32; ++i)
+        run();
+
+    ASSERT_LT(BufPool::instance().getStats().misses - misses, 4u);
+}
+
+TEST_F(TestDeferred, ringFreedWithThread) {
+    Sent sent;
+    Deferred deferred{sent.sink()};
+
+    // ring of each exited thread is freed once it's empty, so the list doesn't grow with thread churn
+    for (auto i = 0; i < 32; ++i) {
+        std::thread{[&deferred, i]() { deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), i); }}.join();
+
+        auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+        while (deferred.getRings() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        ASSERT_EQ(0u, deferred.getRings());
+    }
+
+    std::lock_guard<std::mutex> lock{sent.mtx};
+    ASSERT_EQ(32, sent.msgs.size());
+}
+
+TEST_F(TestDeferred, wokenAfterIdle) {
+    Sent sent;
+    Deferred deferred{sent.sink()};
+
+    for (auto i = 0; i < 3; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{20}); // worker parks meanwhile
+        deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), i);
+
+        auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock{sent.mtx};
+                if (sent.msgs.size() > static_cast<std::size_t>(i) || std::chrono::steady_clock::now() > deadline)
+                    break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        std::lock_guard<std::mutex> lock{sent.mtx};
+        ASSERT_EQ(static_cast<std::size_t>(i + 1), sent.msgs.size());
+    }
+}
+
+TEST_F(TestDeferred, orderPerThread) {
+    static constexpr int N{10000};
+    Sent sent;
+    {
+        Deferred deferred{sent.sink(), 1 << 20};
+
+        auto log = [&deferred](int id) {
+            for (auto i = 0; i < N; ++i)
+                deferred.push(LogLvlMng::LL_INFO, SYSLOG_FMT("{} {}"), id, i);
+        };
+
+        std::thread t1{log, 1};
+        std::thread t2{log, 2};
+        t1.join();
+        t2.join();
+    }
+
+    int next[3] = {0, 0, 0};
+    bool ordered{true};
+    for (const auto& msg : sent.msgs) {
+        auto id{std::stoi(msg.second.substr(0, 1))};
+        ordered = ordered && std::stoi(msg.second.substr(2)) == next[id]++;
+    }
+
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(2 * N, sent.msgs.size());
+}
@@ -0,0 +1,81 @@
+/**
+ * @file format.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "format.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestFormat : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestFormat, parseFmt) {
+    static_assert(parseFmt("").valid, "");
+    static_assert(0 == parseFmt("").pieces, "");
+    static_assert(2 == parseFmt("user {} took {} ms").args, "");
+    static_assert(5 == parseFmt("user {} took {} ms").pieces, "");
+    static_assert(14 == parseFmt("user {} took {} ms").literal, "");
+    static_assert(0 == parseFmt("{{}}").args, "");
+    static_assert(2 == parseFmt("{{}}").literal, "");
+    static_assert(!parseFmt("{").valid, "");
+    static_assert(!parseFmt("}").valid, "");
+    static_assert(!parseFmt("{0}").valid, "");
+}
+
+TEST_F(TestFormat, formatTo) {
+    std::string res;
+
+    formatTo(res, SYSLOG_FMT("user {} took {} ms"), 42, 1.5);
+    ASSERT_EQ("user 42 took 1.5 ms", res);
+
+    res.clear();
+    formatTo(res, SYSLOG_FMT("{}{}"), "a", std::string{"b"});
+    ASSERT_EQ("ab", res);
+
+    res.clear();
+    formatTo(res, SYSLOG_FMT("{{{}}} }}"), -1);
+    ASSERT_EQ("{-1} }", res);
+
+    res.clear();
+    formatTo(res, SYSLOG_FMT("no args"));
+    ASSERT_EQ("no args", res);
+
+    res.clear();
+    formatTo(res, SYSLOG_FMT(""));
+    ASSERT_EQ("", res);
+}
@@ -0,0 +1,87 @@
+/**
+ * @file lf.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "tmode.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestLF : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestLF, simpleMainThread) {
+    lf mode;
+    mode.lock();
+    mode.unlock();
+    mode.lockRec();
+    mode.unlockRec();
+}
+
+TEST_F(TestLF, sameThreadSameBuf) {
+    lf mode;
+
+    ASSERT_TRUE(nullptr != mode.localBuf());
+    ASSERT_EQ(mode.localBuf(), mode.localBuf());
+}
+
+TEST_F(TestLF, eachInstanceHasItsOwnBuf) {
+    lf mode;
+    lf another;
+
+    ASSERT_NE(mode.localBuf(), another.localBuf());
+    ASSERT_NE(another.localBuf(), mode.localBuf());
+}
+
+TEST_F(TestLF, eachThreadHasItsOwnBuf) {
+    lf mode;
+    auto main{mode.localBuf()};
+    PooledString* other{nullptr};
+
+    std::thread{[&]() { other = mode.localBuf(); }}.join();
+
+    ASSERT_TRUE(nullptr != other);
+    ASSERT_NE(main, other);
+}
+
+TEST_F(TestLF, sharedBufModes) {
+    ASSERT_TRUE(nullptr == st{}.localBuf());
+    ASSERT_TRUE(nullptr == mt{}.localBuf());
+    ASSERT_TRUE(nullptr == spin{}.localBuf());
+}
@@ -0,0 +1,103 @@
+/**
+ * @file local.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "local.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestLocal : public ::testing::Test {
+protected:
+    /**
+     * Per thread object counting living copies
+     */
+    struct Counted {
+        static int alive;
+        int        val{0};
+
+        Counted() { ++alive; }
+        ~Counted() { --alive; }
+    };
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+int TestLocal::Counted::alive{0};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestLocal, perOwnerPerThread) {
+    InstanceId first;
+    InstanceId second;
+
+    threadLocal<Counted>(first.get()).val = 1;
+    threadLocal<Counted>(second.get()).val = 2;
+    ASSERT_EQ(1, threadLocal<Counted>(first.get()).val);
+    ASSERT_EQ(2, threadLocal<Counted>(second.get()).val);
+
+    std::thread{[&]() { ASSERT_EQ(0, threadLocal<Counted>(first.get()).val); }}.join();
+    ASSERT_EQ(1, threadLocal<Counted>(first.get()).val);
+}
+
+TEST_F(TestLocal, prunedAfterOwnerDestroyed) {
+    InstanceId live;
+    threadLocal<Counted>(live.get()).val = 1; // objects of owners destroyed by other tests go here
+    auto base{Counted::alive};
+
+    for (auto i = 0; i < 100; ++i) {
+        InstanceId dead;
+        threadLocal<Counted>(dead.get());
+    }
+
+    // pruned on the next lookup of another owner
+    threadLocal<Counted>(live.get());
+    ASSERT_EQ(base, Counted::alive);
+    ASSERT_EQ(1, threadLocal<Counted>(live.get()).val);
+}
+
+TEST_F(TestLocal, movedIdKeepsObjects) {
+    InstanceId other;
+    auto first{std::make_unique<InstanceId>()};
+    threadLocal<Counted>(first->get()).val = 1;
+
+    InstanceId moved{std::move(*first)};
+    first.reset();
+    threadLocal<Counted>(other.get());
+
+    ASSERT_EQ(0u, first ? first->get() : 0u);
+    ASSERT_EQ(1, threadLocal<Counted>(moved.get()).val);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file local_sink.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <memory>
+#include <chrono>
+
+#include "client_impl.hpp"
+#include "ostream.hpp"
+#include "local_sink.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestLocalSink : public ::testing::Test {
+protected:
+    static constexpr int WAIT_MS{2000}; ///< loopback is fast, it's just a guard
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    /**
+     * Connect to TCP sink and send data
+     */
+    static void sendTCP(uint16_t port, const std::string& data) {
+        auto sock{socket(AF_INET, SOCK_STREAM, 0)};
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        ASSERT_EQ(0, connect(sock, (sockaddr*)&addr, sizeof(addr)));
+        ASSERT_EQ(static_cast<ssize_t>(data.size()), write(sock, data.data(), data.size()));
+        close(sock);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestLocalSink, udp) {
+    LocalSink sink;
+    basic_ostream<st> syslog{std::make_unique<UDPClient>(), std::make_unique<st>()};
+    syslog.setPort(sink.getPort());
+    syslog.cleanFormatters();
+
+    for (auto i = 0; i < 100; ++i)
+        syslog << LogLvlMng::LL_INFO << "message " << i << std::flush;
+
+    std::chrono::milliseconds::rep ms{WAIT_MS};
+    ASSERT_TRUE(sink.waitFor(100, std::chrono::milliseconds{ms}));
+
+    auto records{sink.take()};
+    ASSERT_EQ(100u, records.size());
+    ASSERT_EQ("<190> message 0", records[0].data);
+    ASSERT_EQ("<190> message 99", records[99].data);
+    ASSERT_LE(records[0].recvNs, records[99].recvNs);
+    ASSERT_EQ(100u, sink.getCount());
+}
+
+TEST_F(TestLocalSink, tcpFraming) {
+    LocalSink sink{LocalSink::P_TCP};
+    sendTCP(sink.getPort(), "17 <191> counted\nmsg<191> terminated\n");
+
+    std::chrono::milliseconds::rep ms{WAIT_MS};
+    ASSERT_TRUE(sink.waitFor(2, std::chrono::milliseconds{ms}));
+
+    auto records{sink.take()};
+    ASSERT_EQ(2u, records.size());
+    ASSERT_EQ("<191> counted\nmsg", records[0].data);
+    ASSERT_EQ("<191> terminated", records[1].data);
+}
+
+TEST_F(TestLocalSink, handler) {
+    std::size_t bytes{0};
+    {
+        LocalSink sink{LocalSink::P_UDP, false, [&](const char*, std::size_t size, uint64_t) { bytes += size; }};
+        UDPClient clnt;
+        clnt.setPort(sink.getPort());
+        clnt.send(std::string{"<191> test"});
+
+        std::chrono::milliseconds::rep ms{WAIT_MS};
+        ASSERT_TRUE(sink.waitFor(1, std::chrono::milliseconds{ms}));
+        ASSERT_TRUE(sink.take().empty());
+    } // handler is called by receiving thread, it's joined here
+
+    ASSERT_EQ(10u, bytes);
+}
+
+TEST_F(TestLocalSink, parse) {
+    SinkFields fields;
+    std::string rec{"<190> [app@1 k=\"v\\]\"][b@1] text [not sd]"};
+
+    ASSERT_TRUE(LocalSink::parse(rec.data(), rec.size(), fields));
+    ASSERT_EQ(190, fields.pri);
+    ASSERT_EQ("[app@1 k=\"v\\]\"][b@1]", fields.sd);
+    ASSERT_EQ("text [not sd]", fields.msg);
+
+    rec = "<7> plain";
+    ASSERT_TRUE(LocalSink::parse(rec.data(), rec.size(), fields));
+    ASSERT_EQ(7, fields.pri);
+    ASSERT_TRUE(fields.sd.empty());
+    ASSERT_EQ("plain", fields.msg);
+
+    rec = "no pri";
+    ASSERT_FALSE(LocalSink::parse(rec.data(), rec.size(), fields));
+}
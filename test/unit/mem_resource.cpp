@@ -0,0 +1,130 @@
+/**
+ * @file mem_resource.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <new>
+
+#include "mem_resource.hpp"
+#include "buf_pool.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestMemResource : public ::testing::Test {
+protected:
+    /**
+     * Counts memory taken from the static region
+     */
+    class CountingResource : public IMemResource {
+    private:
+        StaticMemResource<1 << 20> m_Region;
+    public:
+        std::atomic<int> allocs{0};
+
+        void* allocate(std::size_t size) override {
+            ++allocs;
+            return m_Region.allocate(size);
+        }
+
+        void deallocate(void* ptr, std::size_t size) noexcept override { m_Region.deallocate(ptr, size); }
+    };
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestMemResource, staticReusesReleasedBlocks) {
+    StaticMemResource<1024> res;
+
+    auto first{res.allocate(100)};
+    auto used{res.getUsed()};
+    res.deallocate(first, 100);
+    auto second{res.allocate(120)};
+
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(used, res.getUsed());
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(second) % alignof(std::max_align_t));
+}
+
+TEST_F(TestMemResource, staticIsExhausted) {
+    StaticMemResource<1024> res;
+
+    res.allocate(512);
+    res.allocate(512);
+
+    ASSERT_THROW(res.allocate(1), std::bad_alloc);
+}
+
+TEST_F(TestMemResource, defaultIsNewDelete) {
+    auto& res{getMemResource()};
+    auto ptr{res.allocate(16)};
+    res.deallocate(ptr, 16);
+
+    ASSERT_EQ(nullptr, dynamic_cast<StaticMemResource<1024>*>(&res));
+}
+
+TEST_F(TestMemResource, oversizeTakesMemoryFromResource) {
+    // pretend the pool has no blocks yet, other tests have filled it
+    auto& slot{details::memResource()};
+    auto saved{slot.exchange(0)};
+
+    CountingResource res;
+    ASSERT_TRUE(setMemResource(&res));
+    ASSERT_EQ(&res, &getMemResource());
+    {
+        PooledString big(128 * 1024, 'x'); // larger than the largest size class, not pooled
+        ASSERT_EQ('x', big.back());
+    }
+    ASSERT_EQ(1, res.allocs.load());
+
+    // nothing pooled, so it may still be switched
+    ASSERT_TRUE(setMemResource(nullptr));
+    PooledString big(128 * 1024, 'y');
+    ASSERT_EQ(1, res.allocs.load());
+
+    slot.store(saved);
+}
+
+TEST_F(TestMemResource, poolPinsResource) {
+    PooledString msg(1000, 'x'); // pooled block, the pool keeps blocks of the current resource
+
+    CountingResource res;
+    ASSERT_FALSE(setMemResource(&res));
+    ASSERT_NE(&res, &getMemResource());
+
+    PooledString big(128 * 1024, 'y');
+    ASSERT_EQ(0, res.allocs.load());
+}
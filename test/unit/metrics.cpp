@@ -0,0 +1,154 @@
+/**
+ * @file metrics.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <utility>
+#include <errno.h>
+
+#include "metrics.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestMetrics : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestMetrics, bucketOf) {
+    ASSERT_EQ(0u, ShardHist::bucketOf(0));
+    ASSERT_EQ(1u, ShardHist::bucketOf(1));
+    ASSERT_EQ(2u, ShardHist::bucketOf(2));
+    ASSERT_EQ(2u, ShardHist::bucketOf(3));
+    ASSERT_EQ(11u, ShardHist::bucketOf(1024));
+    ASSERT_EQ(MetricsMng::LATENCY_BUCKETS - 1, ShardHist::bucketOf(UINT64_MAX));
+}
+
+TEST_F(TestMetrics, percentile) {
+    ShardHist shard;
+    for (int i = 0; i < 90; ++i)
+        shard.record(100);
+    for (int i = 0; i < 10; ++i)
+        shard.record(5000);
+
+    LatencyHist hist{};
+    shard.addTo(hist);
+
+    ASSERT_EQ(100u, hist.count);
+    ASSERT_EQ(90u * 100 + 10u * 5000, hist.sumNs);
+    ASSERT_EQ(128u, hist.percentile(0.5));
+    ASSERT_EQ(8192u, hist.percentile(0.99));
+    ASSERT_EQ(0u, LatencyHist{}.percentile(0.5));
+}
+
+TEST_F(TestMetrics, shardsOfAllThreadsAreSummed) {
+    SendCounters counters;
+    counters.incSent(10);
+
+    std::thread other{[&]() {
+        counters.incSent(20);
+        counters.incDropped();
+    }};
+    other.join(); // counts outlive their thread
+
+    auto stats{counters.get()};
+    ASSERT_EQ(2u, stats.sent);
+    ASSERT_EQ(1u, stats.dropped);
+
+    Metrics metrics{};
+    counters.collect(metrics);
+    ASSERT_EQ(30u, metrics.bytes);
+}
+
+TEST_F(TestMetrics, shardsOnOwnCacheLines) {
+    Shards<SendShard> shards;
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(&shards.local()) % SendShard::CACHE_LINE);
+
+    std::thread other{[&]() { ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(&shards.local()) % SendShard::CACHE_LINE); }};
+    other.join();
+
+    auto msgs{makePooled<MsgShard>()};
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(msgs.get()) % MsgShard::CACHE_LINE);
+}
+
+TEST_F(TestMetrics, shardsOfExitedThreadsAreFolded) {
+    Shards<SendShard> shards;
+    for (auto i = 0; i < 32; ++i) {
+        std::thread{[&]() {
+            shards.local().sent.add(2);
+            shards.local().byErrno[3].add();
+        }}.join();
+    }
+
+    auto sum = [&]() {
+        uint64_t sent{0};
+        uint64_t errs{0};
+        shards.forEach([&](const SendShard& shard) { 
+            sent += shard.sent.get(); 
+            errs += shard.byErrno[3].get(); 
+        });
+        return std::make_pair(sent, errs);
+    };
+
+    // collection cost follows live threads, counts of exited ones are kept
+    ASSERT_EQ(std::make_pair(uint64_t{64}, uint64_t{32}), sum());
+    ASSERT_EQ(0u, shards.size());
+    ASSERT_EQ(std::make_pair(uint64_t{64}, uint64_t{32}), sum());
+
+    shards.local().sent.add();
+    ASSERT_EQ(std::make_pair(uint64_t{65}, uint64_t{32}), sum());
+    ASSERT_EQ(1u, shards.size());
+}
+
+TEST_F(TestMetrics, errorsPerErrno) {
+    SendCounters counters;
+    counters.incErrors(ECONNREFUSED);
+    counters.incErrors(ECONNREFUSED);
+    counters.incErrors(10054); // WSAECONNRESET
+    counters.setQueueDepth(3);
+
+    Metrics metrics{};
+    counters.collect(metrics);
+
+    ASSERT_EQ(3u, metrics.send.errors);
+    ASSERT_EQ(2u, metrics.errors.size());
+    ASSERT_EQ(ECONNREFUSED, metrics.errors[0].first);
+    ASSERT_EQ(2u, metrics.errors[0].second);
+    int other{MetricsMng::OTHER_ERRNO};
+    ASSERT_EQ(other, metrics.errors[1].first);
+    ASSERT_EQ(3u, metrics.queueDepth);
+}
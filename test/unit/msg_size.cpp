@@ -0,0 +1,69 @@
+/**
+ * @file msg_size.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include "msg_size.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestUTF8Cut : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestUTF8Cut, ascii) {
+    ASSERT_EQ(4u, utf8Cut("test", 4, 8));
+    ASSERT_EQ(4u, utf8Cut("test", 4, 4));
+    ASSERT_EQ(2u, utf8Cut("test", 4, 2));
+    ASSERT_EQ(0u, utf8Cut("test", 4, 0));
+}
+
+TEST_F(TestUTF8Cut, multiByte) {
+    const char* text{"a\xd0\x96\xe2\x82\xac\xf0\x9f\x98\x80"}; // a, U+0416, U+20AC, U+1F600
+
+    ASSERT_EQ(1u, utf8Cut(text, 10, 1));
+    ASSERT_EQ(1u, utf8Cut(text, 10, 2));
+    ASSERT_EQ(3u, utf8Cut(text, 10, 3));
+    ASSERT_EQ(3u, utf8Cut(text, 10, 4));
+    ASSERT_EQ(3u, utf8Cut(text, 10, 5));
+    ASSERT_EQ(6u, utf8Cut(text, 10, 6));
+    ASSERT_EQ(6u, utf8Cut(text, 10, 9));
+    ASSERT_EQ(10u, utf8Cut(text, 10, 10));
+}
+
+TEST_F(TestUTF8Cut, correlationId) {
+    ASSERT_NE(nextCorrelationId(), nextCorrelationId());
+}
@@ -0,0 +1,118 @@
+/**
+ * @file mt_prof.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <chrono>
+
+#include "tmode.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestMTProf : public ::testing::Test {
+protected:
+    mt_prof m_Mode;
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestMTProf, config) {
+    m_Mode.lock();
+    m_Mode.unlock();
+
+    auto profile{m_Mode.getLockProfile()};
+    ASSERT_EQ(1u, profile.wait[LockSiteMng::LS_CONFIG].count);
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_CONFIG].count);
+}
+
+TEST_F(TestMTProf, holdPerSite) {
+    for (auto i = 0; i < 4; ++i)
+        m_Mode.lockRec(); // nested ones are not timed
+
+    m_Mode.enter(LockSiteMng::LS_HEADER);
+    m_Mode.enter(LockSiteMng::LS_SEND);
+    m_Mode.unlockRec();
+    m_Mode.unlockRec(); // not owned
+
+    auto profile{m_Mode.getLockProfile()};
+    ASSERT_EQ(1u, profile.wait[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_HEADER].count);
+    ASSERT_EQ(0u, profile.hold[LockSiteMng::LS_FORMATTERS].count);
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_SEND].count);
+}
+
+TEST_F(TestMTProf, otherThreadsAreIgnored) {
+    m_Mode.lockRec();
+
+    std::thread other{[&]() { m_Mode.enter(LockSiteMng::LS_SEND); }};
+    other.join();
+
+    m_Mode.unlockRec();
+
+    auto profile{m_Mode.getLockProfile()};
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_EQ(0u, profile.hold[LockSiteMng::LS_SEND].count);
+}
+
+TEST_F(TestMTProf, waitIsRecorded) {
+    m_Mode.lockRec();
+
+    std::thread other{[&]() { 
+        m_Mode.lockRec(); 
+        m_Mode.unlockRec();
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    m_Mode.unlockRec();
+    other.join();
+
+    auto profile{m_Mode.getLockProfile()};
+    ASSERT_EQ(2u, profile.wait[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_EQ(2u, profile.hold[LockSiteMng::LS_ASSEMBLY].count);
+}
+
+TEST_F(TestMTProf, otherPoliciesAreEmpty) {
+    mt mode;
+    mode.lockRec();
+    mode.enter(LockSiteMng::LS_SEND);
+    mode.unlockRec();
+
+    ASSERT_EQ(0u, mode.getLockProfile().hold[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_FALSE(mode.profilesLocks());
+    ASSERT_FALSE(st{}.profilesLocks());
+    ASSERT_TRUE(m_Mode.profilesLocks());
+}
@@ -0,0 +1,149 @@
+/**
+ * @file parser.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "parser.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestParser : public ::testing::Test {
+protected:
+    std::string m_Rec;
+    ParsedMsg   m_Msg;
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    /**
+     * Parse copy of record, fields refer to it
+     */
+    bool parse(const std::string& rec) { 
+        m_Rec = rec;
+        return parseMsg(m_Rec.data(), m_Rec.size(), m_Msg); 
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestParser, rfc5424) {
+    std::string rec{
+        "<165>1 2003-10-11T22:14:15.003Z mymachine.example.com evntslog - ID47 "
+        "[exampleSDID@32473 iut=\"3\" eventSource=\"Application\"] An application event"
+    };
+    ASSERT_TRUE(parse(rec));
+    ASSERT_EQ(ParserMng::MF_RFC5424, m_Msg.format);
+    ASSERT_EQ(165, m_Msg.pri);
+    ASSERT_EQ(20, m_Msg.getFacility());
+    ASSERT_EQ(5, m_Msg.getSeverity());
+    ASSERT_EQ(1, m_Msg.version);
+    ASSERT_TRUE(m_Msg.timestamp.equals("2003-10-11T22:14:15.003Z"));
+    ASSERT_TRUE(m_Msg.host.equals("mymachine.example.com"));
+    ASSERT_TRUE(m_Msg.app.equals("evntslog"));
+    ASSERT_TRUE(m_Msg.procId.empty());
+    ASSERT_TRUE(m_Msg.msgId.equals("ID47"));
+    ASSERT_TRUE(m_Msg.sd.equals("[exampleSDID@32473 iut=\"3\" eventSource=\"Application\"]"));
+    ASSERT_TRUE(m_Msg.msg.equals("An application event"));
+    ASSERT_EQ(m_Rec.data() + m_Rec.size() - m_Msg.msg.size, m_Msg.msg.data); // not copied
+}
+
+TEST_F(TestParser, rfc5424Nil) {
+    ASSERT_TRUE(parse("<34>1 - - - - - -"));
+    ASSERT_EQ(ParserMng::MF_RFC5424, m_Msg.format);
+    ASSERT_TRUE(m_Msg.timestamp.empty());
+    ASSERT_TRUE(m_Msg.host.empty());
+    ASSERT_TRUE(m_Msg.sd.empty());
+    ASSERT_TRUE(m_Msg.msg.empty());
+}
+
+TEST_F(TestParser, rfc3164) {
+    ASSERT_TRUE(parse("<34>Oct  1 22:14:15 mymachine su[230]: 'su root' failed for lonvick\n"));
+    ASSERT_EQ(ParserMng::MF_RFC3164, m_Msg.format);
+    ASSERT_TRUE(m_Msg.timestamp.equals("Oct  1 22:14:15"));
+    ASSERT_TRUE(m_Msg.host.equals("mymachine"));
+    ASSERT_TRUE(m_Msg.app.equals("su"));
+    ASSERT_TRUE(m_Msg.procId.equals("230"));
+    ASSERT_TRUE(m_Msg.msg.equals("'su root' failed for lonvick"));
+}
+
+TEST_F(TestParser, bare) {
+    ASSERT_TRUE(parse("<190> [cpp-syslog-client pid=\"12\"][meta sequenceId=\"1\"] message text"));
+    ASSERT_EQ(ParserMng::MF_BARE, m_Msg.format);
+    ASSERT_EQ(190, m_Msg.pri);
+    ASSERT_TRUE(m_Msg.sd.equals("[cpp-syslog-client pid=\"12\"][meta sequenceId=\"1\"]"));
+    ASSERT_TRUE(m_Msg.msg.equals("message text"));
+
+    ASSERT_TRUE(parse("<190> 1 message with no structured data"));
+    ASSERT_EQ(ParserMng::MF_BARE, m_Msg.format);
+    ASSERT_TRUE(m_Msg.sd.empty());
+    ASSERT_TRUE(m_Msg.msg.equals("1 message with no structured data"));
+}
+
+TEST_F(TestParser, badPri) {
+    ASSERT_FALSE(parse(""));
+    ASSERT_FALSE(parse("no pri"));
+    ASSERT_FALSE(parse("<>1 - - - - - -"));
+    ASSERT_FALSE(parse("<192> too big"));
+    ASSERT_FALSE(parse("<1900> too long"));
+    ASSERT_FALSE(parse("<13"));
+}
+
+TEST_F(TestParser, unterminatedElementIsMessage) {
+    ASSERT_TRUE(parse("<13> [id k=\"v] text"));
+    ASSERT_TRUE(m_Msg.sd.empty());
+    ASSERT_TRUE(m_Msg.msg.equals("[id k=\"v] text"));
+}
+
+TEST_F(TestParser, sdElementsAndParams) {
+    ASSERT_TRUE(parse("<13> [a k=\"v\\\"]\" n=\"1\"][b][c x=\"\"] text"));
+
+    std::vector<std::string> ids;
+    std::vector<std::pair<std::string, std::string>> params;
+    forEachSDElement(m_Msg.sd, [&](StrRef id, StrRef elemParams) {
+        ids.push_back(id.str());
+        forEachSDParam(elemParams, [&](StrRef name, StrRef value) { params.emplace_back(name.str(), value.str()); });
+    });
+
+    ASSERT_EQ((std::vector<std::string>{"a", "b", "c"}), ids);
+    ASSERT_EQ(3u, params.size());
+    ASSERT_EQ("k", params[0].first);
+    ASSERT_EQ("v\\\"]", params[0].second); // raw, escapes kept
+    ASSERT_EQ("n", params[1].first);
+    ASSERT_EQ("1", params[1].second);
+    ASSERT_EQ("x", params[2].first);
+    ASSERT_EQ("", params[2].second);
+    ASSERT_TRUE(m_Msg.msg.equals("text"));
+}
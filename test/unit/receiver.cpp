@@ -0,0 +1,179 @@
+/**
+ * @file receiver.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include "receiver.hpp"
+#include "parser.hpp"
+#include "client_impl.hpp"
+#include "ostream.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestReceiver : public ::testing::Test {
+protected:
+    static constexpr int WAIT_MS{2000}; ///< loopback is fast, it's just a guard
+protected:
+    std::vector<std::string> m_Records;
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    /**
+     * Poll receiver until count records are taken
+     */
+    template<class Receiver>
+    void take(Receiver& recv, std::size_t count) {
+        auto deadline{std::chrono::steady_clock::now() + std::chrono::milliseconds{WAIT_MS}};
+        while (m_Records.size() < count && std::chrono::steady_clock::now() < deadline)
+            recv.poll(10, [this](const char* data, std::size_t size) { m_Records.emplace_back(data, size); });
+    }
+
+    /**
+     * Connect to TCP receiver
+     */
+    static int connectTCP(uint16_t port) {
+        auto sock{socket(AF_INET, SOCK_STREAM, 0)};
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        EXPECT_EQ(0, connect(sock, (sockaddr*)&addr, sizeof(addr)));
+        return sock;
+    }
+
+    static void send(int sock, const std::string& data) {
+        ASSERT_EQ(static_cast<ssize_t>(data.size()), write(sock, data.data(), data.size()));
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestReceiver, udp) {
+    UDPReceiver recv{ReceiverMng::DEFAULT_ADDR, 0, 8};
+    ASSERT_TRUE(recv.isInitialised());
+    ASSERT_NE(0, recv.getPort());
+
+    basic_ostream<st> syslog{std::make_unique<UDPClient>(), std::make_unique<st>()};
+    syslog.setPort(recv.getPort());
+    for (auto i = 0; i < 100; ++i)
+        syslog << LogLvlMng::LL_INFO << "message " << i << std::flush;
+
+    take(recv, 100);
+    ASSERT_EQ(100u, m_Records.size());
+    ASSERT_EQ(100u, recv.getStats().records);
+    ASSERT_LT(recv.getStats().calls, 100u); // batched
+
+    ParsedMsg msg;
+    ASSERT_TRUE(parseMsg(m_Records[99].data(), m_Records[99].size(), msg));
+    ASSERT_EQ(LogLvlMng::LL_INFO, msg.getSeverity());
+    ASSERT_FALSE(msg.sd.empty());
+    ASSERT_TRUE(msg.msg.equals("message 99"));
+}
+
+TEST_F(TestReceiver, udpTruncated) {
+    UDPReceiver recv{ReceiverMng::DEFAULT_ADDR, 0, 4, 16};
+    basic_ostream<st> syslog{std::make_unique<UDPClient>(), std::make_unique<st>()};
+    syslog.setPort(recv.getPort());
+    syslog << "a message longer than slot" << std::flush;
+
+    take(recv, 1);
+    ASSERT_EQ(1u, m_Records.size());
+    ASSERT_EQ(16u, m_Records[0].size());
+    ASSERT_EQ(1u, recv.getStats().truncated);
+}
+
+TEST_F(TestReceiver, udpReusePort) {
+    UDPReceiver first{ReceiverMng::DEFAULT_ADDR, 0, 8, ReceiverMng::DEFAULT_MAX_MSG_SIZE, true};
+    ASSERT_TRUE(first.isInitialised());
+    UDPReceiver second{ReceiverMng::DEFAULT_ADDR, first.getPort(), 8, ReceiverMng::DEFAULT_MAX_MSG_SIZE, true};
+    ASSERT_TRUE(second.isInitialised());
+    ASSERT_EQ(first.getPort(), second.getPort());
+}
+
+TEST_F(TestReceiver, tcpFraming) {
+    TCPReceiver recv;
+    ASSERT_TRUE(recv.isInitialised());
+
+    auto sock{connectTCP(recv.getPort())};
+    send(sock, "10 <13> first");
+    send(sock, "<13> second\n<13> thi");
+    send(sock, "rd\r\n\n11 <13> fourth");
+
+    take(recv, 4);
+    close(sock);
+    ASSERT_EQ((std::vector<std::string>{"<13> first", "<13> second", "<13> third", "<13> fourth"}), m_Records);
+    ASSERT_EQ(1u, recv.getConnCount());
+}
+
+TEST_F(TestReceiver, tcpManyConnections) {
+    TCPReceiver recv;
+    std::vector<int> socks;
+    for (auto i = 0; i < 4; ++i)
+        socks.push_back(connectTCP(recv.getPort()));
+    for (auto sock : socks)
+        send(sock, "<13> message\n");
+
+    take(recv, 4);
+    for (auto sock : socks)
+        close(sock);
+    ASSERT_EQ(4u, m_Records.size());
+
+    recv.poll(100, [](const char*, std::size_t) {});
+    ASSERT_EQ(0u, recv.getConnCount());
+}
+
+TEST_F(TestReceiver, tcpOversized) {
+    TCPReceiver recv{ReceiverMng::DEFAULT_ADDR, 0, 8};
+
+    auto sock{connectTCP(recv.getPort())};
+    send(sock, "<13> too long record\n<13> ok\n");
+    take(recv, 2);
+    ASSERT_EQ((std::vector<std::string>{"<13> too", "<13> ok"}), m_Records);
+    ASSERT_EQ(1u, recv.getStats().truncated);
+
+    send(sock, "100 <13> octet counted record longer than max");
+    recv.poll(100, [](const char*, std::size_t) {});
+    ASSERT_EQ(0u, recv.getConnCount()); // framing can't be recovered
+    close(sock);
+}
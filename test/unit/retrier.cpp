@@ -0,0 +1,106 @@
+/**
+ * @file retrier.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "retrier.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestRetrier : public ::testing::Test {
+protected:
+    int32_t     m_Sock;
+    sockaddr_in m_To;
+protected:
+    void SetUp() { 
+        m_Sock = socket(AF_INET, SOCK_DGRAM, 0);
+        m_To.sin_family = AF_INET;
+        m_To.sin_port = htons(514);
+        m_To.sin_addr.s_addr = inet_addr("127.0.0.1");
+    }
+
+    void TearDown() { close(m_Sock); }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestRetrier, retryOnce) {
+    auto counters{std::make_shared<SendCounters>()};
+    {
+        Retrier retrier{m_Sock, counters};
+        ASSERT_TRUE(retrier.push("test data", 9, m_To));
+    }
+
+    ASSERT_EQ(1u, counters->get().retried);
+    ASSERT_EQ(0u, counters->get().dropped);
+}
+
+TEST_F(TestRetrier, queueIsBounded) {
+    auto counters{std::make_shared<SendCounters>()};
+    {
+        Retrier retrier{m_Sock, counters, 0};
+        ASSERT_FALSE(retrier.push("test data", 9, m_To));
+    }
+
+    ASSERT_EQ(0u, counters->get().retried);
+}
+
+TEST_F(TestRetrier, shutdownDrainIsBounded) {
+    // socket that never becomes writable, so each retry waits for the whole poll timeout
+    int pair[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_DGRAM, 0, pair));
+    fcntl(pair[0], F_SETFL, fcntl(pair[0], F_GETFL) | O_NONBLOCK);
+    std::string data(1024, 'x');
+    while (send(pair[0], data.data(), data.size(), 0) > 0)
+        ;
+
+    auto counters{std::make_shared<SendCounters>()};
+    auto start{std::chrono::steady_clock::now()};
+    {
+        Retrier retrier{pair[0], counters};
+        for (auto i = 0; i < 1024; ++i)
+            ASSERT_TRUE(retrier.push(data.data(), data.size(), m_To));
+    }
+    auto elapsed{std::chrono::steady_clock::now() - start};
+    close(pair[0]);
+    close(pair[1]);
+
+    ASSERT_GT(std::chrono::seconds(1), elapsed);
+    ASSERT_EQ(1024u, counters->get().retried + counters->get().dropped);
+}
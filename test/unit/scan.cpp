@@ -0,0 +1,155 @@
+/**
+ * @file scan.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <random>
+#include <memory>
+#include <chrono>
+
+#include "scan.hpp"
+#include "client_impl.hpp"
+#include "ostream.hpp"
+#include "local_sink.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestScan : public ::testing::TestWithParam<int> {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    const ScanKernels& kernels() const noexcept { return scanKernels(GetParam()); }
+};
+
+INSTANTIATE_TEST_SUITE_P(Kernels, TestScan, ::testing::Values(ScanMng::SK_SCALAR, ScanMng::SK_SSE2, ScanMng::SK_AVX2));
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_P(TestScan, kindFallsBack) {
+    ASSERT_LE(kernels().kind, GetParam());
+    ASSERT_LE(scanKernels().kind, ScanMng::SK_AVX2);
+}
+
+TEST_P(TestScan, everyPosition) {
+    // hit at each offset of each length crosses block boundaries and tails
+    for (std::size_t size = 0; size < 80; ++size) {
+        for (std::size_t pos = 0; pos <= size; ++pos) {
+            for (char ch : {'"', '\\', ']'}) {
+                std::string text(size, 'x');
+                if (pos < size)
+                    text[pos] = ch;
+                ASSERT_EQ(pos, kernels().findSDSpecial(text.data(), size));
+            }
+            for (char ch : {'\0', '\n', '\x1F', '\x7F', '\x80', '\xFF'}) {
+                std::string text(size, '~');
+                if (pos < size)
+                    text[pos] = ch;
+                ASSERT_EQ(pos, kernels().findNonPrintable(text.data(), size));
+            }
+        }
+    }
+}
+
+TEST_P(TestScan, sameAsScalar) {
+    static const char CHARS[]{"ab \"\\]\x01\x1F\x20\x7E\x7F\x80\xC3\xA9\xFF"};
+    std::mt19937 rng{42};
+    for (auto i = 0; i < 20000; ++i) {
+        std::string text(rng() % 200, 'a');
+        for (auto& ch : text)
+            ch = CHARS[rng() % (sizeof(CHARS) - 1)];
+
+        ASSERT_EQ(findSDSpecialScalar(text.data(), text.size()), kernels().findSDSpecial(text.data(), text.size()));
+        ASSERT_EQ(findNonPrintableScalar(text.data(), text.size()), kernels().findNonPrintable(text.data(), text.size()));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST(TestUTF8, seqLen) {
+    ASSERT_EQ(1u, utf8SeqLen("a", 1));
+    ASSERT_EQ(2u, utf8SeqLen("\xC3\xA9", 2));
+    ASSERT_EQ(3u, utf8SeqLen("\xE2\x82\xAC", 3));
+    ASSERT_EQ(4u, utf8SeqLen("\xF0\x9F\x98\x80", 4));
+
+    ASSERT_EQ(0u, utf8SeqLen("", 0));
+    ASSERT_EQ(0u, utf8SeqLen("\x80", 1)); // continuation
+    ASSERT_EQ(0u, utf8SeqLen("\xC0\xAF", 2)); // overlong
+    ASSERT_EQ(0u, utf8SeqLen("\xE0\x80\xAF", 3)); // overlong
+    ASSERT_EQ(0u, utf8SeqLen("\xED\xA0\x80", 3)); // surrogate
+    ASSERT_EQ(0u, utf8SeqLen("\xF4\x90\x80\x80", 4)); // above U+10FFFF
+    ASSERT_EQ(0u, utf8SeqLen("\xE2\x82", 2)); // truncated
+    ASSERT_EQ(0u, utf8SeqLen("\xC3\x41", 2));
+}
+
+TEST(TestUTF8, sanitize) {
+    std::string text{"caf\xC3\xA9 \xE2\x82\xAC"};
+    ASSERT_EQ(text.size(), findDirty(text.data(), text.size()));
+
+    std::string out;
+    text = "a\tb\x01" "c\xFF\xFE" "d\xED\xA0\x80" "e\xE2\x82";
+    appendSanitized(out, text.data(), text.size());
+    ASSERT_EQ("a b c\xEF\xBF\xBD\xEF\xBF\xBD" "d\xEF\xBF\xBD" "e\xEF\xBF\xBD", out);
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST(TestSanitize, client) {
+    LocalSink sink;
+    basic_ostream<st> syslog{std::make_unique<UDPClient>(), std::make_unique<st>()};
+    syslog.setPort(sink.getPort());
+    syslog.cleanFormatters();
+
+    syslog << "raw\tline\xFF" << std::endl;
+    syslog.setSanitize(true);
+    syslog << "raw\tline\xFF" << std::endl;
+    syslog << "clean line" << std::endl;
+    syslog << kv("k", "a]b") << "params" << std::flush;
+
+    ASSERT_TRUE(sink.waitFor(4, std::chrono::milliseconds{2000}));
+    auto records{sink.take()};
+    ASSERT_EQ(4u, records.size());
+
+    SinkFields fields;
+    ASSERT_TRUE(LocalSink::parse(records[0].data.data(), records[0].data.size(), fields));
+    ASSERT_EQ("raw\tline\xFF\n", fields.msg);
+    ASSERT_TRUE(LocalSink::parse(records[1].data.data(), records[1].data.size(), fields));
+    ASSERT_EQ("raw line\xEF\xBF\xBD", fields.msg);
+    ASSERT_TRUE(LocalSink::parse(records[2].data.data(), records[2].data.size(), fields));
+    ASSERT_EQ("clean line", fields.msg);
+    ASSERT_TRUE(LocalSink::parse(records[3].data.data(), records[3].data.size(), fields));
+    ASSERT_EQ("[cpp-syslog@32473 k=\"a\\]b\"]", fields.sd);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file sd.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "sd.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestSD : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestSD, appendSDName) {
+    std::string out;
+    appendSDName(out, "req_id", 6, 32);
+    ASSERT_EQ("req_id", out);
+
+    out.clear();
+    appendSDName(out, "a b=c]d\"e\x01", 10, 32);
+    ASSERT_EQ("a_b_c_d_e_", out);
+
+    out.clear();
+    appendSDName(out, "abcdef", 6, 4);
+    ASSERT_EQ("abcd", out);
+}
+
+TEST_F(TestSD, escapeSDValue) {
+    std::string out{"]\"a\"b\\c]d"};
+    escapeSDValue(out, 1);
+    ASSERT_EQ("]\\\"a\\\"b\\\\c\\]d", out);
+
+    out = "plain";
+    escapeSDValue(out, 0);
+    ASSERT_EQ("plain", out);
+}
+
+TEST_F(TestSD, appendSDParam) {
+    std::string out{"[id"};
+    appendSDParam(out, "num", 3, -42);
+    appendSDParam(out, "str", 3, std::string{"say \"hi\""});
+    appendSDParam(out, "ch", 2, ']');
+
+    ASSERT_EQ("[id num=\"-42\" str=\"say \\\"hi\\\"\" ch=\"\\]\"", out);
+}
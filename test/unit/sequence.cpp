@@ -0,0 +1,182 @@
+/**
+ * @file sequence.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <memory>
+#include <chrono>
+
+#include "sequence.hpp"
+#include "client_impl.hpp"
+#include "ostream.hpp"
+#include "local_sink.hpp"
+#include "seq_check.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestSequencer : public ::testing::Test {
+protected:
+    Sequencer    m_Seq;
+    PooledString m_Out;
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    /**
+     * Render next elements
+     */
+    std::string next() {
+        m_Seq.render(m_Out, SDMng::DEFAULT_SD_ID);
+        return std::string{m_Out.data(), m_Out.size()};
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestSequencer, offByDefault) {
+    ASSERT_FALSE(m_Seq.isOn());
+    m_Seq.setOn(true);
+    ASSERT_TRUE(m_Seq.isOn());
+}
+
+TEST_F(TestSequencer, render) {
+    ASSERT_EQ("[meta sequenceId=\"1\"][cpp-syslog-seq@32473 thread=\"1\" seq=\"1\"]", next());
+    ASSERT_EQ("[meta sequenceId=\"2\"][cpp-syslog-seq@32473 thread=\"1\" seq=\"2\"]", next());
+}
+
+TEST_F(TestSequencer, perThread) {
+    next();
+
+    std::string other;
+    std::thread{[&]() { other = next(); }}.join();
+    ASSERT_EQ("[meta sequenceId=\"2\"][cpp-syslog-seq@32473 thread=\"2\" seq=\"1\"]", other);
+    ASSERT_EQ("[meta sequenceId=\"3\"][cpp-syslog-seq@32473 thread=\"1\" seq=\"2\"]", next());
+}
+
+TEST_F(TestSequencer, enterpriseNumberOfSDId) {
+    m_Seq.render(m_Out, "app@12345");
+    ASSERT_EQ("[meta sequenceId=\"1\"][cpp-syslog-seq@12345 thread=\"1\" seq=\"1\"]", std::string(m_Out.data(), m_Out.size()));
+}
+
+TEST_F(TestSequencer, wrap) {
+    uint64_t max{SequenceMng::MAX_SEQUENCE_ID};
+    ASSERT_EQ(1u, Sequencer::toSequenceId(0));
+    ASSERT_EQ(max, Sequencer::toSequenceId(max - 1));
+    ASSERT_EQ(1u, Sequencer::toSequenceId(max));
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestSeqChecker : public ::testing::Test {
+protected:
+    SeqChecker m_Checker;
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+
+    void add(uint64_t id, uint64_t thread, uint64_t seq) {
+        auto rec{
+            "<190> [meta sequenceId=\"" + std::to_string(id) + "\"][cpp-syslog-seq@12345 thread=\"" + 
+            std::to_string(thread) + "\" seq=\"" + std::to_string(seq) + "\"] message"
+        };
+        m_Checker.onRecord(rec.data(), rec.size());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestSeqChecker, inOrder) {
+    for (uint64_t i = 1; i <= 10; ++i)
+        add(i, 1, i);
+
+    ASSERT_EQ(10u, m_Checker.getClient().received);
+    ASSERT_EQ(0u, m_Checker.getClient().missing);
+    ASSERT_EQ(0u, m_Checker.getClient().reordered);
+    ASSERT_EQ(1u, m_Checker.getThreadCount());
+}
+
+TEST_F(TestSeqChecker, gapsReorderingAndDups) {
+    add(1, 1, 1);
+    add(4, 1, 4); // 2 and 3 are missing
+    add(2, 1, 2); // late
+    add(2, 1, 2);
+    add(6, 2, 1);
+
+    auto client{m_Checker.getClient()};
+    ASSERT_EQ(4u, client.received);
+    ASSERT_EQ(2u, client.missing); // 3 and 5
+    ASSERT_EQ(1u, client.reordered);
+    ASSERT_EQ(1u, client.dups);
+
+    auto threads{m_Checker.getThreads()};
+    ASSERT_EQ(4u, threads.received);
+    ASSERT_EQ(1u, threads.missing); // 3 of thread 1
+    ASSERT_EQ(1u, threads.reordered);
+    ASSERT_EQ(2u, m_Checker.getThreadCount());
+}
+
+TEST_F(TestSeqChecker, unnumbered) {
+    std::string rec{"<190> [cpp-syslog-client pid=\"1\"] message"};
+    m_Checker.onRecord(rec.data(), rec.size());
+    ASSERT_EQ(1u, m_Checker.getUnnumbered());
+    ASSERT_EQ(0u, m_Checker.getClient().received);
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST(TestSequence, client) {
+    SeqChecker checker;
+    LocalSink sink{LocalSink::P_UDP, false, [&checker](const char* data, std::size_t size, uint64_t) { checker.onRecord(data, size); }};
+    basic_ostream<mt> syslog{std::make_unique<UDPClient>(), std::make_unique<mt>()};
+    syslog.setPort(sink.getPort());
+
+    syslog << "not numbered" << std::flush;
+    syslog.setSequence(true);
+    for (auto i = 0; i < 50; ++i)
+        syslog << kv("i", i) << "message " << i << std::flush;
+    std::thread{[&]() { syslog.log(LogLvlMng::LL_INFO, SYSLOG_FMT("from {}"), "thread"); }}.join();
+
+    ASSERT_TRUE(sink.waitFor(52, std::chrono::milliseconds{2000}));
+
+    ASSERT_EQ(1u, checker.getUnnumbered());
+    ASSERT_EQ(51u, checker.getClient().received);
+    ASSERT_EQ(0u, checker.getClient().missing);
+    ASSERT_EQ(2u, checker.getThreadCount());
+    ASSERT_EQ(51u, checker.getThreads().received);
+}
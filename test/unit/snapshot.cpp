@@ -0,0 +1,164 @@
+/**
+ * @file snapshot.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+#include "snapshot.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestSnapshot : public ::testing::Test {
+protected:
+    struct Pair {
+        int first;
+        int second;
+    };
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestSnapshot, readAndUpdate) {
+    Snapshot<Pair> snapshot{Pair{1, 1}};
+
+    ASSERT_EQ(1, snapshot.read()->first);
+
+    snapshot.update([](Pair& pair) { pair.first = 2; });
+
+    ASSERT_EQ(2, snapshot.read()->first);
+    ASSERT_EQ(1, snapshot.read()->second);
+}
+
+TEST_F(TestSnapshot, pinnedObjectSurvivesUpdate) {
+    Snapshot<Pair> snapshot{Pair{1, 1}};
+
+    auto pinned{snapshot.read()};
+    snapshot.update([](Pair& pair) { pair.first = 2; });
+
+    ASSERT_EQ(1, pinned->first);
+    ASSERT_EQ(2, snapshot.read()->first);
+}
+
+TEST_F(TestSnapshot, readersSeeConsistentObject) {
+    Snapshot<Pair> snapshot{Pair{0, 0}};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> torn{false};
+
+    auto read = [&]() {
+        while (!stop) {
+            auto pair{snapshot.read()};
+            if (pair->first != pair->second)
+                torn = true;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (auto i = 0; i < 4; ++i)
+        readers.push_back(std::thread{read});
+
+    for (auto i = 1; i < 4096; ++i)
+        snapshot.update([i](Pair& pair) { pair.first = i; pair.second = i; });
+
+    stop = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    ASSERT_FALSE(torn);
+    ASSERT_EQ(4095, snapshot.read()->second);
+}
+
+TEST_F(TestSnapshot, nestedReadersOfThread) {
+    Snapshot<Pair> snapshot{Pair{1, 1}};
+    {
+        auto outer{snapshot.read()};
+        snapshot.update([](Pair& pair) { pair.first = 2; });
+        {
+            auto inner{snapshot.read()};
+            snapshot.update([](Pair& pair) { pair.first = 3; });
+            ASSERT_EQ(2, inner->first);
+        }
+
+        // outer reader keeps every object replaced since it was made
+        ASSERT_EQ(1, outer->first);
+        ASSERT_EQ(2u, snapshot.getRetired());
+    }
+
+    snapshot.update([](Pair& pair) { pair.first = 4; });
+    ASSERT_EQ(0u, snapshot.getRetired());
+    ASSERT_EQ(4, snapshot.read()->first);
+}
+
+TEST_F(TestSnapshot, retiredFreedUnderContinuousReads) {
+    Snapshot<Pair> snapshot{Pair{0, 0}};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> torn{false};
+
+    // each message takes its own reader, some thread is always reading
+    auto read = [&]() {
+        while (!stop) {
+            auto pair{snapshot.read()};
+            if (pair->first != pair->second)
+                torn = true;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (auto i = 0; i < 4; ++i)
+        readers.push_back(std::thread{read});
+
+    for (auto i = 1; i < 4096; ++i)
+        snapshot.update([i](Pair& pair) { pair.first = i; pair.second = i; });
+
+    // reclamation goes on while readers keep running, a preempted reader delays it for a while only
+    auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds{5}};
+    while (snapshot.getRetired() > 8 && std::chrono::steady_clock::now() < deadline) {
+        snapshot.update([](Pair&) { });
+        std::this_thread::yield();
+    }
+    auto retired{snapshot.getRetired()};
+
+    stop = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    ASSERT_FALSE(torn);
+    ASSERT_GE(8u, retired);
+    snapshot.update([](Pair&) { });
+    ASSERT_EQ(0u, snapshot.getRetired());
+}
@@ -0,0 +1,148 @@
+/**
+ * @file spsc_ring.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+
+#include "spsc_ring.hpp"
+
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestSpscRing : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestSpscRing, pooledIsAligned) {
+    auto ring{makePooled<SpscRing>(64)};
+    ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(ring.get()) % alignof(SpscRing));
+}
+
+TEST_F(TestSpscRing, pushAndPop) {
+    SpscRing ring{64};
+    std::size_t size{0};
+
+    ASSERT_EQ(nullptr, ring.front(size));
+
+    auto out{ring.reserve(3)};
+    ASSERT_NE(nullptr, out);
+    std::memcpy(out, "abc", 3);
+    ring.commit();
+
+    auto in{ring.front(size)};
+    ASSERT_NE(nullptr, in);
+    ASSERT_EQ(3, size);
+    ASSERT_EQ(0, std::memcmp(in, "abc", 3));
+
+    ring.release(size);
+    ASSERT_EQ(nullptr, ring.front(size));
+    ASSERT_EQ(0, ring.size());
+}
+
+TEST_F(TestSpscRing, full) {
+    SpscRing ring{64};
+
+    ASSERT_EQ(64, ring.capacity());
+    ASSERT_EQ(nullptr, ring.reserve(64));
+
+    for (auto i = 0; i < 4; ++i) {
+        ASSERT_NE(nullptr, ring.reserve(8));
+        ring.commit();
+    }
+
+    ASSERT_EQ(nullptr, ring.reserve(1));
+}
+
+TEST_F(TestSpscRing, recordNeverWraps) {
+    SpscRing ring{64};
+    std::size_t size{0};
+
+    for (auto i = 0; i < 100; ++i) {
+        auto out{ring.reserve(20)}; // 3 records of 32 bytes don't fit 64, so the end of ring is skipped
+        ASSERT_NE(nullptr, out);
+        std::memset(out, 'a' + i % 26, 20);
+        ring.commit();
+
+        auto in{ring.front(size)};
+        ASSERT_NE(nullptr, in);
+        ASSERT_EQ(20, size);
+        ASSERT_EQ('a' + i % 26, in[19]);
+        ring.release(size);
+    }
+}
+
+TEST_F(TestSpscRing, producerAndConsumer) {
+    static constexpr uint32_t N{100000};
+    SpscRing ring{256};
+
+    std::thread producer{
+        [&ring]() {
+            for (uint32_t i = 0; i < N; ) {
+                auto out{ring.reserve(sizeof(i) + i % 7)};
+                if (!out) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::memcpy(out, &i, sizeof(i));
+                ring.commit();
+                ++i;
+            }
+        }
+    };
+
+    uint32_t expected{0};
+    bool ordered{true};
+    std::size_t size{0};
+
+    while (expected < N) {
+        auto in{ring.front(size)};
+        if (!in) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint32_t i;
+        std::memcpy(&i, in, sizeof(i));
+        ordered = ordered && i == expected && size == sizeof(i) + i % 7;
+        ++expected;
+        ring.release(size);
+    }
+
+    producer.join();
+    ASSERT_TRUE(ordered);
+}
@@ -0,0 +1,694 @@
+/**
+ * @file streambuf.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <ostream>
+#include <vector>
+#include <mutex>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cmath>
+#include <set>
+#include <map>
+
+#include "streambuf.hpp"
+#include "ostream.hpp"
+#include "parser.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class FakeClient : public IClient {
+private:
+    std::vector<std::string>& m_Sent;
+    std::size_t               m_MaxMsgSize;
+public:
+    explicit FakeClient(std::vector<std::string>& sent) : m_Sent(sent), m_MaxMsgSize{1024} {}
+
+    void setAddr(const char*) noexcept override { }
+
+    void setPort(uint16_t) noexcept override { }
+
+    void setNonBlocking(bool) noexcept override { }
+
+    void setSndBuf(int32_t) noexcept override { }
+
+    void setRetry(bool) noexcept override { }
+
+    void setMaxMsgSize(std::size_t size) noexcept override { m_MaxMsgSize = size; }
+
+    std::size_t getMaxMsgSize() const noexcept override { return m_MaxMsgSize; }
+
+    int32_t getSock() const noexcept override { return 0; }
+
+    SendStats getStats() const noexcept override { return SendStats{m_Sent.size(), 0, 0, 0, 0}; }
+
+    bool isInitialised() const noexcept override { return true; }
+
+    void send(std::string&& buf) const noexcept override { m_Sent.emplace_back(std::move(buf)); }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestStreambuf : public ::testing::Test {
+protected:
+    std::vector<std::string> m_Sent;
+    streambuf                m_Buf{std::make_unique<FakeClient>(m_Sent), std::make_unique<st>()};
+    std::ostream             m_Os{&m_Buf};
+protected:
+    void SetUp() { m_Buf.cleanFormatters(); }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestStreambuf, send) {
+    m_Os << "test message" << std::endl;
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<191> test message\n", m_Sent[0]);
+}
+
+TEST_F(TestStreambuf, emptyMsg) {
+    m_Os << std::flush;
+
+    ASSERT_EQ(0u, m_Sent.size());
+}
+
+TEST_F(TestStreambuf, truncate) {
+    m_Buf.setMaxMsgSize(16);
+    m_Os << "test \xd0\x96\xd0\x96\xd0\x96 message" << std::flush;
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<191> test \xd0\x96...", m_Sent[0]);
+}
+
+TEST_F(TestStreambuf, noLimit) {
+    m_Buf.setMaxMsgSize(16);
+    m_Buf.setMsgSizePolicy(MsgSizeMng::MSP_NONE);
+    m_Os << "long test message" << std::flush;
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<191> long test message", m_Sent[0]);
+}
+
+TEST_F(TestStreambuf, split) {
+    m_Buf.setMaxMsgSize(100);
+    m_Buf.setMsgSizePolicy(MsgSizeMng::MSP_SPLIT);
+    m_Os << std::string(150, 'x') << std::flush;
+
+    ASSERT_EQ(4u, m_Sent.size());
+
+    std::string joined;
+    std::set<std::string> ids;
+    for (std::size_t i = 0; i < m_Sent.size(); ++i) {
+        ASSERT_GE(100u, m_Sent[i].size());
+
+        // correlation is a valid element of record structured data
+        ParsedMsg msg;
+        ASSERT_TRUE(parseMsg(m_Sent[i].data(), m_Sent[i].size(), msg));
+        std::map<std::string, std::string> params;
+        std::size_t elements{0};
+        forEachSDElement(msg.sd, [&](StrRef sdId, StrRef sdParams) {
+            ++elements;
+            ASSERT_EQ("cid@32473", sdId.str());
+            forEachSDParam(sdParams, [&](StrRef key, StrRef value) { params[key.str()] = value.str(); });
+        });
+
+        ASSERT_EQ(1u, elements);
+        ASSERT_EQ(std::to_string(i + 1), params["part"]);
+        ASSERT_EQ("4", params["total"]);
+        ids.insert(params["id"]);
+        joined += msg.msg.str();
+    }
+
+    ASSERT_EQ(1u, ids.size()); // same correlation ID
+    ASSERT_EQ(std::string(150, 'x'), joined);
+}
+
+TEST_F(TestStreambuf, splitAfterOtherElements) {
+    m_Buf.setSDId("app@12345");
+    m_Buf.setMaxMsgSize(120);
+    m_Buf.setMsgSizePolicy(MsgSizeMng::MSP_SPLIT);
+    m_Buf.addRecordParam("user", "max");
+    m_Os << std::string(100, 'x') << std::flush;
+
+    ASSERT_LT(1u, m_Sent.size());
+
+    ParsedMsg msg;
+    ASSERT_TRUE(parseMsg(m_Sent.back().data(), m_Sent.back().size(), msg));
+    std::vector<std::string> sdIds;
+    forEachSDElement(msg.sd, [&](StrRef sdId, StrRef) { sdIds.push_back(sdId.str()); });
+
+    ASSERT_EQ((std::vector<std::string>{"app@12345", "cid@12345"}), sdIds);
+    ASSERT_EQ(std::string::npos, msg.msg.str().find_first_not_of('x'));
+}
+
+#include <thread>
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+template<class Mode>
+class TestBasicStreambuf : public ::testing::Test {
+protected:
+    std::vector<std::string>    m_Sent;
+    basic_streambuf<Mode>       m_Buf{std::make_unique<FakeClient>(m_Sent), std::make_unique<Mode>()};
+    std::ostream                m_Os{&m_Buf};
+protected:
+    void SetUp() { m_Buf.cleanFormatters(); }
+
+    void TearDown() { }
+};
+
+using Modes = ::testing::Types<TMode, st, mt, spin, lf>;
+TYPED_TEST_SUITE(TestBasicStreambuf, Modes);
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TYPED_TEST(TestBasicStreambuf, send) {
+    this->m_Os << "test message " << 1 << std::endl;
+
+    ASSERT_EQ(1u, this->m_Sent.size());
+    ASSERT_EQ("<191> test message 1\n", this->m_Sent[0]);
+}
+
+TYPED_TEST(TestBasicStreambuf, moveAndSend) {
+    basic_streambuf<TypeParam> moved{std::move(this->m_Buf)};
+    std::ostream os{&moved};
+
+    os << "test message" << std::flush;
+
+    ASSERT_EQ(1u, this->m_Sent.size());
+    ASSERT_EQ("<191> test message", this->m_Sent[0]);
+}
+
+TEST(TestLFStreambuf, messagesAreNotMixed) {
+    std::vector<std::string> sent;
+    std::mutex mtx;
+
+    class LockedClient : public FakeClient {
+    private:
+        std::mutex& m_Mtx;
+    public:
+        LockedClient(std::vector<std::string>& sent, std::mutex& mtx) : FakeClient{sent}, m_Mtx(mtx) {}
+
+        void send(std::string&& buf) const noexcept override {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            FakeClient::send(std::move(buf));
+        }
+    };
+
+    basic_streambuf<lf> buf{std::make_unique<LockedClient>(sent, mtx), std::make_unique<lf>()};
+    buf.cleanFormatters();
+
+    auto f = [&](char ch) {
+        for (auto i = 0; i < 256; ++i) {
+            std::ostream os{&buf};
+            os << std::string(64, ch) << std::flush;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 8; i++)
+        threads.push_back(std::thread{f, static_cast<char>('a' + i)});
+
+    for (auto& thread : threads) 
+        thread.join();
+
+    ASSERT_EQ(8u * 256u, sent.size());
+    for (const auto& msg : sent) {
+        auto body{msg.substr(6)};
+        ASSERT_EQ(std::string(64, body[0]), body);
+    }
+}
+
+TEST(TestMinimalClient, sendsUntouched) {
+    std::vector<std::string> sent;
+
+    class MinimalClient : public IClient {
+    private:
+        std::vector<std::string>& m_Sent;
+    public:
+        explicit MinimalClient(std::vector<std::string>& sent) : m_Sent(sent) {}
+
+        void setAddr(const char*) noexcept override { }
+
+        void setPort(uint16_t) noexcept override { }
+
+        int32_t getSock() const noexcept override { return 0; }
+
+        bool isInitialised() const noexcept override { return true; }
+
+        void send(std::string&& buf) const noexcept override { m_Sent.emplace_back(std::move(buf)); }
+    };
+
+    streambuf buf{std::make_unique<MinimalClient>(sent), std::make_unique<st>()};
+    buf.cleanFormatters();
+    std::ostream os{&buf};
+    os << std::string(4096, 'x') << std::flush;
+
+    ASSERT_EQ(1u, sent.size());
+    ASSERT_EQ("<191> " + std::string(4096, 'x'), sent[0]);
+    ASSERT_EQ(0u, buf.getMetrics().send.sent);
+}
+
+TEST(TestMTStreambuf, emptyInsertReleasesLock) {
+    std::vector<std::string> sent;
+    basic_ostream<mt> os{std::make_unique<FakeClient>(sent), std::make_unique<mt>()};
+    os.cleanFormatters();
+
+    os << "" << std::string{} << std::flush;
+
+    std::thread other{[&]() { os << "message" << std::flush; }};
+    other.join();
+
+    ASSERT_EQ(1u, sent.size());
+    ASSERT_EQ("<191> message", sent[0]);
+}
+
+TEST(TestMTStreambuf, sendTelemetryWhileSwitchingPeriod) {
+    std::vector<std::string> sent;
+    std::mutex mtx;
+
+    class LockedClient : public FakeClient {
+    private:
+        std::mutex& m_Mtx;
+    public:
+        LockedClient(std::vector<std::string>& sent, std::mutex& mtx) : FakeClient{sent}, m_Mtx(mtx) {}
+
+        void send(std::string&& buf) const noexcept override {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            FakeClient::send(std::move(buf));
+        }
+    };
+
+    basic_streambuf<mt> buf{std::make_unique<LockedClient>(sent, mtx), std::make_unique<mt>()};
+    buf.cleanFormatters();
+
+    std::atomic<bool> done{false};
+    std::thread sender{[&]() {
+        while (!done.load(std::memory_order_relaxed))
+            buf.sendTelemetry();
+    }};
+
+    for (auto i = 0; i < 64; ++i) {
+        buf.setTelemetryPeriod(3600);
+        buf.setTelemetryPeriod(0);
+    }
+
+    done = true;
+    sender.join();
+
+    for (const auto& msg : sent)
+        ASSERT_NE(std::string::npos, msg.find("] client telemetry"));
+}
+
+TEST_F(TestStreambuf, recordLvlAppliesToOneMessage) {
+    m_Buf.setLvl(LogLvlMng::LL_NOTICE);
+    m_Buf.setRecordLvl(LogLvlMng::LL_ERR);
+    m_Os << "first" << std::flush;
+    m_Os << "second" << std::flush;
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<187> first", m_Sent[0]);
+    ASSERT_EQ("<189> second", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, recordLvlOfEmptyMsgIsDropped) {
+    m_Buf.setRecordLvl(LogLvlMng::LL_ERR);
+    m_Os << std::flush;
+    m_Os << "test message" << std::flush;
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<191> test message", m_Sent[0]);
+}
+
+TYPED_TEST(TestBasicStreambuf, recordLvlIsPerThread) {
+    if (std::is_same<TypeParam, st>::value || std::is_same<TypeParam, TMode>::value)
+        return; // single thread
+
+    std::mutex mtx;
+
+    class LockedClient : public FakeClient {
+    private:
+        std::mutex& m_Mtx;
+    public:
+        LockedClient(std::vector<std::string>& sent, std::mutex& mtx) : FakeClient{sent}, m_Mtx(mtx) {}
+
+        void send(std::string&& buf) const noexcept override {
+            std::lock_guard<std::mutex> lock{m_Mtx};
+            FakeClient::send(std::move(buf));
+        }
+    };
+
+    basic_streambuf<TypeParam> buf{std::make_unique<LockedClient>(this->m_Sent, mtx), std::make_unique<TypeParam>()};
+    buf.cleanFormatters();
+
+    auto f = [&](int lvl) {
+        std::ostream os{&buf};
+        for (auto i = 0; i < 256; ++i) {
+            buf.setRecordLvl(static_cast<LogLvlMng::LogLvl>(lvl));
+            os << lvl << std::flush;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 8; i++)
+        threads.push_back(std::thread{f, i});
+
+    for (auto& thread : threads) 
+        thread.join();
+
+    ASSERT_EQ(8u * 256u, this->m_Sent.size());
+    for (const auto& msg : this->m_Sent) {
+        auto lvl{msg.back() - '0'};
+        ASSERT_EQ("<" + std::to_string((LogFacilityMng::LF_LOCAL7 << 3) + lvl) + "> " + std::to_string(lvl), msg);
+    }
+}
+
+TEST_F(TestStreambuf, log) {
+    m_Buf.setLvl(LogLvlMng::LL_NOTICE);
+    m_Buf.log(LogLvlMng::LL_INFO, SYSLOG_FMT("user {} took {} ms"), 42, 7);
+    m_Os << "stream message" << std::flush;
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<190> user 42 took 7 ms", m_Sent[0]);
+    ASSERT_EQ("<189> stream message", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, logDoesNotTouchStreamMsg) {
+    m_Os << "stream ";
+    m_Buf.log(LogLvlMng::LL_INFO, SYSLOG_FMT("formatted"));
+    m_Os << "message" << std::flush;
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<190> formatted", m_Sent[0]);
+    ASSERT_EQ("<191> stream message", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, defer) {
+    m_Buf.setLvl(LogLvlMng::LL_NOTICE);
+    ASSERT_TRUE(m_Buf.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("user {} took {} ms"), std::string{"max"}, 7));
+    ASSERT_TRUE(m_Buf.defer(LogLvlMng::LL_ERR, SYSLOG_FMT("failed")));
+    m_Buf.drainDeferred();
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<190> user max took 7 ms", m_Sent[0]);
+    ASSERT_EQ("<187> failed", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, deferredAreSentBeforeMove) {
+    m_Buf.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("deferred {}"), 1);
+    streambuf moved{std::move(m_Buf)};
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<190> deferred 1", m_Sent[0]);
+
+    moved.defer(LogLvlMng::LL_INFO, SYSLOG_FMT("deferred {}"), 2);
+    moved.drainDeferred();
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<190> deferred 2", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, recordParamsApplyToOneMessage) {
+    m_Buf.addRecordParam("req_id", 42);
+    m_Buf.addRecordParam("user", std::string{"a\"b"});
+    m_Os << "first" << std::flush;
+    m_Os << "second" << std::flush;
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<191> [cpp-syslog@32473 req_id=\"42\" user=\"a\\\"b\"] first", m_Sent[0]);
+    ASSERT_EQ("<191> second", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, formattersAndParamsShareElement) {
+    class ModuleFormatter : public IFormatter {
+    public:
+        std::string key() const noexcept override { return "module"; }
+
+        std::string value() const noexcept override { return "m]1"; }
+    };
+
+    m_Buf.addFormatter(std::make_shared<ModuleFormatter>());
+    m_Buf.setSDId("app@1");
+    m_Buf.addRecordParam("id", 'x');
+    m_Os << "message" << std::flush;
+    m_Os << "message" << std::flush;
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<191> [app@1 module=\"m\\]1\" id=\"x\"] message", m_Sent[0]);
+    ASSERT_EQ("<191> [app@1 module=\"m\\]1\"] message", m_Sent[1]);
+}
+
+TEST(TestSegmentStreambuf, bodyIsNotCopied) {
+    class SegmentClient : public FakeClient {
+    public:
+        mutable std::vector<std::size_t> counts;
+
+        using FakeClient::FakeClient;
+        using FakeClient::send;
+
+        void send(const Segment* segs, std::size_t count) const noexcept override {
+            counts.push_back(count);
+            IClient::send(segs, count);
+        }
+    };
+
+    std::vector<std::string> sent;
+    auto clnt{std::make_unique<SegmentClient>(sent)};
+    auto& seen{*clnt};
+
+    streambuf buf{std::move(clnt), std::make_unique<st>()};
+    buf.cleanFormatters();
+
+    std::string body{"test message"};
+    buf.log(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), body);
+    buf.setMaxMsgSize(16);
+    buf.log(LogLvlMng::LL_INFO, SYSLOG_FMT("{}"), body);
+
+    ASSERT_EQ(2u, sent.size());
+    ASSERT_EQ("<190> test message", sent[0]);
+    ASSERT_EQ("<190> test me...", sent[1]);
+    ASSERT_EQ(2u, seen.counts[0]); // header and body
+    ASSERT_EQ(3u, seen.counts[1]); // header, body prefix and truncation marker
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestOstreamInsert : public ::testing::Test {
+protected:
+    std::vector<std::string> m_Sent;
+    basic_ostream<st>        m_Os{std::make_unique<FakeClient>(m_Sent), std::make_unique<st>()};
+protected:
+    void SetUp() { m_Os.cleanFormatters(); }
+
+    void TearDown() { }
+
+    template<class T>
+    void check(const T& val) {
+        std::ostringstream expected;
+        expected << val;
+
+        m_Os << val << std::flush;
+
+        ASSERT_FALSE(m_Sent.empty());
+        ASSERT_EQ("<191> " + expected.str(), m_Sent.back());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestOstreamInsert, integers) {
+    check(0);
+    check(-1);
+    check(std::numeric_limits<int32_t>::min());
+    check(std::numeric_limits<int64_t>::min());
+    check(std::numeric_limits<uint64_t>::max());
+    check(static_cast<short>(-12345));
+    check(42u);
+    check(true);
+}
+
+TEST_F(TestOstreamInsert, floatingPoint) {
+    check(0.0);
+    check(-0.0);
+    check(1.5f);
+    check(3.14159265358979);
+    check(1e-5);
+    check(123456789.0);
+    check(1e300L);
+    check(std::numeric_limits<double>::infinity());
+    check(std::nan(""));
+}
+
+TEST_F(TestOstreamInsert, charsAndStrings) {
+    check('x');
+    check(static_cast<unsigned char>('y'));
+    check("text");
+    check(std::string{"string"});
+}
+
+TEST_F(TestOstreamInsert, chain) {
+    m_Os << "user " << 42 << " took " << 1.5 << ' ' << std::string{"ms"} << std::endl;
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<191> user 42 took 1.5 ms\n", m_Sent[0]);
+}
+
+TEST_F(TestOstreamInsert, formattedFallsBack) {
+    m_Os << std::hex << 255 << ' ' << std::dec << std::setw(4) << 7 << ' ' << std::setprecision(3) << 3.14159 << std::flush;
+
+    ASSERT_EQ(1u, m_Sent.size());
+    ASSERT_EQ("<191> ff    7 3.14", m_Sent[0]);
+}
+
+TEST_F(TestOstreamInsert, imbuedLocaleFallsBack) {
+    struct Comma : std::numpunct<char> {
+        char do_decimal_point() const override { return ','; }
+    };
+
+    m_Os.imbue(std::locale{std::locale::classic(), new Comma});
+    m_Os << 1.5 << std::flush;
+    m_Os.imbue(std::locale::classic());
+    m_Os << 1.5 << std::flush;
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ("<191> 1,5", m_Sent[0]);
+    ASSERT_EQ("<191> 1.5", m_Sent[1]);
+}
+
+TEST_F(TestStreambuf, metrics) {
+    m_Buf.setLatencyMetrics(true);
+    m_Buf.setRecordLvl(LogLvlMng::LL_ERR);
+    m_Os << "first" << std::flush;
+    m_Os << "second" << std::flush;
+    m_Buf.log(LogLvlMng::LL_ERR, SYSLOG_FMT("third"));
+
+    auto metrics{m_Buf.getMetrics()};
+    ASSERT_EQ(2u, metrics.messages[LogLvlMng::LL_ERR]);
+    ASSERT_EQ(1u, metrics.messages[LogLvlMng::LL_DEBUG]);
+    ASSERT_EQ(3u, metrics.send.sent); // default collectMetrics() takes getStats()
+    ASSERT_EQ(3u, metrics.format.count);
+    ASSERT_EQ(3u, metrics.sending.count);
+    ASSERT_EQ(2u, metrics.lockWait.count); // stream messages only
+}
+
+TEST_F(TestStreambuf, latencyMetricsAreOff) {
+    m_Os << "message" << std::flush;
+
+    auto metrics{m_Buf.getMetrics()};
+    ASSERT_EQ(1u, metrics.messages[LogLvlMng::LL_DEBUG]);
+    ASSERT_EQ(0u, metrics.format.count);
+    ASSERT_EQ(0u, metrics.lockWait.count);
+}
+
+TEST(TestProfStreambuf, lockSites) {
+    std::vector<std::string> sent;
+    basic_streambuf<mt_prof> buf{std::make_unique<FakeClient>(sent), std::make_unique<mt_prof>()};
+    std::ostream os{&buf};
+
+    os << "first" << std::flush;
+    buf.log(LogLvlMng::LL_INFO, SYSLOG_FMT("second")); // no lock taken
+    os << "third" << std::flush;
+
+    auto profile{buf.getLockProfile()};
+    ASSERT_EQ(3u, sent.size());
+    ASSERT_EQ(2u, profile.wait[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_EQ(2u, profile.hold[LockSiteMng::LS_ASSEMBLY].count);
+    ASSERT_EQ(2u, profile.hold[LockSiteMng::LS_HEADER].count);
+    ASSERT_EQ(2u, profile.hold[LockSiteMng::LS_FORMATTERS].count);
+    ASSERT_EQ(2u, profile.hold[LockSiteMng::LS_SEND].count);
+}
+
+TEST(TestProfStreambuf, lockSitesRuntimePolicy) {
+    std::vector<std::string> sent;
+    basic_streambuf<TMode> buf{std::make_unique<FakeClient>(sent), std::make_unique<mt_prof>()};
+    std::ostream os{&buf};
+
+    os << "first" << std::flush;
+
+    auto profile{buf.getLockProfile()};
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_HEADER].count);
+    ASSERT_EQ(1u, profile.hold[LockSiteMng::LS_SEND].count);
+}
+
+TEST_F(TestStreambuf, telemetry) {
+    class ModuleFormatter : public IFormatter {
+    public:
+        std::string key() const noexcept override { return "module"; }
+
+        std::string value() const noexcept override { return "m"; }
+    };
+
+    m_Buf.addFormatter(std::make_shared<ModuleFormatter>());
+    m_Os << "message" << std::flush;
+
+    ASSERT_FALSE(m_Buf.sendTelemetry());
+
+    m_Buf.setTelemetryPeriod(3600);
+    ASSERT_TRUE(m_Buf.sendTelemetry());
+    ASSERT_TRUE(m_Buf.sendTelemetry()); // idle since the previous record
+    m_Buf.setTelemetryPeriod(0);
+
+    ASSERT_EQ(3u, m_Sent.size());
+    ASSERT_EQ(
+        "<190> [cpp-syslog@32473 module=\"m\"][cpp-syslog-stats@32473 rate=\"0\" msgs=\"1\" records=\"1\" sent=\"2\" "
+        "bytes=\"0\" dropped=\"0\" again=\"0\" errors=\"0\" qmax=\"0\"] client telemetry",
+        m_Sent[2]
+    );
+}
+
+TEST_F(TestStreambuf, elementsFollowSDId) {
+    m_Buf.setSDId("app@12345");
+    m_Buf.setSequence(true);
+    m_Buf.addRecordParam("k", "v");
+    m_Os << "message" << std::flush;
+    m_Buf.setTelemetryPeriod(3600);
+    ASSERT_TRUE(m_Buf.sendTelemetry());
+    m_Buf.setTelemetryPeriod(0);
+
+    ASSERT_EQ(2u, m_Sent.size());
+    ASSERT_EQ(
+        "<191> [app@12345 k=\"v\"][meta sequenceId=\"1\"][cpp-syslog-seq@12345 thread=\"1\" seq=\"1\"] message",
+        m_Sent[0]
+    );
+    ASSERT_EQ(0u, m_Sent[1].find("<190> [cpp-syslog-stats@12345 rate=\""));
+    ASSERT_NE(std::string::npos, m_Sent[1].find("][cpp-syslog-seq@12345 thread=\"1\" seq=\"2\"] client telemetry"));
+}
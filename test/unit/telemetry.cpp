@@ -0,0 +1,110 @@
+/**
+ * @file telemetry.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "telemetry.hpp"
+
+using namespace syslog;
+using namespace syslog::details;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+class TestTelemetry : public ::testing::Test {
+protected:
+    void SetUp() { }
+
+    void TearDown() { }
+};
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST_F(TestTelemetry, render) {
+    Metrics metrics{};
+    metrics.messages[LogLvlMng::LL_ERR] = 2;
+    metrics.messages[LogLvlMng::LL_INFO] = 3;
+    metrics.bytes = 100;
+    metrics.send = SendStats{4, 5, 1, 2, 1};
+    metrics.deferredDropped = 3;
+    metrics.queueHighWater = 7;
+
+    PooledString out;
+    Telemetry::render(out, metrics, 42, 1);
+
+    ASSERT_EQ(
+        " rate=\"42\" msgs=\"4\" records=\"1\" sent=\"4\" bytes=\"100\" dropped=\"5\" again=\"5\" errors=\"1\" qmax=\"7\"", 
+        out
+    );
+}
+
+TEST_F(TestTelemetry, stopsWithoutWaitingForPeriod) {
+    std::atomic<int> ticks{0};
+    auto start{std::chrono::steady_clock::now()};
+    {
+        Telemetry telemetry{
+            3600, 
+            []() { return Metrics{}; }, 
+            [&](const PooledString&) { ++ticks; }
+        };
+        ASSERT_EQ(3600u, telemetry.getPeriod());
+    }
+
+    ASSERT_EQ(0, ticks.load());
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds{1});
+}
+
+TEST_F(TestTelemetry, recordsAreNotCountedAsMessages) {
+    std::vector<std::string> records;
+    {
+        Telemetry telemetry{
+            3600,
+            [&]() {
+                Metrics metrics{};
+                metrics.messages[LogLvlMng::LL_INFO] = 5 + records.size(); // records count as INFO messages
+                return metrics;
+            },
+            [&](const PooledString& elem) { records.emplace_back(elem.data(), elem.size()); }
+        };
+        telemetry.tick();
+        telemetry.tick();
+        telemetry.tick();
+    }
+
+    ASSERT_EQ(3u, records.size());
+    ASSERT_EQ(
+        " rate=\"0\" msgs=\"5\" records=\"2\" sent=\"0\" bytes=\"0\" dropped=\"0\" again=\"0\" errors=\"0\" qmax=\"0\"",
+        records.back()
+    );
+}
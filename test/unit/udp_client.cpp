@@ -27,6 +27,13 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
 #include "client_impl.hpp"
 
 using namespace syslog;
@@ -112,4 +119,52 @@ TEST_F(TestUDPClient, sendData) {
     ASSERT_EQ(true, clnt.isInitialised());
 
     clnt.send("test data");
-}
\ No newline at end of file
+}
+
+TEST_F(TestUDPClient, statsAfterMove) {
+    UDPClient clnt;
+
+    clnt.send("test data");
+    clnt.send("");
+
+    auto moved{std::move(clnt)};
+
+    ASSERT_EQ(1u, moved.getStats().sent);
+    ASSERT_EQ(0u, clnt.getStats().sent);
+}
+
+TEST_F(TestUDPClient, maxMsgSize) {
+    std::size_t defaultSize{MsgSizeMng::DEFAULT_UDP_MSG_SIZE};
+    std::size_t minSize{MsgSizeMng::MIN_UDP_MSG_SIZE};
+    UDPClient clnt;
+
+    ASSERT_EQ(defaultSize, clnt.getMaxMsgSize());
+
+    clnt.setMaxMsgSize(minSize);
+
+    ASSERT_EQ(minSize, clnt.getMaxMsgSize());
+}
+
+TEST_F(TestUDPClient, sendSegments) {
+    auto sock{socket(AF_INET, SOCK_DGRAM, 0)};
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ASSERT_EQ(0, bind(sock, (sockaddr*)&addr, sizeof(addr)));
+
+    socklen_t len{sizeof(addr)};
+    getsockname(sock, (sockaddr*)&addr, &len);
+
+    UDPClient clnt;
+    clnt.setPort(ntohs(addr.sin_port));
+
+    details::Segment segs[] = {{"<191> ", 6}, {"test ", 5}, {"data", 4}};
+    clnt.send(segs, 3);
+
+    char buf[64];
+    auto res{recv(sock, buf, sizeof(buf), 0)};
+    close(sock);
+
+    ASSERT_EQ("<191> test data", std::string(buf, res > 0 ? res : 0));
+    ASSERT_EQ(1u, clnt.getStats().sent);
+}
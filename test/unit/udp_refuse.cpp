@@ -0,0 +1,129 @@
+/**
+ * @file udp_refuse.cpp
+ * @authors Max Markeloff (https://github.com/mmarkeloff)
+ */
+
+// MIT License
+//
+// Copyright (c) 2021 Max
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <cerrno>
+
+#include <arpa/inet.h>
+#include <dlfcn.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include "client_impl.hpp"
+
+using namespace syslog;
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+static std::atomic<bool> g_RefuseSends{false}; ///< make sendmsg() fail with EAGAIN
+
+/**
+ * Interpose sendmsg() so tests can refuse datagrams the way a full send queue does
+ */
+extern "C" ssize_t sendmsg(int sock, const struct msghdr* msg, int flags) {
+    using SendMsg = ssize_t (*)(int, const struct msghdr*, int);
+    static const auto real{reinterpret_cast<SendMsg>(dlsym(RTLD_NEXT, "sendmsg"))};
+
+    if (g_RefuseSends) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return real(sock, msg, flags);
+}
+
+////////////////////////////////////////////////////////////////////////////
+///
+//
+TEST(TestUDPRefuse, sendDataNonBlocking) {
+    int rcv{socket(AF_INET, SOCK_DGRAM, 0)};
+    ASSERT_LE(0, rcv);
+
+    sockaddr_in addr{};
+    socklen_t len{sizeof(addr)};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    ASSERT_EQ(0, bind(rcv, (sockaddr*)&addr, sizeof(addr)));
+    ASSERT_EQ(0, getsockname(rcv, (sockaddr*)&addr, &len));
+
+    UDPClient clnt;
+
+    ASSERT_EQ(true, clnt.isInitialised());
+
+    clnt.setAddr("127.0.0.1");
+    clnt.setPort(ntohs(addr.sin_port));
+    clnt.setNonBlocking(true);
+    ASSERT_EQ(0u, clnt.getStats().errors);
+    clnt.setSndBuf(1); // clamped to the kernel minimum
+    clnt.setRetry(true);
+
+    // the receiver doesn't read yet: fill the send queue until the kernel refuses
+    for (auto i = 0; i < 4096 && 0 == clnt.getStats().again; ++i)
+        clnt.send(std::string(1024, 'x'));
+
+    // Linux loopback frees the send buffer on transmit and never refuses
+    char buf[2048];
+    std::size_t injected{0};
+    if (0 == clnt.getStats().again) {
+        while (recv(rcv, buf, sizeof(buf), MSG_DONTWAIT) > 0)
+            ; // room for the retried datagrams
+        g_RefuseSends = true;
+        for (; injected < 16; ++injected)
+            clnt.send(std::string(1024, 'r'));
+        g_RefuseSends = false;
+    }
+
+    auto stats{clnt.getStats()};
+    ASSERT_LT(0u, stats.again);
+    ASSERT_EQ(0u, stats.errors);
+
+    // read everything and wait for background retry
+    std::size_t retriedRcvd{0};
+    auto deadline{std::chrono::steady_clock::now() + std::chrono::seconds(5)};
+    while (
+        (stats.again != stats.retried + stats.dropped || retriedRcvd < injected) &&
+        std::chrono::steady_clock::now() < deadline
+    ) {
+        auto res{recv(rcv, buf, sizeof(buf), MSG_DONTWAIT)};
+        if (res > 0)
+            retriedRcvd += 'r' == buf[0];
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = clnt.getStats();
+    }
+    close(rcv);
+
+    ASSERT_EQ(stats.again, stats.retried + stats.dropped);
+    ASSERT_LT(0u, stats.retried);
+    ASSERT_EQ(injected, retriedRcvd);
+}